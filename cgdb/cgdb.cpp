@@ -79,12 +79,19 @@
 #include "kui_term.h"
 #include "kui_manager.h"
 #include "fs_util.h"
+#include "event_loop.h"
 #include "cgdbrc.h"
 #include "io.h"
 #include "fork_util.h"
 #include "terminal.h"
 #include "rline.h"
 #include "usage.h"
+#include "stackview.h"
+#include "varview.h"
+#include "memview.h"
+#include "prefetch.h"
+#include "regview.h"
+#include "threadview.h"
 
 /* --------- */
 /* Constants */
@@ -97,12 +104,12 @@
 /* --------------- */
 
 struct tgdb *tgdb;              /* The main TGDB context */
+struct event_loop *cgdb_loop;   /* The main loop's event sources */
 
 std::string cgdb_home_dir; /* Path to home dir with trailing slash */
 std::string cgdb_log_dir;  /* Path to log dir with trailing slash */
 
-static int gdb_console_fd = -1; /* GDB console descriptor */
-static int gdb_mi_fd = -1;      /* GDB Machine Interface descriptor */
+static int gdb_fd = -1;         /* Readable when GDB output is ready */
 static bool new_ui_unsupported = false;
 
 static char *debugger_path = NULL;  /* Path to debugger to use */
@@ -213,6 +220,7 @@ int run_shell_command(const char *command)
 
     /* Turn off echo and put the terminal back into raw mode */
     tty_cbreak(STDIN_FILENO, &term_attributes);
+    if_invalidate(IF_PANE_ALL);
     if_draw();
 
     return rv;
@@ -363,11 +371,14 @@ static int init_home_dir(void)
  * @param context
  * Unused at the moment
  *
- * @param str
+ * @param data
  * The console output to display
+ *
+ * @param size
+ * The number of bytes in data
  */
-static void console_output(void *context, const std::string &str) {
-    if_print(str.c_str());
+static void console_output(void *context, const char *data, size_t size) {
+    if_print(data, size);
 }
 
 static void command_response(void *context, struct tgdb_response *response);
@@ -388,7 +399,7 @@ static int start_gdb(int argc, char *argv[])
     // once cgdb determines the actual size. This is done in main() in
     // the call to if_layout just after if_init.
     return tgdb_start_gdb(tgdb, debugger_path, argc, argv, get_gdb_height(),
-            get_gdb_width(), &gdb_console_fd, &gdb_mi_fd);
+            get_gdb_width(), &gdb_fd);
 }
 
 static void send_key(int focus, char key)
@@ -546,6 +557,7 @@ static void update_file_position(struct tgdb_response *response)
         ret = source_set_exec_addr(sview, sview->addr_frame);
 
         if (!ret) {
+            if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
             if_draw();
         } else if (sview->addr_frame) {
             /* No disasm found - request it */
@@ -652,6 +664,7 @@ static void update_disassemble(struct tgdb_response *response)
             }
 
             source_set_exec_addr(sview, sview->addr_frame);
+            if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
             if_draw();
 
             free(path);
@@ -676,6 +689,59 @@ static void command_response(void *context, struct tgdb_response *response)
     case TGDB_DISASSEMBLE_FUNC:
         update_disassemble(response);
         break;
+    case TGDB_UPDATE_STACK_DEPTH:
+        stackview_update_depth(response);
+        break;
+    case TGDB_UPDATE_STACK_FRAMES:
+        stackview_update_frames(response);
+        break;
+    case TGDB_UPDATE_FRAME_FILES:
+        prefetch_update_frame_files(response);
+        break;
+    case TGDB_UPDATE_STACK_VARIABLES:
+        varview_update_variables(response);
+        break;
+    case TGDB_UPDATE_VAR_CREATE:
+        varview_update_create(response);
+        break;
+    case TGDB_UPDATE_VAR_CHILDREN:
+        varview_update_children(response);
+        break;
+    case TGDB_UPDATE_VAR_CHANGES:
+        varview_update_changes(response);
+        break;
+    case TGDB_UPDATE_MEMORY:
+        memview_update_memory(response);
+        break;
+    case TGDB_MEMORY_CHANGED:
+        memview_memory_changed(response);
+        break;
+    case TGDB_THREADS_CHANGED:
+        threadview_threads_changed(response);
+        break;
+    case TGDB_UPDATE_THREAD_INFO:
+        threadview_update_thread_info(response);
+        break;
+    case TGDB_UPDATE_REGISTER_NAMES:
+        regview_update_names(response);
+        break;
+    case TGDB_UPDATE_CHANGED_REGISTERS:
+        regview_update_changed(response);
+        break;
+    case TGDB_UPDATE_REGISTER_VALUES:
+        regview_update_values(response);
+        break;
+    case TGDB_INFERIOR_RUNNING:
+    case TGDB_INFERIOR_STOPPED:
+    case TGDB_INFERIOR_EXITED:
+        infowin_set_running(response->header == TGDB_INFERIOR_RUNNING);
+        stackview_inferior_changed(response);
+        varview_inferior_changed(response);
+        memview_inferior_changed(response);
+        threadview_inferior_changed(response);
+        regview_inferior_changed(response);
+        prefetch_inferior_changed(response);
+        break;
     case TGDB_QUIT:
         new_ui_unsupported = response->choice.quit.new_ui_unsupported;
         cgdb_cleanup_and_exit(0);
@@ -687,12 +753,12 @@ static void command_response(void *context, struct tgdb_response *response)
  *
  *  Returns:  -1 on error, 0 on success
  */
-static int gdb_input(int fd)
+static int gdb_input(void)
 {
     int result;
 
-    /* Read from GDB */
-    result = tgdb_process(tgdb, fd);
+    /* Take what the I/O thread read from GDB */
+    result = tgdb_process(tgdb);
     if (result == -1) {
         clog_error(CLOG_CGDB, "tgdb_process error");
         return -1;
@@ -701,10 +767,12 @@ static int gdb_input(int fd)
     return 0;
 }
 
-static int cgdb_resize_term(int fd)
+static int cgdb_resize_term(void *context, int fd)
 {
     int c, result;
 
+    (void)context;
+
     if (read(fd, &c, sizeof (int)) < sizeof (int)) {
         clog_error(CLOG_CGDB, "read from resize pipe");
         return -1;
@@ -738,16 +806,21 @@ static int cgdb_resize_term(int fd)
  * writes those values to a pipe which are detected in the main loop and
  * sent here.
  *
+ * @param context
+ * Unused.
+ *
  * @param fd
  * The file descriptor to read the signal number from.
  *
  * @return
  * 0 on success or -1 on error
  */
-static int cgdb_handle_signal_in_main_loop(int fd)
+static int cgdb_handle_signal_in_main_loop(void *context, int fd)
 {
     int signo;
 
+    (void)context;
+
     if (read(fd, &signo, sizeof(int)) < sizeof(int)) {
         clog_error(CLOG_CGDB, "read from signal pipe");
         return -1;
@@ -758,114 +831,106 @@ static int cgdb_handle_signal_in_main_loop(int fd)
     return 0;
 }
 
-static int main_loop(void)
+/* Input received:  Handle it */
+static int main_loop_user_input(void *context, int fd)
+{
+    int val;
+
+    (void)context;
+    (void)fd;
+
+    /* The callers' files are loaded once the user stops typing */
+    prefetch_user_input();
+
+    val = user_input_loop();
+
+    /* The below condition happens on cygwin when user types ctrl-z
+     * select returns (when it shouldn't) with the value of 1. the
+     * user input loop gets called, the kui gets called and does a
+     * non blocking read which returns EAGAIN. The kui then passes
+     * the -1 up the stack with out making any more system calls. */
+    if (val == -1 && errno == EAGAIN)
+        return 0;
+
+    return val == -1 ? -1 : 0;
+}
+
+/* This processes the mi and console output streams from gdb.
+ *
+ * The mi output is processed before the console output.
+ * At one point, this was the other way around.
+ * I suspect the order should not matter, however it does in the
+ * case described below.
+ *
+ * I ran across this issue,
+ *   https://github.com/cgdb/cgdb/issues/352
+ * where the target output wasn't being displayed by cgdb.
+ * cgdb was ignoring the target output. Once fixed, the target
+ * output and the gdb prompt were intermixed somewhat randomly.
+ *
+ * For instance, when running the command 'monitor help', 
+ * gdb returns two things,
+ *   - the gdb prompt on the console output
+ *   - the target output on the mi output
+ *
+ * If cgdb processes all the mi output first, the target output
+ * appears to show up before the gdb prompt. I fully expect to
+ * find a situation where the console output needs to be handled
+ * first one day. I've left this documentation to aid in the thought
+ * process when that day approaches.
+ */
+static int main_loop_gdb_output(void *context, int fd)
 {
-    fd_set rset;
-    int max;
+    (void)context;
+    (void)fd;
+
+    if (gdb_input() == -1) {
+        return -1;
+    }
 
+    /* When the file dialog is opened, the user input is blocked, 
+     * until GDB returns all the files that should be displayed,
+     * and the file dialog can open, and be prepared to receive 
+     * input. So, if we are in the file dialog, and are no longer
+     * waiting for the gdb command, then read the input.
+     */
+    if (kui_ctx->cangetkey()) {
+        user_input_loop();
+    }
+
+    return 0;
+}
+
+static int main_loop(void)
+{
     /* Main (infinite) loop:
      *   Sits and waits for input on either stdin (user input) or the
      *   GDB file descriptor.  When input is received, wrapper functions
      *   are called to process the input, and handle it appropriately.
-     *   This will result in calls to the curses interface, typically. */
-
-    for (;;) {
-        max = (gdb_console_fd > STDIN_FILENO) ? gdb_console_fd : STDIN_FILENO;
-        max = (max > resize_pipe[0]) ? max : resize_pipe[0];
-        max = (max > signal_pipe[0]) ? max : signal_pipe[0];
-        max = (max > gdb_mi_fd) ? max :gdb_mi_fd;
-
-        /* Reset the fd_set, and watch for input from GDB or stdin */
-        FD_ZERO(&rset);
-        FD_SET(STDIN_FILENO, &rset);
-        FD_SET(gdb_console_fd, &rset);
-        FD_SET(resize_pipe[0], &rset);
-        FD_SET(signal_pipe[0], &rset);
-        FD_SET(gdb_mi_fd, &rset);
-
-        /* Wait for input */
-        if (select(max + 1, &rset, NULL, NULL, NULL) == -1) {
-            if (errno == EINTR)
-                continue;
-            else {
-                clog_error(CLOG_CGDB, "select failed: %s", strerror(errno));
-                return -1;
-            }
-        }
+     *   This will result in calls to the curses interface, typically.
+     *
+     * The sources are handled in the order they are added. The file
+     * dialog and the source viewer add theirs when they are created. */
 
-        /* A signal occurred (besides SIGWINCH) */
-        if (FD_ISSET(signal_pipe[0], &rset))
-            if (cgdb_handle_signal_in_main_loop(signal_pipe[0]) == -1)
-                return -1;
-
-        /* A resize signal occurred */
-        if (FD_ISSET(resize_pipe[0], &rset))
-            if (cgdb_resize_term(resize_pipe[0]) == -1)
-                return -1;
-
-        /* Input received:  Handle it */
-        if (FD_ISSET(STDIN_FILENO, &rset)) {
-            int val = user_input_loop();
-
-            /* The below condition happens on cygwin when user types ctrl-z
-             * select returns (when it shouldn't) with the value of 1. the
-             * user input loop gets called, the kui gets called and does a
-             * non blocking read which returns EAGAIN. The kui then passes
-             * the -1 up the stack with out making any more system calls. */
-            if (val == -1 && errno == EAGAIN)
-                continue;
-            else if (val == -1)
-                return -1;
-        }
+    /* A signal occurred (besides SIGWINCH) */
+    if (event_loop_add_fd(cgdb_loop, signal_pipe[0],
+                cgdb_handle_signal_in_main_loop, NULL) == -1)
+        return -1;
 
-        /* This processes the mi output stream from gdb.
-         * 
-         * At one point, this was processed after the gdb console output.
-         * I suspect the order should not matter, however it does in the
-         * case described below.
-         *
-         * I ran across this issue,
-         *   https://github.com/cgdb/cgdb/issues/352
-         * where the target output wasn't being displayed by cgdb.
-         * cgdb was ignoring the target output. Once fixed, the target
-         * output and the gdb prompt were intermixed somewhat randomly.
-         *
-         * For instance, when running the command 'monitor help', 
-         * gdb returns two things,
-         *   - the gdb prompt on the console output
-         *   - the target output on the mi output
-         *
-         * If cgdb processes all the mi output first, the target output
-         * appears to show up before the gdb prompt. I fully expect to
-         * find a situation where the console output needs to be handled
-         * first one day. I've left this documentation to aid in the thought
-         * process when that day approaches.
-         */
-        if (FD_ISSET(gdb_mi_fd, &rset)) {
-            if (gdb_input(gdb_mi_fd) == -1) {
-                return -1;
-            }
-        }
+    /* A resize signal occurred */
+    if (event_loop_add_fd(cgdb_loop, resize_pipe[0],
+                cgdb_resize_term, NULL) == -1)
+        return -1;
 
-        /* This processes the console output stream from gdb.  */
-        if (FD_ISSET(gdb_console_fd, &rset)) {
-            if (gdb_input(gdb_console_fd) == -1) {
-                return -1;
-            }
+    if (event_loop_add_fd(cgdb_loop, STDIN_FILENO,
+                main_loop_user_input, NULL) == -1)
+        return -1;
 
-            /* When the file dialog is opened, the user input is blocked, 
-             * until GDB returns all the files that should be displayed,
-             * and the file dialog can open, and be prepared to receive 
-             * input. So, if we are in the file dialog, and are no longer
-             * waiting for the gdb command, then read the input.
-             */
-            if (kui_ctx->cangetkey()) {
-                user_input_loop();
-            }
-        }
+    if (event_loop_add_fd(cgdb_loop, gdb_fd,
+                main_loop_gdb_output, NULL) == -1)
+        return -1;
 
-    }
-    return 0;
+    return event_loop_run(cgdb_loop);
 }
 
 /* ----------------- */
@@ -901,6 +966,9 @@ void cgdb_cleanup_and_exit(int val)
     /* Shut down debugger */
     tgdb_shutdown(tgdb);
 
+    event_loop_destroy(cgdb_loop);
+    cgdb_loop = NULL;
+
     if (tty_set_attributes(STDIN_FILENO, &term_attributes) == -1)
         clog_error(CLOG_CGDB, "tty_reset error");
 
@@ -1121,6 +1189,15 @@ int main(int argc, char *argv[])
         cgdb_cleanup_and_exit(-1);
     }
 
+    /* Create the event loop, the display adds its sources to it. This is
+     * before the cgdbrc file, as commands there like watch and memory
+     * defer their drawing to it. */
+    cgdb_loop = event_loop_create();
+    if (!cgdb_loop) {
+        clog_error(CLOG_CGDB, "event_loop_create failed");
+        cgdb_cleanup_and_exit(-1);
+    }
+
     /* Parse the cgdbrc file. Note that we are doing this before
        if_init() is called so windows and highlight groups haven't
        been created yet. We need to do this here because some options
@@ -13,6 +13,11 @@
 
 #define MAXLINE 4096
 
+/* The main loop's event loop. Subsystems can register descriptors,
+ * idle callbacks and timers with it, see event_loop.h. */
+struct event_loop;
+extern struct event_loop *cgdb_loop;
+
 /* Clean cgdb up (when exiting) */
 void cgdb_cleanup_and_exit(int val);
 
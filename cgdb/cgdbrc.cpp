@@ -3,6 +3,7 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <list>
+#include <string>
 
 #if HAVE_STRING_H
 #include <string.h>
@@ -20,11 +21,18 @@
 #include "command_lexer.h"
 #include "tgdb.h"
 #include "sys_util.h"
+#include "stretchy.h"
 #include "cgdb.h"
 #include "interface.h"
+#include "stackview.h"
+#include "varview.h"
+#include "memview.h"
+#include "regview.h"
+#include "threadview.h"
 #include "tokenizer.h"
 #include "highlight_groups.h"
 #include "kui_term.h"
+#include "fs_util.h"
 
 extern struct tgdb *tgdb;
 
@@ -74,11 +82,22 @@ static int command_focus_gdb(int param);
 
 static int command_do_bang(int param);
 static int command_do_focus(int param);
+static int command_do_grep(int param);
+static int command_do_clist(int param);
+static int command_goto_match(int param);
 static int command_do_help(int param);
 static int command_do_logo(int param);
 static int command_do_noh(int param);
 static int command_do_quit(int param);
 static int command_do_shell(int param);
+static int command_do_stack(int param);
+static int command_do_locals(int param);
+static int command_do_memory(int param);
+static int command_do_meminfo(int param);
+static int command_do_threads(int param);
+static int command_do_registers(int param);
+static int command_do_watch(int param);
+static int command_do_unwatch(int param);
 static int command_source_reload(int param);
 
 static int command_parse_syntax(int param);
@@ -97,10 +116,21 @@ typedef struct COMMANDS {
 
 COMMANDS commands[] = {
     /* bang         */ {"bang", (action_t)command_do_bang, 0},
+    /* clist        */ {"clist", (action_t)command_do_clist, 0},
+    /* clist        */ {"cl", (action_t)command_do_clist, 0},
+    /* cnext        */ {"cnext", (action_t)command_goto_match, 1},
+    /* cnext        */ {"cn", (action_t)command_goto_match, 1},
+    /* cprevious    */ {"cprevious", (action_t)command_goto_match, -1},
+    /* cprevious    */ {"cprev", (action_t)command_goto_match, -1},
+    /* cprevious    */ {"cp", (action_t)command_goto_match, -1},
+    /* cprevious    */ {"cN", (action_t)command_goto_match, -1},
     /* edit         */ {"edit", (action_t)command_source_reload, 0},
     /* edit         */ {"e", (action_t)command_source_reload, 0},
     /* focus        */ {"focus", (action_t)command_do_focus, 0},
+    /* grep         */ {"grep", (action_t)command_do_grep, 0},
+    /* grep!        */ {"grep!", (action_t)command_do_grep, 1},
     /* help         */ {"help", (action_t)command_do_help, 0},
+    /* locals       */ {"locals", (action_t)command_do_locals, 0},
     /* logo         */ {"logo", (action_t)command_do_logo, 0},
     /* highlight    */ {"highlight", (action_t)command_parse_highlight, 0},
     /* highlight    */ {"hi", (action_t)command_parse_highlight, 0},
@@ -110,14 +140,21 @@ COMMANDS commands[] = {
     /* iunmap       */ {"iu", (action_t)command_parse_unmap, 0},
     /* insert       */ {"insert", (action_t)command_focus_gdb, 0},
     /* map          */ {"map", (action_t)command_parse_map, 0},
+    /* memory       */ {"memory", (action_t)command_do_memory, 0},
+    /* meminfo      */ {"meminfo", (action_t)command_do_meminfo, 0},
     /* noh          */ {"noh", (action_t)command_do_noh, 0},
     /* quit         */ {"quit", (action_t)command_do_quit, 0},
     /* quit         */ {"q", (action_t)command_do_quit, 0},
+    /* registers    */ {"registers", (action_t)command_do_registers, 0},
     /* shell        */ {"shell", (action_t)command_do_shell, 0},
     /* shell        */ {"sh", (action_t)command_do_shell, 0},
+    /* stack        */ {"stack", (action_t)command_do_stack, 0},
     /* syntax       */ {"syntax", (action_t)command_parse_syntax, 0},
+    /* threads      */ {"threads", (action_t)command_do_threads, 0},
     /* unmap        */ {"unmap", (action_t)command_parse_unmap, 0},
     /* unmap        */ {"unm", (action_t)command_parse_unmap, 0},
+    /* unwatch      */ {"unwatch", (action_t)command_do_unwatch, 0},
+    /* watch        */ {"watch", (action_t)command_do_watch, 0},
     /* continue     */ {"continue", (action_t)command_do_tgdbcommand, TGDB_CONTINUE},
     /* continue     */ {"c", (action_t)command_do_tgdbcommand, TGDB_CONTINUE},
     /* down         */ {"down", (action_t)command_do_tgdbcommand, TGDB_DOWN},
@@ -191,6 +228,14 @@ void cgdbrc_init_config_options(void)
     option.variant.line_display_style = LINE_DISPLAY_LONG_ARROW;
     cgdbrc_config_options[i++] = option;
 
+    option.option_kind = CGDBRC_GDB_READ_BUDGET;
+    option.variant.int_val = 1024 * 1024;
+    cgdbrc_config_options[i++] = option;
+
+    option.option_kind = CGDBRC_GDB_READ_SIZE;
+    option.variant.int_val = 4096;
+    cgdbrc_config_options[i++] = option;
+
     option.option_kind = CGDBRC_HLSEARCH;
     option.variant.int_val = 0;
     cgdbrc_config_options[i++] = option;
@@ -211,6 +256,10 @@ void cgdbrc_init_config_options(void)
     option.variant.int_val = 1;
     cgdbrc_config_options[i++] = option;
 
+    option.option_kind = CGDBRC_SOURCE_MEMORY;
+    option.variant.int_val = 512;
+    cgdbrc_config_options[i++] = option;
+
     option.option_kind = CGDBRC_SYNTAX;
     option.variant.language_support_val = TOKENIZER_LANGUAGE_UNKNOWN;
     cgdbrc_config_options[i++] = option;
@@ -319,6 +368,14 @@ void cgdbrc_init_config_variables(void)
     cgdbrc_variables.push_back(ConfigVariable(
         "executinglinedisplay", "eld", CONFIG_TYPE_FUNC_STRING,
         (void *)command_set_executing_line_display));
+    /* gdbreadbudget */
+    cgdbrc_variables.push_back(ConfigVariable(
+        "gdbreadbudget", "grb", CONFIG_TYPE_INT,
+        (void *)&cgdbrc_config_options[CGDBRC_GDB_READ_BUDGET].variant.int_val));
+    /* gdbreadsize */
+    cgdbrc_variables.push_back(ConfigVariable(
+        "gdbreadsize", "grs", CONFIG_TYPE_INT,
+        (void *)&cgdbrc_config_options[CGDBRC_GDB_READ_SIZE].variant.int_val));
     /* hlsearch */
     cgdbrc_variables.push_back(ConfigVariable(
         "hlsearch", "hls", CONFIG_TYPE_BOOL,
@@ -339,6 +396,10 @@ void cgdbrc_init_config_variables(void)
     cgdbrc_variables.push_back(ConfigVariable(
         "showmarks", "showmarks", CONFIG_TYPE_BOOL,
         (void *)&cgdbrc_config_options[CGDBRC_SHOWMARKS].variant.int_val));
+    /* sourcememory */
+    cgdbrc_variables.push_back(ConfigVariable(
+        "sourcememory", "srcmem", CONFIG_TYPE_INT,
+        (void *)&cgdbrc_config_options[CGDBRC_SOURCE_MEMORY].variant.int_val));
     /* syntax */
     cgdbrc_variables.push_back(ConfigVariable(
         "syntax", "syn", CONFIG_TYPE_FUNC_STRING,
@@ -721,6 +782,95 @@ int command_do_focus(int param)
     return 0;
 }
 
+/* Get the rest of the command line as it was typed, so the white space in
+ * a pattern or an expression is kept. Only the white space separating it
+ * from the command is dropped. */
+static std::string command_get_rest_of_line(void)
+{
+    extern int enter_rest_of_line;
+    std::string rest;
+
+    enter_rest_of_line = 1;
+    if (yylex() == IDENTIFIER) {
+        const char *token = get_token();
+
+        rest = token + strspn(token, " \t\v\f");
+    }
+    enter_rest_of_line = 0;
+
+    return rest;
+}
+
+int command_do_grep(int param)
+{
+    struct sviewer *sview = if_get_sview();
+    std::string regex;
+    int count;
+
+    if (!sview)
+        return -1;
+
+    /* The rest of the line is the pattern */
+    regex = command_get_rest_of_line();
+
+    if (regex.empty())
+        return -1;
+
+    count = source_grep(sview, regex.c_str(),
+            cgdbrc_get_int(CGDBRC_IGNORECASE), param);
+    if (count == -1) {
+        if_print_message("\nInvalid regular expression: %s\n", regex.c_str());
+        return -1;
+    }
+
+    command_do_clist(0);
+
+    /* Jump to the first match */
+    if (count > 0)
+        source_goto_match(sview, 1);
+
+    return 0;
+}
+
+int command_do_clist(int param)
+{
+    struct sviewer *sview = if_get_sview();
+    int i;
+
+    if (!sview)
+        return -1;
+
+    if_print_message("\n%d matches\n", sbcount(sview->matches));
+    for (i = 0; i < sbcount(sview->matches); i++) {
+        struct sviewer_match *match = &sview->matches[i];
+
+        if_print_message("%c%s:%d: %s\n", (i == sview->cur_match) ? '>' : ' ',
+                match->node->path, match->line + 1, match->text);
+    }
+
+    return 0;
+}
+
+int command_goto_match(int param)
+{
+    struct sviewer *sview = if_get_sview();
+
+    if (!sview)
+        return -1;
+
+    if (!sbcount(sview->matches)) {
+        if_print_message("\nNo matches, use :grep first\n");
+        return -1;
+    }
+
+    if (!source_goto_match(sview, param)) {
+        if_print_message("\nNo more matches\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 int command_do_help(int param)
 {
     if_display_help();
@@ -751,6 +901,84 @@ int command_do_shell(int param)
     return run_shell_command(NULL);
 }
 
+int command_do_stack(int param)
+{
+    if_show_info(stackview_get());
+    return 0;
+}
+
+int command_do_threads(int param)
+{
+    if_show_info(threadview_get());
+    return 0;
+}
+
+int command_do_registers(int param)
+{
+    if_show_info(regview_get());
+    return 0;
+}
+
+int command_do_locals(int param)
+{
+    if_show_info(varview_get());
+    return 0;
+}
+
+int command_do_memory(int param)
+{
+    std::string expression = command_get_rest_of_line();
+
+    if (!expression.empty())
+        memview_set_address(expression.c_str());
+
+    if_show_info(memview_get());
+    return 0;
+}
+
+int command_do_watch(int param)
+{
+    std::string expression = command_get_rest_of_line();
+
+    if (!expression.empty())
+        varview_add_watch(expression.c_str());
+
+    if_show_info(varview_get());
+    return 0;
+}
+
+int command_do_unwatch(int param)
+{
+    std::string expression = command_get_rest_of_line();
+
+    if (varview_remove_watch(expression.empty() ? NULL :
+                expression.c_str()) == 0 && !expression.empty()) {
+        if_print_message("\nNot watching: %s\n", expression.c_str());
+        return -1;
+    }
+
+    return 0;
+}
+
+int command_do_meminfo(int param)
+{
+    struct sviewer *sview = if_get_sview();
+    int limit = cgdbrc_get_int(CGDBRC_SOURCE_MEMORY);
+    int loaded, files;
+    size_t bytes;
+
+    source_memory_usage(sview, &loaded, &files, &bytes);
+
+    if_print_message("\n%d of %d source files loaded, %.1f MB", loaded, files,
+            bytes / (1024.0 * 1024.0));
+    if (limit > 0)
+        if_print_message(" of %d MB\n", limit);
+    else
+        if_print_message(", no limit\n");
+
+    return 0;
+}
+
 int command_source_reload(int param)
 {
     struct sviewer *sview = if_get_sview();
@@ -758,6 +986,10 @@ int command_source_reload(int param)
     if (!sview)
         return -1;
 
+    /* Files created or deleted since, like a generated file the user just
+     * built, show up in the file dialog */
+    fs_stat_cache_clear();
+
     /* If there is no current source file, then there is nothing to reload. */
     if (!sview->cur)
         return 0;
@@ -788,6 +1020,7 @@ int command_parse_syntax(int param)
 
             command_set_syntax_type(value);
 
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
         }
             break;
@@ -882,6 +1115,20 @@ static void variable_changed_cb(struct ConfigVariable *variable)
        so the appropriate data is displayed in the source window. */
     if (!strcmp(variable->name, "disasm"))
         tgdb_request_current_location(tgdb);
+
+    /* The highlight groups are drawn differently with and without color. */
+    if (!strcmp(variable->name, "color"))
+        hl_groups_invalidate_attrs(hl_groups_instance);
+
+    /* Release the files that don't fit anymore right away */
+    if (!strcmp(variable->name, "sourcememory"))
+        source_trim(if_get_sview());
+
+    if (!strcmp(variable->name, "gdbreadsize") ||
+        !strcmp(variable->name, "gdbreadbudget"))
+        tgdb_set_read_limits(tgdb,
+                cgdbrc_get_int(CGDBRC_GDB_READ_SIZE),
+                cgdbrc_get_int(CGDBRC_GDB_READ_BUDGET));
 }
 
 int command_parse_set(void)
@@ -1068,6 +1315,7 @@ int command_parse_string(const char *buffer)
                 source_set_sel_line(if_get_sview(), atoi(number));
                 rv = 0;
             }
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
         }
             break;
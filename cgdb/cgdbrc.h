@@ -118,11 +118,14 @@ enum cgdbrc_option_kind {
     CGDBRC_DEBUGWINCOLOR,
     CGDBRC_DISASM,
     CGDBRC_EXECUTING_LINE_DISPLAY,
+    CGDBRC_GDB_READ_BUDGET,
+    CGDBRC_GDB_READ_SIZE,
     CGDBRC_HLSEARCH,
     CGDBRC_IGNORECASE,
     CGDBRC_SCROLLBACK_BUFFER_SIZE,
     CGDBRC_SELECTED_LINE_DISPLAY,
     CGDBRC_SHOWMARKS,
+    CGDBRC_SOURCE_MEMORY,
     CGDBRC_SYNTAX,
     CGDBRC_TABSTOP,
     CGDBRC_TIMEOUT,
@@ -149,10 +152,13 @@ struct cgdbrc_config_option {
         /* option_kind == CGDBRC_COLOR */
         /* option_kind == CGDBRC_DEBUGWINCOLOR */
         /* option_kind == CGDBRC_DISASM */
+        /* option_kind == CGDBRC_GDB_READ_BUDGET */
+        /* option_kind == CGDBRC_GDB_READ_SIZE */
         /* option_kind == CGDBRC_HLSEARCH */
         /* option_kind == CGDBRC_IGNORECASE */
         /* option_kind == CGDBRC_SCROLLBACK_BUFFER_SIZE */
         /* option_kind == CGDBRC_SHOWMARKS */
+        /* option_kind == CGDBRC_SOURCE_MEMORY */
         /* option_kind == CGDBRC_TABSTOP */
         /* option_kind == CGDBRC_TIMEOUT */
         /* option_kind == CGDBRC_TIMEOUTLEN */
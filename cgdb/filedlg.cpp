@@ -11,6 +11,8 @@
 #endif /* HAVE_STRING_H */
 
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "fs_util.h"
 
@@ -18,6 +20,7 @@
 #include "stretchy.h"
 #include "sys_win.h"
 #include "filedlg.h"
+#include "fuzzy.h"
 #include "cgdb.h"
 #include "cgdbrc.h"
 #include "highlight.h"
@@ -41,13 +44,29 @@ struct filedlg {
     struct hl_regex_info *hlregex;
     SWINDOW *win;               /* Curses window */
     std::string G_line_number;  /* Line number user wants to 'G' to */
+
+    /* Checks if the files exist in the background */
+    struct fs_verifier *verifier;
+    /* Files shown in the dialog that haven't been verified to exist yet */
+    std::unordered_set<std::string> unverified;
+
+    struct fuzzy_index *fuzzy; /* Index used by the fuzzy finder */
+    int fuzzy_dirty;            /* The files changed since fuzzy was built */
 };
 
+/* The number of threads used to check if the files in the dialog exist */
+#define FILEDLG_VERIFY_THREADS 4
+
 static char regex_line[MAX_LINE];   /* The regex the user enters */
 static int regex_line_pos;      /* The index into the current regex */
 static int regex_search;        /* Currently searching text ? */
 static int regex_direction;     /* Direction to search */
 
+static char fuzzy_line[MAX_LINE];   /* The fuzzy query the user enters */
+static int fuzzy_line_pos;      /* The index into the current fuzzy query */
+static int fuzzy_search;        /* Currently using the fuzzy finder ? */
+static int fuzzy_sel;           /* The selected fuzzy finder match */
+
 /* print_in_middle: Prints the message 'string' centered at line in win 
  * ----------------
  *
@@ -98,6 +117,11 @@ struct filedlg *filedlg_new(int pos_r, int pos_c, int height, int width)
     fd->buf->sel_col = 0;
     fd->buf->sel_rline = 0;
 
+    fd->verifier = fs_verifier_create(FILEDLG_VERIFY_THREADS);
+
+    fd->fuzzy = fuzzy_index_new();
+    fd->fuzzy_dirty = 1;
+
     return fd;
 }
 
@@ -105,6 +129,12 @@ void filedlg_free(struct filedlg *fdlg)
 {
     filedlg_clear(fdlg);
 
+    fs_verifier_destroy(fdlg->verifier);
+    fdlg->verifier = NULL;
+
+    fuzzy_index_free(fdlg->fuzzy);
+    fdlg->fuzzy = NULL;
+
     hl_regex_free(&fdlg->last_hlregex);
     fdlg->last_hlregex = NULL;
 
@@ -125,6 +155,7 @@ int filedlg_add_file_choice(struct filedlg *fd, const char *file_choice)
     int length;
     int index, i;
     int equal = 1;              /* Not set to 0, because 0 *is* equal */
+    int unverified = 0;
 
     if (file_choice == NULL || *file_choice == '\0')
         return -1;
@@ -135,10 +166,22 @@ int filedlg_add_file_choice(struct filedlg *fd, const char *file_choice)
      *
      * The downside to not showing them all is that a user might
      * not understand why certain files aren't showing up. O well.
+     *
+     * Checking every file can take a long time on a slow file system,
+     * so unless the answer is already cached the file is shown right
+     * away and checked in the background. See filedlg_process_verified.
      */
     if (file_choice[0] != '*') {
-        if (fs_verify_file_exists(file_choice) == 0)
+        int exists;
+
+        if (fs_stat_cache_lookup(file_choice, &exists)) {
+            if (!exists)
+                return -4;
+        } else if (fd->verifier) {
+            unverified = 1;
+        } else if (fs_verify_file_exists_cached(file_choice) == 0) {
             return -4;
+        }
     }
 
     /* find index to insert by comparing:
@@ -186,6 +229,13 @@ int filedlg_add_file_choice(struct filedlg *fd, const char *file_choice)
     if ((length = strlen(file_choice)) > fd->buf->max_width)
         fd->buf->max_width = length;
 
+    fd->fuzzy_dirty = 1;
+
+    if (unverified) {
+        fd->unverified.insert(file_choice);
+        fs_verifier_submit(fd->verifier, file_choice);
+    }
+
     return 0;
 }
 
@@ -195,6 +245,12 @@ void filedlg_clear(struct filedlg *fd)
 
     fd->G_line_number.clear();
 
+    if (fd->verifier)
+        fs_verifier_cancel(fd->verifier);
+    fd->unverified.clear();
+
+    fd->fuzzy_dirty = 1;
+
     for (i = 0; i < sbcount(fd->buf->files); i++)
         free(fd->buf->files[i]);
 
@@ -207,6 +263,59 @@ void filedlg_clear(struct filedlg *fd)
     fd->buf->sel_rline = 0;
 }
 
+int filedlg_get_verify_fd(struct filedlg *fd)
+{
+    return fd->verifier ? fs_verifier_get_fd(fd->verifier) : -1;
+}
+
+int filedlg_process_verified(struct filedlg *fd)
+{
+    std::vector<fs_verify_result> results;
+    std::unordered_set<std::string> missing;
+    int i, j, length;
+    int sel_line = fd->buf->sel_line;
+
+    if (!fd->verifier || fs_verifier_collect(fd->verifier, results) == 0)
+        return 0;
+
+    for (const fs_verify_result &result : results) {
+        if (fd->unverified.erase(result.path) && !result.exists)
+            missing.insert(result.path);
+    }
+
+    if (missing.empty())
+        return 1;
+
+    /* Remove the missing files in a single pass, keeping the
+     * selection on the same file if it is still around. */
+    fd->buf->max_width = 0;
+    for (i = 0, j = 0; i < sbcount(fd->buf->files); i++) {
+        char *file = fd->buf->files[i];
+
+        if (missing.count(file)) {
+            if (i < fd->buf->sel_line)
+                sel_line--;
+            free(file);
+            continue;
+        }
+
+        if ((length = strlen(file)) > fd->buf->max_width)
+            fd->buf->max_width = length;
+        fd->buf->files[j++] = file;
+    }
+    sbsetcount(fd->buf->files, j);
+    fd->fuzzy_dirty = 1;
+
+    if (sel_line >= j)
+        sel_line = j - 1;
+    if (sel_line < 0)
+        sel_line = 0;
+    fd->buf->sel_line = sel_line;
+    fd->buf->sel_rline = sel_line;
+
+    return 1;
+}
+
 static int clamp_line(struct filedlg *fd, int line)
 {
     if (line < 0)
@@ -336,8 +445,10 @@ int filedlg_display(struct filedlg *fd)
     int statusbar;
     int arrow_attr;
     int count = sbcount(fd->buf->files);
+    int sel_line = fd->buf->sel_line;
     int hlsearch = cgdbrc_get_int(CGDBRC_HLSEARCH);
     static const char label[] = "Select a file or press q to cancel.";
+    char checking_label[MAX_LINE];
 
     swin_curs_set(0);
 
@@ -350,6 +461,12 @@ int filedlg_display(struct filedlg *fd)
         return 0;
     }
 
+    /* The fuzzy finder only shows the matches, best match first */
+    if (fuzzy_search) {
+        count = fuzzy_index_result_count(fd->fuzzy);
+        sel_line = fuzzy_sel;
+    }
+
     /* Initialize variables */
     height = swin_getmaxy(fd->win);
     width = swin_getmaxx(fd->win);
@@ -362,7 +479,7 @@ int filedlg_display(struct filedlg *fd)
     if (count < height)
         file = (count - height) / 2;
     else {
-        file = fd->buf->sel_line - height / 2;
+        file = sel_line - height / 2;
         if (file > count - height)
             file = count - height;
         else if (file < 0)
@@ -373,7 +490,13 @@ int filedlg_display(struct filedlg *fd)
     lwidth = log10_uint(count) + 1;
     snprintf(fmt, sizeof(fmt), "%%%dd", lwidth);
 
-    print_in_middle(fd->win, 0, width, label);
+    if (!fd->unverified.empty()) {
+        snprintf(checking_label, sizeof(checking_label),
+                "%s (checking %d files)", label, (int)fd->unverified.size());
+        print_in_middle(fd->win, 0, width, checking_label);
+    } else {
+        print_in_middle(fd->win, 0, width, label);
+    }
 
     swin_wmove(fd->win, 0, 0);
 
@@ -398,10 +521,11 @@ int filedlg_display(struct filedlg *fd)
         }
 
         int x, y;
-        char *filename = fd->buf->files[file];
+        char *filename = fd->buf->files[fuzzy_search ?
+                fuzzy_index_result(fd->fuzzy, file) : file];
 
         /* Mark the current file with an arrow */
-        if (file == fd->buf->sel_line) {
+        if (file == sel_line) {
             swin_wattron(fd->win, SWIN_A_BOLD);
             swin_wprintw(fd->win, fmt, file + 1);
             swin_wattroff(fd->win, SWIN_A_BOLD);
@@ -416,8 +540,12 @@ int filedlg_display(struct filedlg *fd)
             /* Ordinary file */
             swin_wprintw(fd->win, fmt, file + 1);
 
+            /* Files not yet known to exist are marked with a '?' */
             swin_wattron(fd->win, SWIN_A_BOLD);
-            swin_waddch(fd->win, SWIN_SYM_VLINE);
+            if (fd->unverified.empty() || !fd->unverified.count(filename))
+                swin_waddch(fd->win, SWIN_SYM_VLINE);
+            else
+                swin_waddch(fd->win, '?');
             swin_wattroff(fd->win, SWIN_A_BOLD);
 
             swin_waddch(fd->win, ' ');
@@ -429,6 +557,26 @@ int filedlg_display(struct filedlg *fd)
         hl_printline(fd->win, filename, strlen(filename),
                      NULL, -1, -1, fd->buf->sel_col, width - lwidth - 2);
 
+        // if the fuzzy finder is in use
+        //   display the characters that matched the query
+        if (fuzzy_search && fuzzy_line_pos) {
+            struct hl_line_attr *attrs = NULL;
+            int positions[MAX_LINE];
+            int j;
+
+            if (fuzzy_match(filename, fuzzy_line, positions) >= 0) {
+                for (j = 0; j < fuzzy_line_pos; j++) {
+                    sbpush(attrs, hl_line_attr(positions[j], HLG_INCSEARCH));
+                    sbpush(attrs, hl_line_attr(positions[j] + 1, 0));
+                }
+
+                hl_printline_highlight(fd->win, filename, strlen(filename),
+                             attrs, x, y, fd->buf->sel_col, width - lwidth - 2);
+                sbfree(attrs);
+            }
+            continue;
+        }
+
         // if highlight search is on
         //   display the last successful search
         //   unless we are starting a new search
@@ -458,7 +606,7 @@ int filedlg_display(struct filedlg *fd)
 
         // if the currently line being displayed is the selected line
         //   display the current search as an incremental search
-        if (regex_search && file == fd->buf->sel_line) {
+        if (regex_search && file == sel_line) {
             struct hl_line_attr *attrs = hl_regex_highlight(
                     &fd->hlregex, filename, HLG_INCSEARCH);
 
@@ -482,14 +630,16 @@ int filedlg_display(struct filedlg *fd)
     for (i = 0; i < width; i++)
         swin_mvwprintw(fd->win, height - 1, i, " ");
 
-    if (regex_search && regex_direction)
+    if (fuzzy_search)
+        swin_mvwprintw(fd->win, height - 1, 0, "Find:%s", fuzzy_line);
+    else if (regex_search && regex_direction)
         swin_mvwprintw(fd->win, height - 1, 0, "Search:%s", regex_line);
     else if (regex_search)
         swin_mvwprintw(fd->win, height - 1, 0, "RSearch:%s", regex_line);
 
     swin_wattroff(fd->win, statusbar);
 
-    swin_wmove(fd->win, height - (file - fd->buf->sel_line) - 1, lwidth + 2);
+    swin_wmove(fd->win, height - (file - sel_line) - 1, lwidth + 2);
     swin_wrefresh(fd->win);
 
     return 0;
@@ -583,6 +733,106 @@ static int capture_regex(struct filedlg *fd)
     return 0;
 }
 
+/* capture_fuzzy: Runs the fuzzy finder until the user picks a file.
+ * --------------
+ *  Side Effect: 
+ *
+ *  fuzzy_line: The query the user has entered.
+ *  fuzzy_line_pos: The next available index into fuzzy_line.
+ *  fd->buf->sel_line: The file the user picked.
+ *
+ * Return Value: 0 if user picked a file, otherwise 1.
+ */
+static int capture_fuzzy(struct filedlg *fd)
+{
+    int c;
+    int count;
+    int height = swin_getmaxy(fd->win) - 2;
+    extern kui_manager *kui_ctx;
+
+    /* Only index the files again if they changed since the last time */
+    if (fd->fuzzy_dirty) {
+        fuzzy_index_build(fd->fuzzy, fd->buf->files, sbcount(fd->buf->files));
+        fd->fuzzy_dirty = 0;
+    }
+
+    /* Initialize the fuzzy finder and tell user */
+    fuzzy_search = 1;
+    fuzzy_sel = 0;
+    fuzzy_line_pos = 0;
+    fuzzy_line[fuzzy_line_pos] = '\0';
+    count = fuzzy_index_set_query(fd->fuzzy, fuzzy_line);
+    filedlg_display(fd);
+
+    do {
+        c = kui_ctx->getkey_blocking();
+
+        /* Quit the fuzzy finder if the user hit escape */
+        if (c == CGDB_KEY_ESC) {
+            fuzzy_search = 0;
+            filedlg_display(fd);
+            return 1;
+        }
+
+        /* If the user hit enter, then pick the selected match */
+        if (c == '\r' || c == '\n' || c == CGDB_KEY_CTRL_M) {
+            if (count == 0)
+                continue;
+            break;
+        }
+
+        switch (c) {
+            case CGDB_KEY_DOWN:
+            case CGDB_KEY_CTRL_N:
+                fuzzy_sel++;
+                break;
+            case CGDB_KEY_UP:
+            case CGDB_KEY_CTRL_P:
+                fuzzy_sel--;
+                break;
+            case CGDB_KEY_NPAGE:
+                fuzzy_sel += height - 1;
+                break;
+            case CGDB_KEY_PPAGE:
+                fuzzy_sel -= height - 1;
+                break;
+            case 8:
+            case 127:
+                /* If the user hit backspace or delete remove a char */
+                if (fuzzy_line_pos > 0)
+                    --fuzzy_line_pos;
+
+                fuzzy_line[fuzzy_line_pos] = '\0';
+                count = fuzzy_index_set_query(fd->fuzzy, fuzzy_line);
+                fuzzy_sel = 0;
+                break;
+            default:
+                /* Add a printable char and refine the matches */
+                if (c < 32 || c > 126 || fuzzy_line_pos == (MAX_LINE - 1))
+                    break;
+
+                fuzzy_line[fuzzy_line_pos++] = c;
+                fuzzy_line[fuzzy_line_pos] = '\0';
+                count = fuzzy_index_set_query(fd->fuzzy, fuzzy_line);
+                fuzzy_sel = 0;
+                break;
+        }
+
+        if (fuzzy_sel >= count)
+            fuzzy_sel = count - 1;
+        if (fuzzy_sel < 0)
+            fuzzy_sel = 0;
+
+        filedlg_display(fd);
+    } while (1);
+
+    /* Finished */
+    fuzzy_search = 0;
+    filedlg_set_sel_line(fd, fuzzy_index_result(fd->fuzzy, fuzzy_sel));
+    filedlg_display(fd);
+    return 0;
+}
+
 int filedlg_recv_char(struct filedlg *fd, int key, char *file, int last_key_pressed)
 {
     /* Initialize size variables */
@@ -633,6 +883,13 @@ int filedlg_recv_char(struct filedlg *fd, int key, char *file, int last_key_pres
             filedlg_search_regex_init(fd);
             capture_regex(fd);
             break;
+        case 'f':
+            /* Fuzzy find a file, and select it right away */
+            if (capture_fuzzy(fd) == 0) {
+                strcpy(file, fd->buf->files[fd->buf->sel_line]);
+                return 1;
+            }
+            break;
         case 'n':
             filedlg_search_regex(fd, regex_line, 2, regex_direction, 1);
             break;
@@ -36,6 +36,26 @@ int filedlg_add_file_choice(struct filedlg *fd, const char *file_choice);
  */
 void filedlg_clear(struct filedlg *fd);
 
+/* filedlg_get_verify_fd: Get the descriptor used to check files in the background.
+ * ----------------------
+ *
+ * Files added with filedlg_add_file_choice are checked for existence in the
+ * background. This descriptor becomes readable when results are available,
+ * at which point filedlg_process_verified should be called.
+ *
+ * Returns the descriptor, or -1 if files are checked synchronously.
+ */
+int filedlg_get_verify_fd(struct filedlg *fd);
+
+/* filedlg_process_verified: Apply the background existence checks.
+ * -------------------------
+ *
+ * Files found not to exist are removed from the dialog.
+ *
+ * Returns 1 if the dialog changed and should be redrawn, otherwise 0.
+ */
+int filedlg_process_verified(struct filedlg *fd);
+
 /* filedlg_recv_char: Sens a character to the filedlg.
  *
  *   fdlg:  The file dialog to free.
@@ -0,0 +1,264 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#if HAVE_CTYPE_H
+#include <ctype.h>
+#endif /* HAVE_CTYPE_H */
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "fuzzy.h"
+
+/* Score awarded for every matched character */
+#define FUZZY_SCORE_MATCH 16
+/* Bonus for a character matched right after the previous one */
+#define FUZZY_SCORE_CONSECUTIVE 8
+/* Bonus for a character matched at the start of a word (after a '/', etc) */
+#define FUZZY_SCORE_BOUNDARY 8
+/* Bonus for a character matched in the file name rather than the directory */
+#define FUZZY_SCORE_BASENAME 4
+
+struct fuzzy_index {
+    char **entries;
+    int count;
+
+    /* For every (lower cased) byte, the entries that contain it, sorted */
+    std::vector<int> postings[256];
+
+    /* The (lower cased) query the levels were computed for */
+    std::string query;
+
+    /* levels[i] holds the entries matching the first i+1 characters
+     * of query, sorted by position */
+    std::vector< std::vector<int> > levels;
+
+    /* The entries matching query, best match first */
+    std::vector<int> ranked;
+};
+
+static unsigned char fuzzy_fold(char c)
+{
+    return (unsigned char)tolower((unsigned char)c);
+}
+
+static int fuzzy_is_boundary(char c)
+{
+    return c == '/' || c == '_' || c == '-' || c == '.' || c == ' ';
+}
+
+/* Returns 1 if the first length characters of query (already folded)
+ * appear in entry in order, otherwise 0. */
+static int fuzzy_is_subsequence(const char *entry, const std::string &query,
+        size_t length)
+{
+    size_t qi = 0;
+
+    for (; *entry && qi < length; ++entry) {
+        if (fuzzy_fold(*entry) == (unsigned char)query[qi])
+            ++qi;
+    }
+
+    return qi == length;
+}
+
+struct fuzzy_index *fuzzy_index_new(void)
+{
+    struct fuzzy_index *index = new fuzzy_index();
+
+    index->entries = NULL;
+    index->count = 0;
+
+    return index;
+}
+
+void fuzzy_index_free(struct fuzzy_index *index)
+{
+    delete index;
+}
+
+void fuzzy_index_build(struct fuzzy_index *index, char **entries, int count)
+{
+    int i, c;
+
+    index->entries = entries;
+    index->count = count;
+
+    for (c = 0; c < 256; ++c)
+        index->postings[c].clear();
+
+    for (i = 0; i < count; ++i) {
+        bool seen[256] = { false };
+        const char *entry;
+
+        for (entry = entries[i]; *entry; ++entry) {
+            unsigned char folded = fuzzy_fold(*entry);
+
+            if (!seen[folded]) {
+                seen[folded] = true;
+                index->postings[folded].push_back(i);
+            }
+        }
+    }
+
+    index->query.clear();
+    index->levels.clear();
+    index->ranked.clear();
+}
+
+int fuzzy_index_set_query(struct fuzzy_index *index, const char *query)
+{
+    std::string folded;
+    std::vector< std::pair<int, int> > scored;
+    size_t common, i;
+
+    for (; *query; ++query)
+        folded.push_back((char)fuzzy_fold(*query));
+
+    /* Keep the levels shared with the previous query */
+    common = 0;
+    while (common < folded.size() && common < index->query.size() &&
+            folded[common] == index->query[common])
+        ++common;
+    if (index->levels.size() > common)
+        index->levels.resize(common);
+
+    index->query = folded;
+
+    /* Narrow the candidates one query character at a time. The new
+     * character must be in the entry, so only the entries in both the
+     * previous level and the character's postings are looked at. */
+    for (i = index->levels.size(); i < folded.size(); ++i) {
+        const std::vector<int> &postings =
+                index->postings[(unsigned char)folded[i]];
+        std::vector<int> level;
+
+        if (i == 0) {
+            level = postings;
+        } else {
+            const std::vector<int> &previous = index->levels[i - 1];
+            std::vector<int> candidates;
+
+            std::set_intersection(previous.begin(), previous.end(),
+                    postings.begin(), postings.end(),
+                    std::back_inserter(candidates));
+
+            for (int candidate : candidates) {
+                if (fuzzy_is_subsequence(index->entries[candidate],
+                            folded, i + 1))
+                    level.push_back(candidate);
+            }
+        }
+
+        index->levels.push_back(std::move(level));
+    }
+
+    /* Rank the matches */
+    index->ranked.clear();
+    if (!folded.empty()) {
+        const std::vector<int> &matches = index->levels.back();
+
+        scored.reserve(matches.size());
+        for (int match : matches) {
+            int score = fuzzy_match(index->entries[match], folded.c_str(), NULL);
+            scored.push_back(std::make_pair(-score, match));
+        }
+
+        std::sort(scored.begin(), scored.end());
+
+        index->ranked.reserve(scored.size());
+        for (const std::pair<int, int> &item : scored)
+            index->ranked.push_back(item.second);
+    }
+
+    return fuzzy_index_result_count(index);
+}
+
+int fuzzy_index_result_count(struct fuzzy_index *index)
+{
+    if (index->query.empty())
+        return index->count;
+
+    return index->ranked.size();
+}
+
+int fuzzy_index_result(struct fuzzy_index *index, int rank)
+{
+    if (index->query.empty())
+        return rank;
+
+    return index->ranked[rank];
+}
+
+int fuzzy_match(const char *entry, const char *query, int *positions)
+{
+    int length = strlen(entry);
+    int qlength = strlen(query);
+    int basename, start, end, prev;
+    int score = 0;
+    int i, qi;
+
+    if (qlength == 0)
+        return 0;
+
+    /* Find where the first (leftmost) match ends */
+    end = -1;
+    for (i = 0, qi = 0; i < length; ++i) {
+        if (fuzzy_fold(entry[i]) == fuzzy_fold(query[qi]) && ++qi == qlength) {
+            end = i;
+            break;
+        }
+    }
+
+    if (end == -1)
+        return -1;
+
+    /* Then walk back to find the shortest match ending there */
+    start = 0;
+    for (i = end, qi = qlength - 1; i >= 0; --i) {
+        if (fuzzy_fold(entry[i]) == fuzzy_fold(query[qi]) && --qi < 0) {
+            start = i;
+            break;
+        }
+    }
+
+    basename = 0;
+    for (i = 0; i < length; ++i) {
+        if (entry[i] == '/')
+            basename = i + 1;
+    }
+
+    /* Score the characters matched in that window */
+    prev = -2;
+    for (i = start, qi = 0; qi < qlength; ++i) {
+        if (fuzzy_fold(entry[i]) != fuzzy_fold(query[qi]))
+            continue;
+
+        score += FUZZY_SCORE_MATCH;
+        if (i == prev + 1)
+            score += FUZZY_SCORE_CONSECUTIVE;
+        if (i == 0 || fuzzy_is_boundary(entry[i - 1]))
+            score += FUZZY_SCORE_BOUNDARY;
+        if (i >= basename)
+            score += FUZZY_SCORE_BASENAME;
+
+        if (positions)
+            positions[qi] = i;
+
+        prev = i;
+        ++qi;
+    }
+
+    /* Prefer tight matches, then short entries */
+    score -= (prev - start + 1) - qlength;
+    score -= length / 16;
+
+    return score < 0 ? 0 : score;
+}
@@ -0,0 +1,82 @@
+#ifndef _FUZZY_H_
+#define _FUZZY_H_
+
+/* The fuzzy finder.
+ *
+ * Ranks a list of entries (file names) against a query, where an entry
+ * matches if the characters of the query appear in it, in order, but not
+ * necessarily next to each other. Case is ignored.
+ *
+ * The entries are indexed once, by character, when fuzzy_index_build is
+ * called. Each query is answered incrementally from the previous one.
+ * Typing a character only looks at the entries that matched the previous
+ * query and contain the new character, and deleting a character reuses
+ * the results that were computed for the shorter query.
+ */
+
+struct fuzzy_index;
+
+/* fuzzy_index_new: Create a new, empty, fuzzy index.
+ * ----------------
+ *
+ * return value: a new fuzzy_index.
+ */
+struct fuzzy_index *fuzzy_index_new(void);
+
+/* fuzzy_index_free: Release the memory associated with a fuzzy index.
+ * -----------------
+ */
+void fuzzy_index_free(struct fuzzy_index *index);
+
+/* fuzzy_index_build: Index a list of entries.
+ * ------------------
+ *
+ *   index:   The index to build, any previous entries are forgotten.
+ *   entries: The entries to index. They are referenced, not copied, and
+ *            must not change until the index is rebuilt or freed.
+ *   count:   The number of entries.
+ */
+void fuzzy_index_build(struct fuzzy_index *index, char **entries, int count);
+
+/* fuzzy_index_set_query: Rank the entries against a new query.
+ * ----------------------
+ *
+ *   index: The index to query.
+ *   query: The query. If it extends or shortens the previous query
+ *          the previous results are reused.
+ *
+ * return value: the number of matching entries.
+ */
+int fuzzy_index_set_query(struct fuzzy_index *index, const char *query);
+
+/* fuzzy_index_result_count: The number of entries matching the query.
+ * -------------------------
+ *
+ * An empty query matches every entry, in the original order.
+ */
+int fuzzy_index_result_count(struct fuzzy_index *index);
+
+/* fuzzy_index_result: Get a matching entry.
+ * -------------------
+ *
+ *   index: The index to query.
+ *   rank:  The rank of the match, starting with the best match at 0.
+ *
+ * return value: the position of the entry in the list that was indexed.
+ */
+int fuzzy_index_result(struct fuzzy_index *index, int rank);
+
+/* fuzzy_match: Match a single entry against a query.
+ * ------------
+ *
+ *   entry:     The entry to match.
+ *   query:     The query to match against.
+ *   positions: If not NULL, the offsets of the matched characters in entry
+ *              are stored here. It must hold strlen(query) elements.
+ *
+ * return value: the score of the match, higher is better, or -1 if
+ *               the entry does not match.
+ */
+int fuzzy_match(const char *entry, const char *query, int *positions);
+
+#endif /* _FUZZY_H_ */
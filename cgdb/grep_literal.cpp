@@ -0,0 +1,81 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#include <string>
+
+#include "grep_literal.h"
+
+/* The characters that stand for themselves when escaped */
+#define GREP_LITERAL_ESCAPES ".[]()*+?{}|^$\\/"
+
+std::string grep_literal(const char *regex)
+{
+    std::string best, run;
+    int depth = 0;
+    const char *p;
+
+    for (p = regex; *p; ++p) {
+        if (*p == '|')
+            return std::string();
+    }
+
+    for (p = regex; *p; ++p) {
+        char c = *p;
+
+        if (c == '\\') {
+            if (!p[1])
+                return std::string();
+
+            /* An escaped metacharacter is a literal. Anything else is a
+             * class, an anchor like \< or \`, or a back reference, and
+             * ends the run. */
+            if (strchr(GREP_LITERAL_ESCAPES, p[1]) && depth == 0) {
+                run.push_back(*++p);
+                continue;
+            }
+            ++p;
+        } else if (c == '[') {
+            /* Skip the bracket expression, ']' first is literal */
+            ++p;
+            if (*p == '^')
+                ++p;
+            if (*p == ']')
+                ++p;
+            while (*p && *p != ']')
+                ++p;
+            if (!*p)
+                return std::string();
+        } else if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            depth--;
+        } else if (c == '*' || c == '?' || c == '{') {
+            /* The previous character is optional */
+            if (!run.empty())
+                run.erase(run.size() - 1);
+            if (c == '{') {
+                while (*p && *p != '}')
+                    ++p;
+                if (!*p)
+                    return std::string();
+            }
+        } else if (c != '.' && c != '^' && c != '$' && c != '+' && depth == 0) {
+            run.push_back(c);
+            continue;
+        }
+
+        if (run.size() > best.size())
+            best = run;
+        run.clear();
+    }
+
+    if (run.size() > best.size())
+        best = run;
+
+    return best;
+}
@@ -0,0 +1,19 @@
+#ifndef _GREP_LITERAL_H_
+#define _GREP_LITERAL_H_
+
+#include <string>
+
+/* grep_literal:  Find a string every match of a regex must contain.
+ * -------------
+ *
+ * Lines without the string can be skipped without running the regex.
+ * Only the simple cases are handled, anything unusual (alternation,
+ * back references, etc) gives up and returns an empty string.
+ *
+ *   regex:  The extended regular expression
+ *   return: The longest literal run of characters outside of any group
+ *           or bracket expression, or an empty string.
+ */
+std::string grep_literal(const char *regex);
+
+#endif /* _GREP_LITERAL_H_ */
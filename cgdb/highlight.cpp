@@ -30,8 +30,12 @@ struct hl_regex_info {
     regex_t t;
     int icase;
     char *regex;
+    unsigned long generation;
 };
 
+/* The generation of the last regular expression compiled */
+static unsigned long hl_regex_last_generation;
+
 void hl_regex_free(struct hl_regex_info **info)
 {
     if (info && *info && (*info)->regex) {
@@ -87,6 +91,7 @@ int hl_regex_search(struct hl_regex_info **info, const char *line,
 
         (*info)->regex = strdup(regex);
         (*info)->icase = icase;
+        (*info)->generation = ++hl_regex_last_generation;
     }
 
     result = regexec(&(*info)->t, line, 1, &pmatch, 0);
@@ -100,6 +105,14 @@ int hl_regex_search(struct hl_regex_info **info, const char *line,
     return 0;
 }
 
+unsigned long hl_regex_generation(struct hl_regex_info *info)
+{
+    if (!info || !info->regex)
+        return 0;
+
+    return info->generation;
+}
+
 struct hl_line_attr *hl_regex_highlight(struct hl_regex_info **info,
         char *line, enum hl_group_kind group_kind)
 {
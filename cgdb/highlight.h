@@ -45,6 +45,22 @@ int hl_regex_search(struct hl_regex_info **info, const char *line,
  */
 void hl_regex_free(struct hl_regex_info **info);
 
+/**
+ * Get the generation of a regular expression context.
+ *
+ * Every time a regular expression is compiled into a context, it gets
+ * a new generation. This allows the results of a search to be cached,
+ * and thrown away when the regular expression changes.
+ *
+ * @param info
+ * The regular expression context, or NULL.
+ *
+ * @return
+ * The generation of the compiled regular expression, or 0 if there is
+ * no regular expression.
+ */
+unsigned long hl_regex_generation(struct hl_regex_info *info);
+
 /**
  * Highlight the regular expressions found.
  *
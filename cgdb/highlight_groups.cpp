@@ -50,21 +50,26 @@ struct hl_groups {
      */
     bool ansi_color_support;
 
-    /** This is the data for each highlighting group. */
+    /** This is the data for each highlighting group, indexed by kind - 1. */
     struct hl_group_info groups[HLG_LAST];
+
+    /**
+     * The attributes to draw each kind of group with, indexed by kind.
+     *
+     * Computed all at once when first needed, and recomputed after a
+     * group or the color mode changes.
+     */
+    int attrs[HLG_BOLD_WHITE + 1];
+
+    /** True if attrs is up to date. */
+    bool attrs_valid;
 };
 
 static struct hl_group_info *lookup_group_info_by_key(struct hl_groups *groups,
         enum hl_group_kind kind)
 {
-    if (groups) {
-        int i;
-        for (i = 0; i < HLG_LAST; ++i) {
-            struct hl_group_info *lgroups = &groups->groups[i];
-            if (kind == lgroups->kind)
-                return lgroups;
-        }
-    }
+    if (groups && kind >= HLG_KEYWORD && kind <= HLG_LAST)
+        return &groups->groups[kind - 1];
 
     return NULL;
 }
@@ -382,6 +387,8 @@ setup_group(hl_groups_ptr hl_groups, enum hl_group_kind group,
     if (!info)
         return -1;
 
+    hl_groups->attrs_valid = false;
+
     if (mono_attrs != UNSPECIFIED_COLOR)
         info->mono_attrs = mono_attrs;
     if (color_attrs != UNSPECIFIED_COLOR)
@@ -487,6 +494,7 @@ hl_groups_ptr hl_groups_initialize(void)
     
     hl_groups = (hl_groups_ptr) cgdb_malloc(sizeof (struct hl_groups));
     hl_groups->ansi_color_support = false;
+    hl_groups->attrs_valid = false;
 
     for (i = 0; i < HLG_LAST; ++i) {
         struct hl_group_info *info;
@@ -523,8 +531,8 @@ int hl_groups_shutdown(hl_groups_ptr hl_groups)
 
 /*@{*/
 
-int
-hl_groups_get_attr(hl_groups_ptr hl_groups, enum hl_group_kind kind)
+static int
+hl_groups_compute_attr(hl_groups_ptr hl_groups, enum hl_group_kind kind)
 {
     struct hl_group_info *info = lookup_group_info_by_key(hl_groups, kind);
     int attr = (kind == HLG_EXECUTING_LINE_HIGHLIGHT) ?  SWIN_A_BOLD : SWIN_A_NORMAL;
@@ -592,6 +600,30 @@ hl_groups_get_attr(hl_groups_ptr hl_groups, enum hl_group_kind kind)
     return attr;
 }
 
+int
+hl_groups_get_attr(hl_groups_ptr hl_groups, enum hl_group_kind kind)
+{
+    if (!hl_groups || kind < HLG_KEYWORD || kind > HLG_BOLD_WHITE)
+        return hl_groups_compute_attr(hl_groups, kind);
+
+    if (!hl_groups->attrs_valid) {
+        int i;
+
+        for (i = HLG_KEYWORD; i <= HLG_BOLD_WHITE; ++i)
+            hl_groups->attrs[i] =
+                hl_groups_compute_attr(hl_groups, (enum hl_group_kind)i);
+        hl_groups->attrs_valid = true;
+    }
+
+    return hl_groups->attrs[kind];
+}
+
+void hl_groups_invalidate_attrs(hl_groups_ptr hl_groups)
+{
+    if (hl_groups)
+        hl_groups->attrs_valid = false;
+}
+
 int hl_groups_parse_config(hl_groups_ptr hl_groups)
 {
     int token, val;
@@ -152,6 +152,18 @@ int hl_groups_shutdown(hl_groups_ptr hl_groups);
  */
 int hl_groups_get_attr(hl_groups_ptr hl_groups, enum hl_group_kind kind);
 
+/**
+ * Forget the attributes computed for the groups.
+ *
+ * The attributes of every group are computed once and reused. They are
+ * recomputed when a group is changed, but this must be called when
+ * something else they depend on, like the color option, changes.
+ *
+ * \param hl_groups
+ * An instance of hl_groups to operate on.
+ */
+void hl_groups_invalidate_attrs(hl_groups_ptr hl_groups);
+
 /**
  * Parse a particular command. This may move into the cgdbrc file later on.
  *
@@ -0,0 +1,258 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#include <algorithm>
+#include <string>
+
+#include "sys_util.h"
+#include "sys_win.h"
+#include "infowin.h"
+#include "kui_term.h"
+#include "highlight_groups.h"
+
+struct infowin {
+    SWINDOW *win;               /* Curses window */
+    struct infowin_view *view;  /* The view shown, or NULL */
+    int sel;                    /* The selected row */
+    int top;                    /* The row shown first */
+};
+
+/* The inferior runs, the views have nothing to fetch */
+static bool running;
+
+void infowin_set_running(bool r)
+{
+    running = r;
+}
+
+bool infowin_running(void)
+{
+    return running;
+}
+
+bool infowin_missing_rows(int first, int last, int count,
+        bool (*missing)(int row), int *low, int *high)
+{
+    int margin = (last - first + 1) / 2;
+    int from = std::max(first - margin, 0);
+    int to = std::min(last + margin, count - 1);
+    int row;
+
+    for (row = std::max(first, 0); row <= std::min(last, to); row++) {
+        if (missing(row))
+            break;
+    }
+
+    /* All of the screen is there, read ahead */
+    if (row > std::min(last, to)) {
+        for (row = from; row <= to && !missing(row); row++)
+            ;
+        if (row > to)
+            return false;
+    }
+
+    *low = *high = row;
+    while (*high < to && missing(*high + 1))
+        (*high)++;
+
+    return true;
+}
+
+struct infowin *infowin_new(SWINDOW *win)
+{
+    struct infowin *iw;
+
+    iw = (struct infowin *)cgdb_malloc(sizeof(struct infowin));
+    iw->win = win;
+    iw->view = NULL;
+    iw->sel = 0;
+    iw->top = 0;
+
+    return iw;
+}
+
+void infowin_free(struct infowin *iw)
+{
+    swin_delwin(iw->win);
+    free(iw);
+}
+
+void infowin_move(struct infowin *iw, SWINDOW *win)
+{
+    swin_delwin(iw->win);
+    iw->win = win;
+}
+
+void infowin_set_view(struct infowin *iw, struct infowin_view *view)
+{
+    if (iw->view != view) {
+        iw->view = view;
+        iw->sel = 0;
+        iw->top = 0;
+    }
+}
+
+struct infowin_view *infowin_get_view(struct infowin *iw)
+{
+    return iw->view;
+}
+
+/* The number of rows the window has for the view, below the title bar */
+static int infowin_rows(struct infowin *iw)
+{
+    return iw->win ? std::max(swin_getmaxy(iw->win) - 1, 0) : 0;
+}
+
+static void infowin_set_sel(struct infowin *iw, int row)
+{
+    int count = iw->view ? iw->view->count() : 0;
+
+    iw->sel = std::max(std::min(row, count - 1), 0);
+}
+
+void infowin_input(struct infowin *iw, int key, int last_key)
+{
+    int rows = std::max(infowin_rows(iw), 1);
+
+    if (!iw->view)
+        return;
+
+    switch (key) {
+        case CGDB_KEY_DOWN:
+        case 'j':
+            infowin_set_sel(iw, iw->sel + 1);
+            break;
+        case CGDB_KEY_UP:
+        case 'k':
+            infowin_set_sel(iw, iw->sel - 1);
+            break;
+        case CGDB_KEY_NPAGE:
+        case CGDB_KEY_CTRL_F:  /* VI-style page down */
+            infowin_set_sel(iw, iw->sel + rows - 1);
+            break;
+        case CGDB_KEY_PPAGE:
+        case CGDB_KEY_CTRL_B:  /* VI-style page up */
+            infowin_set_sel(iw, iw->sel - (rows - 1));
+            break;
+        case CGDB_KEY_CTRL_D:  /* VI-style 1/2 page down */
+            infowin_set_sel(iw, iw->sel + rows / 2);
+            break;
+        case CGDB_KEY_CTRL_U:  /* VI-style 1/2 page up */
+            infowin_set_sel(iw, iw->sel - rows / 2);
+            break;
+        case 'g':              /* first row */
+            if (last_key == 'g')
+                infowin_set_sel(iw, 0);
+            break;
+        case 'G':              /* last row */
+            infowin_set_sel(iw, iw->view->count() - 1);
+            break;
+        case '\r':
+        case '\n':
+        case CGDB_KEY_CTRL_M:
+            if (iw->view->select && iw->sel < iw->view->count())
+                iw->view->select(iw->sel);
+            break;
+        default:
+            break;
+    }
+}
+
+void infowin_display(struct infowin *iw, int focus,
+        enum win_refresh dorefresh)
+{
+    int statusbar, arrow_attr;
+    int rows, width, count;
+    int i;
+    std::string title, text;
+
+    if (!iw->win)
+        return;
+
+    swin_curs_set(0);
+
+    statusbar = hl_groups_get_attr(hl_groups_instance, HLG_STATUS_BAR);
+    arrow_attr = hl_groups_get_attr(hl_groups_instance,
+            HLG_SELECTED_LINE_ARROW);
+
+    rows = infowin_rows(iw);
+    width = swin_getmaxx(iw->win);
+    count = iw->view ? iw->view->count() : 0;
+
+    /* Keep the selected row in view, the view may have shrunk */
+    infowin_set_sel(iw, iw->sel);
+    if (iw->sel < iw->top)
+        iw->top = iw->sel;
+    else if (iw->sel >= iw->top + rows)
+        iw->top = iw->sel - rows + 1;
+    iw->top = std::max(std::min(iw->top, count - rows), 0);
+
+    /* Let the view fetch the rows about to be shown */
+    if (iw->view && iw->view->fetch && rows > 0 && !running)
+        iw->view->fetch(iw->top, iw->top + rows - 1);
+
+    /* The title bar */
+    if (iw->view) {
+        if (running)
+            text = "running";
+        else if (iw->view->status)
+            iw->view->status(text);
+
+        title = iw->view->name;
+        if (!text.empty()) {
+            title.append(": ");
+            title.append(text);
+        }
+    }
+
+    swin_wattron(iw->win, statusbar);
+    if (focus)
+        swin_wattron(iw->win, SWIN_A_BOLD);
+    swin_wmove(iw->win, 0, 0);
+    swin_waddnstr(iw->win, title.c_str(), width);
+    for (i = std::min((int)title.size(), width); i < width; i++)
+        swin_waddch(iw->win, ' ');
+    if (focus)
+        swin_wattroff(iw->win, SWIN_A_BOLD);
+    swin_wattroff(iw->win, statusbar);
+
+    for (i = 0; i < rows; i++) {
+        int row = iw->top + i;
+
+        swin_wmove(iw->win, i + 1, 0);
+
+        if (row < count) {
+            bool have = iw->view->row(row, text);
+
+            /* Mark the selected row with an arrow */
+            if (row == iw->sel) {
+                swin_wattron(iw->win, arrow_attr);
+                swin_waddnstr(iw->win, "->", width);
+                swin_wattroff(iw->win, arrow_attr);
+            } else {
+                swin_waddnstr(iw->win, "  ", width);
+            }
+
+            /* Rows the view doesn't have yet are on their way */
+            if (width > 2)
+                swin_waddnstr(iw->win, have ? text.c_str() : "...",
+                        width - 2);
+        }
+
+        swin_wclrtoeol(iw->win);
+    }
+
+    if (dorefresh == WIN_REFRESH)
+        swin_wrefresh(iw->win);
+    else
+        swin_wnoutrefresh(iw->win);
+}
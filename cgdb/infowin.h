@@ -0,0 +1,152 @@
+// The info window, a list shown below the source window
+//
+// The info window shows one view at a time, like the stack. A view only
+// hands out the rows that are on screen, so it can fetch them from gdb as
+// the user scrolls instead of asking for all of them up front.
+
+#ifndef _INFOWIN_H_
+#define _INFOWIN_H_
+
+#include <string>
+
+#include "sys_win.h"
+
+// The rows of an info window
+struct infowin_view {
+    // The name shown in the title bar of the info window
+    const char *name;
+
+    // Get the number of rows in the view
+    int (*count)(void);
+
+    // Get the text of a row
+    //
+    // @param row
+    // The row, 0 is the first row
+    //
+    // @param text
+    // Set to the text of the row
+    //
+    // @return
+    // False if the view doesn't have the row yet
+    bool (*row)(int row, std::string &text);
+
+    // Get the text shown after the name in the title bar, it is left empty
+    // for none. Not called while the inferior runs. May be NULL.
+    void (*status)(std::string &text);
+
+    // Called before the rows first through last are shown, so the view
+    // can fetch the rows it doesn't have yet. The rows the window has room
+    // for are passed, last may be past the end of the view. Not called
+    // while the inferior runs. May be NULL.
+    void (*fetch)(int first, int last);
+
+    // The user picked a row with enter. May be NULL.
+    void (*select)(int row);
+};
+
+struct infowin;
+
+// Tell the views whether the inferior runs, they can't read from it then
+//
+// @param running
+// True if the inferior runs, false if it stopped or exited
+void infowin_set_running(bool running);
+
+// Get whether the inferior runs
+//
+// @return
+// True if it runs
+bool infowin_running(void);
+
+// Find the rows a view is to fetch next: the first row on screen it
+// doesn't have, or else the first one up to half a screen above or
+// below, along with the missing rows right after it
+//
+// @param first
+// @param last
+// The rows on screen, as passed to fetch
+//
+// @param count
+// The number of rows of the view
+//
+// @param missing
+// Tells if the view doesn't have a row
+//
+// @param low
+// @param high
+// Set to the first and the last row to fetch
+//
+// @return
+// False if no row is missing
+bool infowin_missing_rows(int first, int last, int count,
+        bool (*missing)(int row), int *low, int *high);
+
+// Creates a new info window
+//
+// @param win
+// The curses window to draw in, may be NULL
+//
+// @return
+// A pointer to a new info window
+struct infowin *infowin_new(SWINDOW *win);
+
+// Releases the memory allocated by an info window
+//
+// @param iw
+// The info window to operate on
+void infowin_free(struct infowin *iw);
+
+// Moves the info window to a new curses window, deleting the old one
+//
+// @param iw
+// The info window to operate on
+//
+// @param win
+// The curses window to draw in, may be NULL
+void infowin_move(struct infowin *iw, SWINDOW *win);
+
+// Set the view shown in the info window, selecting its first row
+//
+// @param iw
+// The info window to operate on
+//
+// @param view
+// The view to show, or NULL for none
+void infowin_set_view(struct infowin *iw, struct infowin_view *view);
+
+// Get the view shown in the info window
+//
+// @param iw
+// The info window to operate on
+//
+// @return
+// The view shown, or NULL if none
+struct infowin_view *infowin_get_view(struct infowin *iw);
+
+// Handle a key pressed while the info window has the focus
+//
+// @param iw
+// The info window to operate on
+//
+// @param key
+// The key pressed
+//
+// @param last_key
+// The key pressed before, for gg
+void infowin_input(struct infowin *iw, int key, int last_key);
+
+// Draws the info window
+//
+// @param iw
+// The info window to operate on
+//
+// @param focus
+// True if the info window has the focus
+//
+// @param dorefresh
+// WIN_REFRESH to call wrefresh, otherwise wnoutrefresh is called
+void infowin_display(struct infowin *iw, int focus,
+        enum win_refresh dorefresh);
+
+#endif
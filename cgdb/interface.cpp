@@ -6,10 +6,14 @@
  *      ---------------
  *       source window
  *      ---------------
+ *       info window
+ *      ---------------
  *       status window
  *      ---------------
  *       gdb window
  *      ---------------
+ * The info window is only there while it shows a view, like the stack.
+ * It takes the bottom half of the space the source window would have.
  * In this mode, the winminheight determines how much a window can
  * shrink vertically. The window_shfit variable keeps track of how far
  * the source window has been shifted up or down.
@@ -87,7 +91,9 @@
 #include "highlight.h"
 #include "highlight_groups.h"
 #include "fs_util.h"
+#include "event_loop.h"
 #include "logo.h"
+#include "infowin.h"
 
 /* ----------- */
 /* Prototypes  */
@@ -128,6 +134,8 @@ static struct scroller *gdb_scroller = NULL;
 static struct sviewer *src_viewer = NULL;  /* The source viewer window */
 static SWINDOW *status_win = NULL;   /* The status line */
 static SWINDOW *vseparator_win = NULL;   /* Separator gets own window */
+static struct infowin *info_win = NULL;  /* The info window */
+static struct infowin_view *info_view = NULL; /* The view it shows, or NULL */
 static enum Focus focus = GDB;  /* Which pane is currently focused */
 static struct winsize screen_size;  /* Screen size */
 
@@ -205,6 +213,18 @@ enum StatusBarCommandKind {
 
 static enum StatusBarCommandKind sbc_kind = SBC_NORMAL;
 
+/* The panes that changed since if_draw last repainted them */
+static int dirty_panes = IF_PANE_ALL;
+
+/* The number of times if_draw repainted or skipped each pane,
+ * indexed by the pane's bit in enum if_pane. */
+#define IF_PANE_COUNT 5
+static const char *pane_names[IF_PANE_COUNT] = {
+    "status", "source", "separator", "gdb", "info"
+};
+static unsigned long panes_drawn[IF_PANE_COUNT];
+static unsigned long panes_skipped[IF_PANE_COUNT];
+
 /* --------------- */
 /* Local Functions */
 /* --------------- */
@@ -229,7 +249,8 @@ static int get_src_status_height(void)
     return 1;
 }
 
-static int get_src_height(void)
+/* The height of the source window and the info window together */
+static int get_src_area_height(void)
 {
     int result;
 
@@ -245,6 +266,17 @@ static int get_src_height(void)
     return result;
 }
 
+/* The info window takes the bottom half of the source window */
+static int get_info_height(void)
+{
+    return info_view ? get_src_area_height() / 2 : 0;
+}
+
+static int get_src_height(void)
+{
+    return get_src_area_height() - get_info_height();
+}
+
 static int get_src_width(void)
 {
     int result;
@@ -261,10 +293,26 @@ static int get_src_width(void)
     return result;
 }
 
+/* This is for the info window */
+static int get_info_row(void)
+{
+    return get_src_row() + get_src_height();
+}
+
+static int get_info_col(void)
+{
+    return get_src_col();
+}
+
+static int get_info_width(void)
+{
+    return get_src_width();
+}
+
 /* This is for the source window status bar */
 static int get_src_status_row(void)
 {
-    return get_src_row() + get_src_height();
+    return get_src_row() + get_src_area_height();
 }
 
 static int get_src_status_col(void)
@@ -371,6 +419,51 @@ int get_gdb_width(void)
     return result;
 }
 
+/* The file dialog finished checking some files */
+static int if_filedlg_verified(void *context, int verify_fd)
+{
+    (void)context;
+    (void)verify_fd;
+
+    if (filedlg_process_verified(fd) && focus == FILE_DLG)
+        filedlg_display(fd);
+
+    return 0;
+}
+
+/* Waits on the file dialog's checks while it is open, and stops once it
+ * is closed. */
+static void if_filedlg_watch(int open)
+{
+    static int watching;
+    int verify_fd;
+
+    if (open == watching)
+        return;
+
+    verify_fd = filedlg_get_verify_fd(fd);
+    if (verify_fd == -1)
+        return;
+
+    if (open)
+        event_loop_add_fd(cgdb_loop, verify_fd, if_filedlg_verified, NULL);
+    else
+        event_loop_remove_fd(cgdb_loop, verify_fd);
+
+    watching = open;
+}
+
+/* A source file changed on disk, it is reloaded on the next stop */
+static int if_source_changed(void *context, int watch_fd)
+{
+    (void)context;
+    (void)watch_fd;
+
+    source_watch_process(src_viewer);
+
+    return 0;
+}
+
 /*
  * create_swindow: (re)create window with specified position and size.
  */
@@ -425,6 +518,9 @@ static void separator_display(int draw)
  * Below is the core body of the interface
  * --------------------------------------- */
 
+static void display_message(enum win_refresh dorefresh,
+        const char *header, const char *msg);
+
 /* Updates the status bar */
 static void update_status_win(enum win_refresh dorefresh)
 {
@@ -448,17 +544,17 @@ static void update_status_win(enum win_refresh dorefresh)
 
     /* Print the regex that the user is looking for Forward */
     if (sbc_kind == SBC_REGEX && regex_direction_cur) {
-        if_display_message(dorefresh, "/", regex_cur.c_str());
+        display_message(dorefresh, "/", regex_cur.c_str());
         swin_curs_set(1);
     }
     /* Regex backwards */
     else if (sbc_kind == SBC_REGEX) {
-        if_display_message(dorefresh, "?", regex_cur.c_str());
+        display_message(dorefresh, "?", regex_cur.c_str());
         swin_curs_set(1);
     }
     /* A colon command typed at the status bar */
     else if (focus == CGDB_STATUS_BAR && sbc_kind == SBC_NORMAL) {
-        if_display_message(dorefresh, ":", cur_sbc.c_str());
+        display_message(dorefresh, ":", cur_sbc.c_str());
         swin_curs_set(1);
     }
     /* Default: Current Filename */
@@ -467,7 +563,7 @@ static void update_status_win(enum win_refresh dorefresh)
         const char *filename = source_current_file(src_viewer);
 
         if (filename) {
-            if_display_message(dorefresh, "", filename);
+            display_message(dorefresh, "", filename);
         }
     }
 
@@ -477,7 +573,8 @@ static void update_status_win(enum win_refresh dorefresh)
         swin_wnoutrefresh(status_win);
 }
 
-void if_display_message(enum win_refresh dorefresh,
+/* Shows a message in the status bar */
+static void display_message(enum win_refresh dorefresh,
         const char *header, const char *msg)
 {
     char buf_display[MAXLINE];
@@ -516,29 +613,67 @@ void if_display_message(enum win_refresh dorefresh,
         swin_wnoutrefresh(status_win);
 }
 
+void if_display_message(enum win_refresh dorefresh,
+        const char *header, const char *msg)
+{
+    display_message(dorefresh, header, msg);
+
+    /* The next draw replaces the message with the status */
+    dirty_panes |= IF_PANE_STATUS;
+}
+
+void if_invalidate(int panes)
+{
+    dirty_panes |= panes;
+}
+
 /* if_draw: Draws the interface on the screen.
  * --------
  */
 void if_draw(void)
 {
+    int drawn = 0;
+    int i;
+
     /* Only redisplay the filedlg if it is up */
     if (focus == FILE_DLG) {
         filedlg_display(fd);
         return;
     }
 
-    update_status_win(WIN_NO_REFRESH);
+    if (dirty_panes & IF_PANE_STATUS) {
+        update_status_win(WIN_NO_REFRESH);
 
-    if (get_src_height() != 0 && get_gdb_height() != 0)
-        swin_wnoutrefresh(status_win);
+        if (get_src_area_height() != 0 && get_gdb_height() != 0)
+            swin_wnoutrefresh(status_win);
+        drawn |= IF_PANE_STATUS;
+    }
 
-    if (get_src_height() > 0)
+    if ((dirty_panes & IF_PANE_SOURCE) && get_src_height() > 0) {
         source_display(src_viewer, focus == CGDB, WIN_NO_REFRESH, no_hlsearch);
+        drawn |= IF_PANE_SOURCE;
+    }
+
+    if ((dirty_panes & IF_PANE_INFO) && get_info_height() > 0) {
+        infowin_display(info_win, focus == INFO_WIN, WIN_NO_REFRESH);
+        drawn |= IF_PANE_INFO;
+    }
 
-    separator_display(cur_split_orientation == WSO_VERTICAL);
+    if (dirty_panes & IF_PANE_SEPARATOR) {
+        separator_display(cur_split_orientation == WSO_VERTICAL);
+        drawn |= IF_PANE_SEPARATOR;
+    }
 
-    if (get_gdb_height() > 0)
+    if ((dirty_panes & IF_PANE_GDB) && get_gdb_height() > 0) {
         scr_refresh(gdb_scroller, focus == GDB, WIN_NO_REFRESH);
+        drawn |= IF_PANE_GDB;
+    } else if (drawn && get_gdb_height() > 0) {
+        /* The other panes moved the cursor, put it back in the gdb
+         * window or hide it, as drawing the gdb window would */
+        scr_show_cursor(gdb_scroller, focus == GDB, WIN_NO_REFRESH);
+    } else if (drawn && get_src_height() > 0 && !(drawn & IF_PANE_SOURCE)) {
+        swin_curs_set(focus == CGDB);
+    }
 
     /* This check is here so that the cursor goes to the 
      * cgdb window. The cursor would stay in the gdb window 
@@ -547,6 +682,15 @@ void if_draw(void)
         swin_wnoutrefresh(src_viewer->win);
 
     swin_doupdate();
+
+    dirty_panes = 0;
+
+    for (i = 0; i < IF_PANE_COUNT; i++) {
+        if (drawn & (1 << i))
+            panes_drawn[i]++;
+        else
+            panes_skipped[i]++;
+    }
 }
 
 /* validate_window_sizes:
@@ -589,6 +733,7 @@ int if_layout()
 {
     SWINDOW *gdb_scroller_win = NULL;
     SWINDOW *src_viewer_win = NULL;
+    SWINDOW *info_swin = NULL;
 
     /* Verify the window size is reasonable */
     validate_window_sizes();
@@ -600,8 +745,22 @@ int if_layout()
         source_move(src_viewer, src_viewer_win);
     } else {
         src_viewer = source_new(src_viewer_win);
+
+        if (source_watch_fd(src_viewer) != -1)
+            event_loop_add_fd(cgdb_loop, source_watch_fd(src_viewer),
+                    if_source_changed, NULL);
     }
 
+    /* Resize the info window, it has no curses window while hidden */
+    create_swindow(&info_swin, get_info_height(), get_info_width(),
+        get_info_row(), get_info_col());
+    if (info_win) {
+        infowin_move(info_win, info_swin);
+    } else {
+        info_win = infowin_new(info_swin);
+    }
+    infowin_set_view(info_win, info_view);
+
     tgdb_resize_console(tgdb, get_gdb_height(), get_gdb_width());
 
     /* Resize the GDB I/O window */
@@ -618,6 +777,7 @@ int if_layout()
         get_src_status_width(), get_src_status_row(), get_src_status_col());
 
     /* Redraw the interface */
+    if_invalidate(IF_PANE_ALL);
     if_draw();
 
     return 0;
@@ -767,6 +927,7 @@ static void if_run_command(struct sviewer *sview, const std::string &command)
 {
     /* refresh and return if the user entered no data */
     if (command.size() == 0) {
+        if_invalidate(IF_PANE_ALL);
         if_draw();
         return;
     }
@@ -778,6 +939,9 @@ static void if_run_command(struct sviewer *sview, const std::string &command)
         update_status_win(WIN_NO_REFRESH);
     }
 
+    /* The command may have changed anything */
+    source_redraw(src_viewer);
+    if_invalidate(IF_PANE_ALL);
     if_draw();
 }
 
@@ -806,6 +970,7 @@ static int gdb_input_regex_input(struct scroller *scr, int key)
         /* Save for future searches via 'n' or 'N' */
         regex_direction_last = regex_direction_cur;
         matched = scr_search_regex(scr, regex_cur.c_str());
+        if_invalidate(IF_PANE_GDB);
         if_draw();
         done = 1;
         break;
@@ -821,6 +986,7 @@ static int gdb_input_regex_input(struct scroller *scr, int key)
         {
             regex_cur.erase(regex_cur.size() - 1);
             matched = scr_search_regex(scr, regex_cur.c_str());
+            if_invalidate(IF_PANE_GDB);
             if_draw();
             update_status_win(WIN_REFRESH);
         }
@@ -839,6 +1005,7 @@ static int gdb_input_regex_input(struct scroller *scr, int key)
             regex_cur.push_back(key);
         }
         matched = scr_search_regex(scr, regex_cur.c_str());
+        if_invalidate(IF_PANE_GDB);
         if_draw();
         update_status_win(WIN_REFRESH);
     };
@@ -867,6 +1034,7 @@ static int gdb_input_regex_input(struct scroller *scr, int key)
 static int gdb_input(int key, int *last_key)
 {
     int result = 0;
+    int panes = IF_PANE_GDB;
 
     if (scr_search_mode(gdb_scroller))
         return gdb_input_regex_input(gdb_scroller, key);
@@ -950,6 +1118,7 @@ static int gdb_input(int key, int *last_key)
                 sbc_kind = SBC_REGEX;
                 scr_enable_search(gdb_scroller, regex_direction_cur,
                     cgdbrc_get_int(CGDBRC_IGNORECASE));
+                panes |= IF_PANE_STATUS;
                 break;
         }
 
@@ -981,6 +1150,7 @@ static int gdb_input(int key, int *last_key)
         }
     }
 
+    if_invalidate(panes);
     if_draw();
 
     return result;
@@ -1019,6 +1189,7 @@ static int status_bar_regex_input(struct sviewer *sview, int key)
             regex_direction_last = regex_direction_cur;
             source_search_regex(sview, regex_last.c_str(), 2,
                     regex_direction_last, regex_icase);
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
 
             done = 1;
@@ -1039,6 +1210,7 @@ static int status_bar_regex_input(struct sviewer *sview, int key)
                 regex_cur.erase(regex_cur.size() - 1);
                 source_search_regex(sview, regex_cur.c_str(), 1,
                         regex_direction_cur, regex_icase);
+                if_invalidate(IF_PANE_SOURCE);
                 if_draw();
                 update_status_win(WIN_REFRESH);
             }
@@ -1055,6 +1227,7 @@ static int status_bar_regex_input(struct sviewer *sview, int key)
             }
             source_search_regex(sview, regex_cur.c_str(), 1,
                     regex_direction_cur, regex_icase);
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
             update_status_win(WIN_REFRESH);
     };
@@ -1110,7 +1283,10 @@ static int status_bar_normal_input(int key)
 
     if (done) {
         cur_sbc.clear();
-        if_set_focus(CGDB);
+
+        /* Unless the command moved the focus, like :stack */
+        if (focus == CGDB_STATUS_BAR)
+            if_set_focus(CGDB);
     }
 
     return 0;
@@ -1182,7 +1358,8 @@ toggle_breakpoint(struct sviewer *sview, enum tgdb_breakpoint_action t)
         return -1;
 
     /* delete an existing breakpoint */
-    if (sview->cur->lflags[line].breakpt != line_flags::breakpt_status::none)
+    if (source_get_breakpoint(sview->cur, sview->cur->sel_line) !=
+            line_flags::breakpt_status::none)
         t = TGDB_BREAKPOINT_DELETE;
 
     tgdb_request_modify_breakpoint(tgdb, path, line, addr, t);
@@ -1303,6 +1480,7 @@ static void source_input(struct sviewer *sview, int key)
     }
 
     /* Some extended features that are set by :set sc */
+    if_invalidate(IF_PANE_SOURCE);
     if_draw();
 }
 
@@ -1410,6 +1588,9 @@ static int cgdb_input(int key, int *last_key)
              * an individual g.
              */
             *last_key = 0;
+
+            /* A global mark may be in another file */
+            if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
             if_draw();
             return 0;
         }
@@ -1455,17 +1636,20 @@ static int cgdb_input(int key, int *last_key)
                 source_search_regex_init(src_viewer);
 
                 /* Initialize the function for finding a regex and tell user */
+                if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
                 if_draw();
             }
             return 0;
         case 'n':
             source_search_regex(src_viewer, regex_last.c_str(), 2,
                                 regex_direction_last, regex_icase);
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
             break;
         case 'N':
             source_search_regex(src_viewer, regex_last.c_str(), 2,
                                 !regex_direction_last, regex_icase);
+            if_invalidate(IF_PANE_SOURCE);
             if_draw();
             break;
         case CGDB_KEY_CTRL_W:
@@ -1513,6 +1697,38 @@ static int cgdb_input(int key, int *last_key)
     return 0;
 }
 
+/**
+ * Send input to the info window.
+ *
+ * @param key
+ * The key to send to the info window.
+ *
+ * @return
+ * Currently only returns 0.
+ */
+static int info_input(int key)
+{
+    switch (key) {
+        case 'q':
+            if_hide_info();
+            return 0;
+        case 'i':
+            if_set_focus(GDB);
+            return 0;
+        case ':':
+            sbc_kind = SBC_NORMAL;
+            if_set_focus(CGDB_STATUS_BAR);
+            cur_sbc.clear();
+            return 0;
+    }
+
+    infowin_input(info_win, key, last_key_pressed);
+
+    if_invalidate(IF_PANE_INFO);
+    if_draw();
+    return 0;
+}
+
 int internal_if_input(int key, int *last_key)
 {
     /* Normally, CGDB_KEY_ESC, but can be configured by the user */
@@ -1585,6 +1801,8 @@ int internal_if_input(int key, int *last_key)
             return 0;
         case CGDB_STATUS_BAR:
             return status_bar_input(src_viewer, key);
+        case INFO_WIN:
+            return info_input(key);
     }
 
     /* Never gets here */
@@ -1600,18 +1818,19 @@ int if_input(int key)
     return result;
 }
 
-static void if_print_internal(const char *buf)
+static void if_print_internal(const char *buf, size_t length)
 {
     if (!gdb_scroller) {
-        clog_error(CLOG_CGDB, "%s", buf);
+        clog_error(CLOG_CGDB, "%.*s", (int)length, buf);
         return;
     }
 
     /* Print it to the scroller */
-    scr_add(gdb_scroller, buf);
+    scr_add(gdb_scroller, buf, length);
 
     if (get_gdb_height() > 0) {
         scr_refresh(gdb_scroller, focus == GDB, WIN_NO_REFRESH);
+        dirty_panes &= ~IF_PANE_GDB;
 
         /* Make sure cursor reappears in source window if focus is there */
         if (focus == CGDB)
@@ -1622,9 +1841,9 @@ static void if_print_internal(const char *buf)
 
 }
 
-void if_print(const char *buf)
+void if_print(const char *buf, size_t length)
 {
-    if_print_internal(buf);
+    if_print_internal(buf, length);
 }
 
 void if_sdc_print(const char *buf)
@@ -1646,13 +1865,74 @@ void if_print_message(const char *fmt, ...)
 #endif
     va_end(ap);
 
-    if_print(va_buf);
+    if_print(va_buf, strlen(va_buf));
 }
 
-void if_show_file(char *path, int sel_line, int exe_line)
+void if_show_file(const char *path, int sel_line, int exe_line)
 {
-    if (source_set_exec_line(src_viewer, path, sel_line, exe_line) == 0)
+    if (source_set_exec_line(src_viewer, path, sel_line, exe_line) == 0) {
+        if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
         if_draw();
+    }
+}
+
+void if_show_info(struct infowin_view *view)
+{
+    if (info_view != view) {
+        bool layout = !info_view;
+
+        info_view = view;
+        if (info_win)
+            infowin_set_view(info_win, view);
+
+        /* Make room for the info window */
+        if (layout)
+            if_layout();
+    }
+
+    if_set_focus(INFO_WIN);
+}
+
+void if_hide_info(void)
+{
+    if (!info_view)
+        return;
+
+    info_view = NULL;
+    if (info_win)
+        infowin_set_view(info_win, NULL);
+
+    if (focus == INFO_WIN)
+        focus = CGDB;
+
+    /* Give the room back to the source window */
+    if_layout();
+}
+
+/* The idle callback painting the info window, or 0 if none */
+static int info_idle_id;
+
+static int if_info_idle(void *context)
+{
+    (void)context;
+
+    event_loop_remove_idle(cgdb_loop, info_idle_id);
+    info_idle_id = 0;
+
+    if_draw();
+    return 0;
+}
+
+void if_info_changed(struct infowin_view *view)
+{
+    if (view && view == info_view) {
+        if_invalidate(IF_PANE_INFO);
+
+        /* Responses come in bursts, like a thread for each thread
+         * created, paint once they have all been handled */
+        if (!info_idle_id)
+            info_idle_id = event_loop_add_idle(cgdb_loop, if_info_idle, NULL);
+    }
 }
 
 void if_display_help(void)
@@ -1673,6 +1953,7 @@ void if_display_help(void)
     {
         src_viewer->cur->language = TOKENIZER_LANGUAGE_CGDBHELP;
         source_highlight(src_viewer->cur);
+        if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
         if_draw();
     }
     else if (ret_val == 5)      /* File does not exist */
@@ -1686,6 +1967,7 @@ void if_display_logo(int reset)
         logo_reset();
 
     src_viewer->cur = NULL;
+    if_invalidate(IF_PANE_SOURCE | IF_PANE_STATUS);
 }
 
 struct sviewer *if_get_sview()
@@ -1710,6 +1992,13 @@ void if_filedlg_display_message(char *message)
 
 void if_shutdown(void)
 {
+    int i;
+
+    for (i = 0; i < IF_PANE_COUNT; i++) {
+        clog_info(CLOG_CGDB, "Drew the %s pane %lu times, skipped it %lu times",
+                pane_names[i], panes_drawn[i], panes_skipped[i]);
+    }
+
     if (status_win) {
         swin_delwin(status_win);
         status_win = NULL;
@@ -1720,7 +2009,12 @@ void if_shutdown(void)
         gdb_scroller = NULL;
     }
 
+    if_filedlg_watch(0);
+
     if (src_viewer) {
+        if (source_watch_fd(src_viewer) != -1)
+            event_loop_remove_fd(cgdb_loop, source_watch_fd(src_viewer));
+
         source_free(src_viewer);
         src_viewer = NULL;
     }
@@ -1729,29 +2023,54 @@ void if_shutdown(void)
         swin_delwin(vseparator_win);
         vseparator_win = NULL;
     }
+
+    if (info_win) {
+        infowin_free(info_win);
+        info_win = NULL;
+        info_view = NULL;
+    }
 }
 
 void if_set_focus(Focus f)
 {
+    /* The file dialog draws over the source window */
+    if (src_viewer)
+        source_redraw(src_viewer);
+
     switch (f) {
         case GDB:
             focus = f;
+            if_invalidate(IF_PANE_ALL);
             if_draw();
             break;
         case CGDB:
             focus = f;
+            if_invalidate(IF_PANE_ALL);
             if_draw();
             break;
         case FILE_DLG:
             focus = f;
+            if_invalidate(IF_PANE_ALL);
             if_draw();
             break;
+        case INFO_WIN:
+            /* Only while the info window is shown */
+            if (info_view && get_info_height() > 0) {
+                focus = f;
+                if_invalidate(IF_PANE_ALL);
+                if_draw();
+            }
+            break;
         case CGDB_STATUS_BAR:
             focus = f;
+            if_invalidate(IF_PANE_ALL);
             if_draw();
+            break;
         default:
             return;
     }
+
+    if_filedlg_watch(focus == FILE_DLG);
 }
 
 Focus if_get_focus(void)
@@ -1788,6 +2107,7 @@ void if_highlight_sviewer(enum tokenizer_language_support l)
 
         src_viewer->cur->language = l;
         source_highlight(src_viewer->cur);
+        if_invalidate(IF_PANE_SOURCE);
         if_draw();
     }
 }
@@ -1826,7 +2146,7 @@ int if_clear_line()
     line.append(get_gdb_width(), ' ');
     line.push_back('\r');
 
-    if_print(line.c_str());
+    if_print(line.data(), line.size());
 
     return 0;
 }
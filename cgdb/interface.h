@@ -11,6 +11,7 @@
 /* Local Includes */
 #include "sources.h"
 #include "cgdbrc.h"
+#include "infowin.h"
 
 /* --------- */
 /* Functions */
@@ -46,9 +47,10 @@ int if_input(int key);
 /* if_print: Prints data to the GDB input/output window.
  * ---------
  *
- *   buf:  NULL-terminated buffer to display.
+ *   buf:    buffer to display, it does not need to be NULL-terminated.
+ *   length: the number of bytes in buf.
  */
-void if_print(const char *buf);
+void if_print(const char *buf, size_t length);
 
 /* if_print_message: Prints data to the GDB input/output window.
  * -----------------
@@ -72,7 +74,28 @@ void if_sdc_print(const char *command);
  *   sel_line:  Current line of the file being selected (0 to leave unchanged)
  *   exe_line:  Current line of the file being executed (0 to leave unchanged)
  */
-void if_show_file(char *path, int sel_line, int exe_line);
+void if_show_file(const char *path, int sel_line, int exe_line);
+
+/* if_show_info: Shows a view in the info window and focuses it.
+ * -------------
+ *
+ * The info window is opened below the source window if it isn't shown.
+ *
+ *   view:  The view to show, like the stack.
+ */
+void if_show_info(struct infowin_view *view);
+
+/* if_hide_info: Closes the info window, giving the room back to the source
+ * -------------  window.
+ */
+void if_hide_info(void);
+
+/* if_info_changed: Repaints the info window if it shows view, once the
+ * ----------------  main loop is idle.
+ *
+ *   view:  The view whose rows changed.
+ */
+void if_info_changed(struct infowin_view *view);
 
 /* if_get_sview: Return a pointer to the source viewer object.
  * -------------
@@ -138,8 +161,9 @@ void if_shutdown(void);
  *  CGDB: focus on source window, accepts command input.
  *  CGDB_STATUS_BAR: focus on the status bar, accepts commands.
  *  FILE_DLG: focus on file dialog window
+ *  INFO_WIN: focus on the info window
  */
-typedef enum Focus { GDB, CGDB, CGDB_STATUS_BAR, FILE_DLG } Focus;
+typedef enum Focus { GDB, CGDB, CGDB_STATUS_BAR, FILE_DLG, INFO_WIN } Focus;
 
 /* if_set_focus: Sets the current input focus to a different window 
  * ------------
@@ -171,7 +195,24 @@ void if_display_logo(int reset);
  */
 void if_search_next(void);
 
-/* if_draw:
+/* The panes of the interface, see if_invalidate */
+enum if_pane {
+    IF_PANE_STATUS = 1 << 0,    /* The status bar */
+    IF_PANE_SOURCE = 1 << 1,    /* The source viewer */
+    IF_PANE_SEPARATOR = 1 << 2, /* The vertical separator */
+    IF_PANE_GDB = 1 << 3,       /* The gdb window */
+    IF_PANE_INFO = 1 << 4,      /* The info window */
+    IF_PANE_ALL = IF_PANE_STATUS | IF_PANE_SOURCE | IF_PANE_SEPARATOR |
+            IF_PANE_GDB | IF_PANE_INFO
+};
+
+/* if_invalidate: Marks panes as changed, to be repainted by if_draw.
+ * --------------
+ *  panes: The panes that changed, a combination of if_pane values.
+ */
+void if_invalidate(int panes);
+
+/* if_draw: Repaints the panes that changed since they were last drawn.
  * -----------
  */
 void if_draw(void);
@@ -0,0 +1,423 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif /* HAVE_STDIO_H */
+
+#if HAVE_CTYPE_H
+#include <ctype.h>
+#endif /* HAVE_CTYPE_H */
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "tokenizer.h"
+#include "interface.h"
+#include "memview.h"
+
+extern struct tgdb *tgdb;
+
+/* The bytes shown in a row */
+#define MEMVIEW_ROW_BYTES 16
+
+/* The bytes read at once, at an address that is a multiple of it */
+#define MEMVIEW_PAGE_SIZE 1024
+
+/* The pages kept, the least recently shown are dropped first */
+#define MEMVIEW_CACHE_PAGES 64
+
+/* The pages read ahead in the direction the user scrolls */
+#define MEMVIEW_READ_AHEAD 4
+
+/* The rows shown from the address, 1 MiB */
+#define MEMVIEW_ROWS 65536
+
+#define MEMVIEW_PAGE(addr) ((addr) & ~(uint64_t)(MEMVIEW_PAGE_SIZE - 1))
+
+struct memview_page {
+    bool loaded;                        /* False while on its way */
+    int read;                           /* The read that gets it */
+    unsigned char bytes[MEMVIEW_PAGE_SIZE];
+    bool readable[MEMVIEW_PAGE_SIZE];   /* False if gdb couldn't read it */
+    std::list<uint64_t>::iterator lru;  /* Its place in lru if loaded */
+};
+
+struct memview_read {
+    int id;             /* Pages on their way are read by this id */
+    uint64_t addr;      /* The first page, unless finding the address */
+    int pages;          /* The number of pages, 0 to find the address */
+    std::string address;    /* The address as gdb was asked for it */
+    int count;              /* The number of bytes asked for */
+};
+
+/* The pages that are loaded or on their way, by address */
+static std::map<uint64_t, memview_page> pages;
+
+/* The loaded pages, the most recently shown first */
+static std::list<uint64_t> lru;
+
+/* The reads on their way, a reply is matched by what it asked for */
+static std::list<memview_read> reads;
+static int last_read;
+
+/* The read finding the address of the last :memory */
+static int locate_read;
+
+/* The expression for the address, as the user typed it */
+static std::string expression;
+
+/* The address of the first row, valid if located */
+static uint64_t start;
+static bool located;
+
+/* Why the address couldn't be found, or empty */
+static std::string error;
+
+/* The first row shown the last time, to tell which way the user scrolls */
+static int last_first;
+static int direction = 1;
+
+static int memview_count(void);
+static bool memview_row(int row, std::string &text);
+static void memview_status(std::string &text);
+static void memview_fetch(int first, int last);
+
+static struct infowin_view memview = {
+    "Memory",
+    memview_count,
+    memview_row,
+    memview_status,
+    memview_fetch,
+    NULL
+};
+
+struct infowin_view *memview_get(void)
+{
+    return &memview;
+}
+
+/* Forget the pages, the memory may have changed */
+static void memview_invalidate(void)
+{
+    pages.clear();
+    lru.clear();
+}
+
+/* Ask gdb for count bytes at address */
+static void memview_send_read(memview_read &read, const char *address,
+        int count)
+{
+    read.address = address;
+    read.count = count;
+    reads.push_back(read);
+    tgdb_request_read_memory(tgdb, address, count);
+}
+
+void memview_set_address(const char *address)
+{
+    memview_read read;
+
+    memview_invalidate();
+    expression = address;
+    located = false;
+    error.clear();
+    last_first = 0;
+    direction = 1;
+
+    /* Read a byte there, gdb says where it was */
+    read.id = locate_read = ++last_read;
+    read.addr = 0;
+    read.pages = 0;
+    memview_send_read(read, address, 1);
+
+    if_info_changed(&memview);
+}
+
+static int memview_count(void)
+{
+    uint64_t rows;
+
+    if (!located)
+        return 0;
+
+    /* Don't go past the end of the address space */
+    rows = (UINT64_MAX - start) / MEMVIEW_ROW_BYTES + 1;
+    return (int)std::min(rows, (uint64_t)MEMVIEW_ROWS);
+}
+
+static bool memview_row(int row, std::string &text)
+{
+    uint64_t addr = start + (uint64_t)row * MEMVIEW_ROW_BYTES;
+    std::map<uint64_t, memview_page>::iterator it;
+    memview_page *page;
+    char buf[32];
+    int offset, i;
+
+    it = pages.find(MEMVIEW_PAGE(addr));
+    if (it == pages.end() || !it->second.loaded)
+        return false;
+
+    page = &it->second;
+    offset = addr - it->first;
+
+    /* The page was just shown */
+    lru.splice(lru.begin(), lru, page->lru);
+
+    snprintf(buf, sizeof(buf), "%016" PRIx64 ": ", addr);
+    text = buf;
+
+    for (i = 0; i < MEMVIEW_ROW_BYTES; i++) {
+        if (page->readable[offset + i]) {
+            snprintf(buf, sizeof(buf), "%02x ", page->bytes[offset + i]);
+            text.append(buf);
+        } else {
+            text.append("?? ");
+        }
+        if (i == MEMVIEW_ROW_BYTES / 2 - 1)
+            text.push_back(' ');
+    }
+
+    text.append(" |");
+    for (i = 0; i < MEMVIEW_ROW_BYTES; i++) {
+        unsigned char c = page->bytes[offset + i];
+
+        text.push_back(page->readable[offset + i] && isprint(c) ? c : '.');
+    }
+    text.push_back('|');
+
+    return true;
+}
+
+static void memview_status(std::string &text)
+{
+    char buf[32];
+
+    if (!error.empty()) {
+        text = error;
+    } else if (expression.empty()) {
+        text = "use :memory <address>";
+    } else if (!located) {
+        text = "finding the address";
+    } else {
+        snprintf(buf, sizeof(buf), "0x%" PRIx64, start);
+        text = buf;
+        text.append(" (");
+        text.append(expression);
+        text.append(")");
+    }
+}
+
+/* Read count pages starting at the page at addr */
+static void memview_read_pages(uint64_t addr, int count)
+{
+    memview_read read;
+    char address[32];
+    int i;
+
+    read.id = ++last_read;
+    read.addr = addr;
+    read.pages = count;
+
+    for (i = 0; i < count; i++) {
+        memview_page &page = pages[addr + (uint64_t)i * MEMVIEW_PAGE_SIZE];
+
+        page.loaded = false;
+        page.read = read.id;
+    }
+
+    snprintf(address, sizeof(address), "0x%" PRIx64, addr);
+    memview_send_read(read, address, count * MEMVIEW_PAGE_SIZE);
+}
+
+/* Read the pages from first through last that aren't loaded or on their
+ * way, each run of them with one read */
+static void memview_read_range(uint64_t first, uint64_t last)
+{
+    uint64_t addr = first, run = 0;
+    int count = 0;
+
+    for (;;) {
+        bool missing = addr <= last && pages.find(addr) == pages.end();
+
+        if (missing) {
+            if (count == 0)
+                run = addr;
+            count++;
+        } else if (count > 0) {
+            memview_read_pages(run, count);
+            count = 0;
+        }
+
+        /* Stop at the end of the address space too */
+        if (addr >= last || addr + MEMVIEW_PAGE_SIZE < addr) {
+            if (count > 0)
+                memview_read_pages(run, count);
+            break;
+        }
+        addr += MEMVIEW_PAGE_SIZE;
+    }
+}
+
+static void memview_fetch(int first, int last)
+{
+    int count = memview_count();
+    uint64_t first_page, last_page, end_page;
+    uint64_t ahead = (uint64_t)MEMVIEW_READ_AHEAD * MEMVIEW_PAGE_SIZE;
+
+    if (!located || count == 0)
+        return;
+
+    last = std::min(last, count - 1);
+    if (first > last)
+        return;
+
+    if (first > last_first)
+        direction = 1;
+    else if (first < last_first)
+        direction = -1;
+    last_first = first;
+
+    first_page = MEMVIEW_PAGE(start + (uint64_t)first * MEMVIEW_ROW_BYTES);
+    last_page = MEMVIEW_PAGE(start + (uint64_t)last * MEMVIEW_ROW_BYTES);
+
+    /* The pages on screen, in one read if none are loaded */
+    memview_read_range(first_page, last_page);
+
+    /* And the ones the user is scrolling to, before they get there */
+    if (direction > 0) {
+        end_page = MEMVIEW_PAGE(start +
+                (uint64_t)(count - 1) * MEMVIEW_ROW_BYTES);
+        if (last_page < end_page)
+            memview_read_range(last_page + MEMVIEW_PAGE_SIZE,
+                    std::min(end_page, last_page + ahead));
+    } else {
+        end_page = MEMVIEW_PAGE(start);
+        if (first_page > end_page)
+            memview_read_range(std::max(end_page,
+                        first_page - std::min(first_page, ahead)),
+                    first_page - MEMVIEW_PAGE_SIZE);
+    }
+}
+
+void memview_update_memory(struct tgdb_response *response)
+{
+    struct tgdb_memory_block *blocks = response->choice.update_memory.blocks;
+    std::list<memview_read>::iterator match = reads.begin();
+    memview_read read;
+    int i, j;
+
+    /* The first read that asked for this */
+    while (match != reads.end() &&
+            (match->address != response->choice.update_memory.address ||
+             match->count != response->choice.update_memory.count))
+        ++match;
+    if (match == reads.end())
+        return;
+
+    read = *match;
+    reads.erase(match);
+
+    /* Finding the address, the read of the last :memory counts */
+    if (read.pages == 0) {
+        if (read.id != locate_read)
+            return;
+
+        if (sbcount(blocks) > 0) {
+            start = blocks[0].addr & ~(uint64_t)(MEMVIEW_ROW_BYTES - 1);
+            located = true;
+        } else {
+            error = "can't read " + expression;
+        }
+
+        if_info_changed(&memview);
+        return;
+    }
+
+    for (i = 0; i < read.pages; i++) {
+        uint64_t addr = read.addr + (uint64_t)i * MEMVIEW_PAGE_SIZE;
+        std::map<uint64_t, memview_page>::iterator it = pages.find(addr);
+        memview_page *page;
+
+        /* The page was dropped while it was on its way */
+        if (it == pages.end() || it->second.loaded ||
+                it->second.read != read.id)
+            continue;
+
+        page = &it->second;
+        std::fill(page->bytes, page->bytes + MEMVIEW_PAGE_SIZE, 0);
+        std::fill(page->readable, page->readable + MEMVIEW_PAGE_SIZE, false);
+
+        for (j = 0; j < sbcount(blocks); j++) {
+            struct tgdb_memory_block *block = &blocks[j];
+            uint64_t from = std::max(block->addr, addr);
+            uint64_t to = std::min(block->addr + sbcount(block->bytes),
+                    addr + MEMVIEW_PAGE_SIZE);
+
+            for (; from < to; from++) {
+                page->bytes[from - addr] = block->bytes[from - block->addr];
+                page->readable[from - addr] = true;
+            }
+        }
+
+        page->loaded = true;
+        lru.push_front(addr);
+        page->lru = lru.begin();
+    }
+
+    /* Drop the pages shown the longest time ago */
+    while (lru.size() > MEMVIEW_CACHE_PAGES) {
+        pages.erase(lru.back());
+        lru.pop_back();
+    }
+
+    if_info_changed(&memview);
+}
+
+void memview_memory_changed(struct tgdb_response *response)
+{
+    uint64_t addr = response->choice.memory_changed.addr;
+    uint64_t len = response->choice.memory_changed.len;
+    uint64_t end = addr + len < addr ? UINT64_MAX : addr + len;
+    std::map<uint64_t, memview_page>::iterator it;
+    bool changed = false;
+
+    /* Drop the pages holding the bytes that changed */
+    it = pages.lower_bound(MEMVIEW_PAGE(addr));
+    while (it != pages.end() && it->first < end) {
+        if (it->second.loaded)
+            lru.erase(it->second.lru);
+        pages.erase(it++);
+        changed = true;
+    }
+
+    if (changed)
+        if_info_changed(&memview);
+}
+
+void memview_inferior_changed(struct tgdb_response *response)
+{
+    switch (response->header) {
+        case TGDB_INFERIOR_RUNNING:
+        case TGDB_INFERIOR_EXITED:
+            memview_invalidate();
+            break;
+        case TGDB_INFERIOR_STOPPED:
+            /* The pages were dropped when it ran, and selecting another
+             * frame or thread changes no memory */
+            break;
+        default:
+            return;
+    }
+
+    if_info_changed(&memview);
+}
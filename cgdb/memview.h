@@ -0,0 +1,46 @@
+// The memory view of the info window
+//
+// The view shows the memory of the inferior in hex and ASCII. It reads the
+// memory in aligned pages as they scroll into view, and reads ahead in the
+// direction the user scrolls. The pages are kept until the inferior runs,
+// or the user changes the memory they hold from the gdb console.
+
+#ifndef _MEMVIEW_H_
+#define _MEMVIEW_H_
+
+#include "infowin.h"
+#include "tgdb.h"
+
+// Get the memory view, to show in the info window
+//
+// @return
+// The memory view
+struct infowin_view *memview_get(void);
+
+// Show the memory at an address
+//
+// @param expression
+// An expression for the address, like 0x601040 or &buf. It is evaluated
+// once, the view stays at the address it had.
+void memview_set_address(const char *expression);
+
+// Handle a TGDB_UPDATE_MEMORY response
+//
+// @param response
+// The response from tgdb
+void memview_update_memory(struct tgdb_response *response);
+
+// Handle a TGDB_MEMORY_CHANGED response
+//
+// @param response
+// The response from tgdb
+void memview_memory_changed(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, the memory may be out of date
+//
+// @param response
+// The response from tgdb
+void memview_inferior_changed(struct tgdb_response *response);
+
+#endif
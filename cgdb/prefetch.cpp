@@ -0,0 +1,161 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <deque>
+#include <set>
+#include <string>
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "event_loop.h"
+#include "sys_win.h"
+#include "cgdb.h"
+#include "cgdbrc.h"
+#include "tokenizer.h"
+#include "sources.h"
+#include "interface.h"
+#include "replies.h"
+#include "prefetch.h"
+
+extern struct tgdb *tgdb;
+
+/* How long the user has to be idle after a stop, in milliseconds */
+#define PREFETCH_DELAY 250
+
+/* The frames looked at, starting at frame 0 */
+#define PREFETCH_FRAMES 8
+
+/* The most files loaded after a stop */
+#define PREFETCH_FILES 4
+
+/* The timer waiting for the user to be idle, or 0 */
+static int delay_timer;
+
+/* The timer loading the next file, or 0 */
+static int load_timer;
+
+/* The files still to load, and how many more may be loaded */
+static std::deque<std::string> files;
+static int budget;
+
+/* The -stack-list-frames on their way */
+static struct replies frame_replies;
+
+/* The thread the files are for, and if the program ran since. Selecting
+ * a frame of that thread keeps the files, the callers are the same. */
+static int thread_id;
+static bool ran = true;
+
+static void prefetch_cancel(void)
+{
+    if (delay_timer) {
+        event_loop_cancel_timer(cgdb_loop, delay_timer);
+        delay_timer = 0;
+    }
+
+    if (load_timer) {
+        event_loop_cancel_timer(cgdb_loop, load_timer);
+        load_timer = 0;
+    }
+
+    files.clear();
+
+    replies_drop(&frame_replies);
+}
+
+static int prefetch_delay(void *context)
+{
+    (void)context;
+
+    delay_timer = 0;
+
+    replies_expect(&frame_replies);
+    tgdb_request_frame_files(tgdb, PREFETCH_FRAMES);
+
+    return 0;
+}
+
+/* Load one file, then let the keys the user typed meanwhile in first */
+static int prefetch_load(void *context)
+{
+    (void)context;
+
+    load_timer = 0;
+
+    while (!files.empty() && budget > 0) {
+        std::string path = files.front();
+        files.pop_front();
+
+        /* Only files that had to be read count */
+        if (source_preload(if_get_sview(), path.c_str()) == 0) {
+            budget--;
+            break;
+        }
+    }
+
+    if (!files.empty() && budget > 0)
+        load_timer = event_loop_add_timer(cgdb_loop, 0, prefetch_load, NULL);
+
+    return 0;
+}
+
+void prefetch_update_frame_files(struct tgdb_response *response)
+{
+    char **paths = response->choice.update_frame_files.paths;
+    std::set<std::string> seen;
+    int i;
+
+    if (!replies_receive(&frame_replies))
+        return;
+
+    if (response->choice.update_frame_files.error)
+        return;
+
+    files.clear();
+    budget = PREFETCH_FILES;
+
+    /* The file of frame 0 is among them, it is shown so it is loaded
+     * already and source_preload doesn't count it against the budget */
+    for (i = 0; i < sbcount(paths); i++) {
+        if (seen.insert(paths[i]).second)
+            files.push_back(paths[i]);
+    }
+
+    if (!files.empty() && !load_timer)
+        load_timer = event_loop_add_timer(cgdb_loop, 0, prefetch_load, NULL);
+}
+
+void prefetch_inferior_changed(struct tgdb_response *response)
+{
+    if (response->header != TGDB_INFERIOR_STOPPED) {
+        prefetch_cancel();
+        ran = true;
+        return;
+    }
+
+    /* Only another frame was selected, like with up or down */
+    if (!ran && (response->choice.inferior_stopped.thread_id == 0 ||
+                response->choice.inferior_stopped.thread_id == thread_id))
+        return;
+
+    prefetch_cancel();
+    ran = false;
+    if (response->choice.inferior_stopped.thread_id)
+        thread_id = response->choice.inferior_stopped.thread_id;
+
+    if (!cgdbrc_get_int(CGDBRC_DISASM))
+        delay_timer = event_loop_add_timer(cgdb_loop, PREFETCH_DELAY,
+                prefetch_delay, NULL);
+}
+
+void prefetch_user_input(void)
+{
+    /* Only while waiting, the files already asked for still load
+     * between keys */
+    if (delay_timer) {
+        event_loop_cancel_timer(cgdb_loop, delay_timer);
+        delay_timer = event_loop_add_timer(cgdb_loop, PREFETCH_DELAY,
+                prefetch_delay, NULL);
+    }
+}
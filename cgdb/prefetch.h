@@ -0,0 +1,31 @@
+// Loading the source files of the callers before they are shown
+//
+// After a stop only the file of frame 0 is loaded. Once the user has been
+// idle for a moment, the files of the next frames are asked for and loaded
+// and highlighted one at a time, between keys, so going up the stack or
+// finishing doesn't wait for a big file to be read.
+
+#ifndef _PREFETCH_H_
+#define _PREFETCH_H_
+
+#include "tgdb.h"
+
+// Handle a TGDB_UPDATE_FRAME_FILES response
+//
+// @param response
+// The response from tgdb
+void prefetch_update_frame_files(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, a stop or another thread starts a new
+// prefetch
+//
+// @param response
+// The response from tgdb
+void prefetch_inferior_changed(struct tgdb_response *response);
+
+// Handle a key from the user, the wait for the user to be idle starts
+// over
+void prefetch_user_input(void);
+
+#endif
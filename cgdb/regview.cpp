@@ -0,0 +1,264 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif /* HAVE_STDIO_H */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "tokenizer.h"
+#include "interface.h"
+#include "replies.h"
+#include "regview.h"
+
+extern struct tgdb *tgdb;
+
+/* The width of the name column */
+#define REGVIEW_NAME_WIDTH 10
+
+/* The names of the registers, by number, and the numbers of the rows.
+ * gdb leaves holes in the numbers, those have no row. */
+static std::vector<std::string> names;
+static std::vector<int> rows;
+static bool have_names;
+static struct replies names_replies;
+
+/* The values that were read, by register number */
+static std::map<int, std::string> values;
+
+/* The registers that changed at the last stop, marked in the view */
+static std::set<int> changed;
+
+/* The registers whose value is on its way */
+static std::set<int> pending;
+
+/* The -data-list-register-values on their way */
+static struct replies values_replies;
+
+/* The view doesn't know which values changed since the last stop. The
+ * replies to -data-list-changed-registers are never skipped, gdb tells
+ * each change only once. */
+static bool need_changes = true;
+static struct replies changes_replies;
+
+/* The program has no registers, it isn't running */
+static bool no_registers;
+
+static int regview_count(void);
+static bool regview_row(int row, std::string &text);
+static void regview_status(std::string &text);
+static void regview_fetch(int first, int last);
+
+static struct infowin_view regview = {
+    "Registers",
+    regview_count,
+    regview_row,
+    regview_status,
+    regview_fetch,
+    NULL
+};
+
+struct infowin_view *regview_get(void)
+{
+    return &regview;
+}
+
+static int regview_count(void)
+{
+    return rows.size();
+}
+
+static bool regview_row(int row, std::string &text)
+{
+    int number = rows[row];
+    std::map<int, std::string>::iterator it = values.find(number);
+    char buf[64];
+
+    if (it == values.end() && !no_registers)
+        return false;
+
+    snprintf(buf, sizeof(buf), "%c %-*s ", changed.count(number) ? '*' : ' ',
+            REGVIEW_NAME_WIDTH, names[number].c_str());
+    text = buf;
+
+    if (it != values.end())
+        text.append(it->second);
+
+    return true;
+}
+
+static void regview_status(std::string &text)
+{
+    char buf[64];
+
+    if (!have_names) {
+        text = "reading the names";
+    } else if (no_registers) {
+        text = "no registers";
+    } else {
+        snprintf(buf, sizeof(buf), "%d registers, %d changed",
+                (int)rows.size(), (int)changed.size());
+        text = buf;
+    }
+}
+
+/* Ignore the values on their way, they may be from before a stop */
+static void regview_drop_reads(void)
+{
+    replies_drop(&values_replies);
+    pending.clear();
+}
+
+static void regview_fetch(int first, int last)
+{
+    int *numbers = NULL;
+    int i;
+
+    if (!have_names) {
+        if (!replies_waiting(&names_replies)) {
+            replies_expect(&names_replies);
+            tgdb_request_register_names(tgdb);
+        }
+        return;
+    }
+
+    /* Find out what to read again before reading anything */
+    if (need_changes) {
+        need_changes = false;
+        replies_expect(&changes_replies);
+        tgdb_request_changed_registers(tgdb);
+        return;
+    }
+
+    if (replies_waiting(&changes_replies) || no_registers)
+        return;
+
+    last = std::min(last, (int)rows.size() - 1);
+
+    for (i = std::max(first, 0); i <= last; i++) {
+        int number = rows[i];
+
+        if (!values.count(number) && !pending.count(number)) {
+            pending.insert(number);
+            sbpush(numbers, number);
+        }
+    }
+
+    if (sbcount(numbers) > 0) {
+        replies_expect(&values_replies);
+        tgdb_request_register_values(tgdb, numbers);
+    }
+
+    sbfree(numbers);
+}
+
+void regview_update_names(struct tgdb_response *response)
+{
+    char **register_names = response->choice.update_register_names.names;
+    int i;
+
+    if (!replies_receive(&names_replies))
+        return;
+
+    have_names = true;
+    names.clear();
+    rows.clear();
+
+    for (i = 0; i < sbcount(register_names); i++) {
+        names.push_back(register_names[i]);
+        if (register_names[i][0])
+            rows.push_back(i);
+    }
+
+    if_info_changed(&regview);
+}
+
+void regview_update_changed(struct tgdb_response *response)
+{
+    int *numbers = response->choice.update_changed_registers.numbers;
+    int i;
+
+    replies_receive(&changes_replies);
+    changed.clear();
+
+    /* gdb can't tell, read all of them again */
+    if (response->choice.update_changed_registers.error) {
+        values.clear();
+        no_registers = true;
+        if_info_changed(&regview);
+        return;
+    }
+
+    /* The other values are still good, gdb compared them */
+    no_registers = false;
+    for (i = 0; i < sbcount(numbers); i++) {
+        values.erase(numbers[i]);
+        changed.insert(numbers[i]);
+    }
+
+    if_info_changed(&regview);
+}
+
+void regview_update_values(struct tgdb_response *response)
+{
+    struct tgdb_register *registers =
+        response->choice.update_register_values.registers;
+    int i;
+
+    if (!replies_receive(&values_replies))
+        return;
+
+    if (response->choice.update_register_values.error) {
+        /* Show the rows that were on their way as unreadable */
+        std::set<int>::iterator it;
+
+        for (it = pending.begin(); it != pending.end(); ++it)
+            values[*it] = "<unavailable>";
+        pending.clear();
+    } else {
+        for (i = 0; i < sbcount(registers); i++) {
+            values[registers[i].number] = registers[i].value;
+            pending.erase(registers[i].number);
+        }
+    }
+
+    if_info_changed(&regview);
+}
+
+void regview_inferior_changed(struct tgdb_response *response)
+{
+    switch (response->header) {
+        case TGDB_INFERIOR_RUNNING:
+            /* Keep the values, most of them are the same at the next stop */
+            regview_drop_reads();
+            break;
+        case TGDB_INFERIOR_STOPPED:
+            /* Another frame or thread has other values too */
+            need_changes = true;
+            regview_drop_reads();
+            break;
+        case TGDB_INFERIOR_EXITED:
+            /* The next program may be for another architecture */
+            need_changes = true;
+            regview_drop_reads();
+            values.clear();
+            changed.clear();
+            replies_drop(&names_replies);
+            have_names = false;
+            names.clear();
+            rows.clear();
+            break;
+        default:
+            return;
+    }
+
+    if_info_changed(&regview);
+}
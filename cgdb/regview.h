@@ -0,0 +1,46 @@
+// The registers view of the info window
+//
+// The view lists the registers of the selected frame. The names are read
+// once, and kept until the program exits and may be replaced by one for
+// another architecture. After a stop the view asks gdb which registers
+// changed and reads the values again only for those on screen, so a step
+// doesn't read hundreds of vector registers that didn't move.
+
+#ifndef _REGVIEW_H_
+#define _REGVIEW_H_
+
+#include "infowin.h"
+#include "tgdb.h"
+
+// Get the registers view, to show in the info window
+//
+// @return
+// The registers view
+struct infowin_view *regview_get(void);
+
+// Handle a TGDB_UPDATE_REGISTER_NAMES response
+//
+// @param response
+// The response from tgdb
+void regview_update_names(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_CHANGED_REGISTERS response
+//
+// @param response
+// The response from tgdb
+void regview_update_changed(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_REGISTER_VALUES response
+//
+// @param response
+// The response from tgdb
+void regview_update_values(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, the values may be out of date
+//
+// @param response
+// The response from tgdb
+void regview_inferior_changed(struct tgdb_response *response);
+
+#endif
@@ -0,0 +1,37 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "replies.h"
+
+void replies_expect(struct replies *r)
+{
+    r->waiting++;
+}
+
+void replies_drop(struct replies *r)
+{
+    r->stale = r->waiting;
+}
+
+bool replies_waiting(const struct replies *r)
+{
+    return r->waiting > r->stale;
+}
+
+bool replies_receive(struct replies *r)
+{
+    /* Nothing was asked for */
+    if (r->waiting == 0)
+        return false;
+
+    r->waiting--;
+
+    /* The replies come in order, the stale ones first */
+    if (r->stale > 0) {
+        r->stale--;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+// The replies a window waits for from gdb
+//
+// tgdb answers each request of the info window once, in the order they
+// were made. When a window drops what it read while requests are on their
+// way, like when the inferior runs, the replies to those are stale. They
+// are counted here and skipped as they come in.
+
+#ifndef _REPLIES_H_
+#define _REPLIES_H_
+
+// The replies to one kind of request
+struct replies {
+    // The requests that weren't answered yet
+    int waiting;
+
+    // The first of those, whose replies are skipped
+    int stale;
+};
+
+// A request was made
+//
+// @param r
+// The replies to operate on
+void replies_expect(struct replies *r);
+
+// Skip the replies to the requests made so far
+//
+// @param r
+// The replies to operate on
+void replies_drop(struct replies *r);
+
+// Tell if a reply that isn't skipped is on its way
+//
+// @param r
+// The replies to operate on
+//
+// @return
+// True if one is on its way
+bool replies_waiting(const struct replies *r);
+
+// A reply came in
+//
+// @param r
+// The replies to operate on
+//
+// @return
+// True if the reply is to be used, false if it is stale
+bool replies_receive(struct replies *r);
+
+#endif
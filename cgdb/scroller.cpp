@@ -288,9 +288,9 @@ void scr_push_screen_to_scrollback(struct scroller *scr)
     vterminal_push_screen_to_scrollback(scr->vt);
 }
 
-void scr_add(struct scroller *scr, const char *buf)
+void scr_add(struct scroller *scr, const char *buf, size_t length)
 {
-    vterminal_write(scr->vt, buf, strlen(buf));
+    vterminal_write(scr->vt, buf, length);
 }
 
 void scr_move(struct scroller *scr, SWINDOW *win)
@@ -571,9 +571,6 @@ void scr_refresh(struct scroller *scr, int focus, enum win_refresh dorefresh)
     int width;
     vterminal_get_height_width(scr->vt, height, width);
 
-    int vterm_cursor_row, vterm_cursor_col;
-    vterminal_get_cursor_pos(scr->vt, vterm_cursor_row, vterm_cursor_col);
-
     int sb_num_rows;
     vterminal_scrollback_num_rows(scr->vt, sb_num_rows);
 
@@ -582,51 +579,52 @@ void scr_refresh(struct scroller *scr, int focus, enum win_refresh dorefresh)
 
     int highlight_attr, search_attr;
 
-    int cursor_row, cursor_col;
-
-    if (scr->in_scroll_mode) {
-        cursor_row = scr->scroll_cursor_row;
-        cursor_col = scr->scroll_cursor_col;
-    } else {
-        cursor_row = vterm_cursor_row;
-        cursor_col = vterm_cursor_col;
-    }
-
     /* Steal line highlight attribute for our scroll mode status */
     highlight_attr = hl_groups_get_attr(hl_groups_instance,
         HLG_SCROLL_MODE_STATUS);
 
     search_attr = hl_groups_get_attr(hl_groups_instance, HLG_INCSEARCH);
 
+    std::string rowtext;
+    std::vector<VTerminalSpan> spans;
+
     for (int r = 0; r < height; ++r) {
-        for (int c = 0; c < width; ) {
-            std::string utf8buf;
-            int attr = 0;
-            int cellwidth;
-            int in_search = scr->in_search_mode && scr->search_row == r &&
-                    c >= scr->search_col_start && c < scr->search_col_end;
-
-            vterminal_fetch_row_col(scr->vt, r, c, utf8buf, attr, cellwidth);
-            swin_wmove(scr->win, r,  c);
-            swin_wattron(scr->win, attr);
+        int split_start = -1, split_end = -1;
+        const char *text;
+        int c = 0;
+
+        if (scr->in_search_mode && scr->search_row == r) {
+            split_start = scr->search_col_start;
+            split_end = scr->search_col_end;
+        }
+
+        // Draw the row a run of equal attributes at a time
+        vterminal_fetch_row_spans(scr->vt, r, split_start, split_end,
+                rowtext, spans);
+
+        swin_wmove(scr->win, r, 0);
+        text = rowtext.data();
+        for (const VTerminalSpan &span : spans) {
+            int in_search = split_start != -1 &&
+                    c >= split_start && c < split_end;
+
+            swin_wattron(scr->win, span.attr);
             if (in_search)
                 swin_wattron(scr->win, search_attr);
 
-            // print the cell utf8 data or an empty char
-            // If nothing is written at all, then the cell will not be colored
-            if (utf8buf.size()) {
-                swin_waddnstr(scr->win, utf8buf.data(), utf8buf.size());
-            } else {
-                swin_waddnstr(scr->win, " ", 1);
-            }
+            swin_waddnstr(scr->win, text, span.len);
 
             if (in_search)
                 swin_wattroff(scr->win, search_attr);
-            swin_wattroff(scr->win, attr);
-            swin_wclrtoeol(scr->win);
-            c += cellwidth;
+            swin_wattroff(scr->win, span.attr);
+
+            text += span.len;
+            c += span.width;
         }
 
+        if (c < width)
+            swin_wclrtoeol(scr->win);
+
         // If in scroll mode, overlay the percent the scroller is scrolled
         // back on the top right of the scroller display.
         if (scr->in_scroll_mode && r == 0) {
@@ -644,8 +642,23 @@ void scr_refresh(struct scroller *scr, int focus, enum win_refresh dorefresh)
         }
     }
 
+    scr_show_cursor(scr, focus, dorefresh);
+}
+
+void scr_show_cursor(struct scroller *scr, int focus,
+        enum win_refresh dorefresh)
+{
     // Show the cursor when the scroller is in focus
     if (focus) {
+        int cursor_row, cursor_col;
+
+        if (scr->in_scroll_mode) {
+            cursor_row = scr->scroll_cursor_row;
+            cursor_col = scr->scroll_cursor_col;
+        } else {
+            vterminal_get_cursor_pos(scr->vt, cursor_row, cursor_col);
+        }
+
         swin_wmove(scr->win, cursor_row, cursor_col);
         swin_curs_set(1);
     } else {
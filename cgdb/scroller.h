@@ -172,8 +172,11 @@ void scr_push_screen_to_scrollback(struct scroller *scr);
 // The scroller to operate on
 //
 // @param buf
-// The buffer to append
-void scr_add(struct scroller *scr, const char *buf);
+// The buffer to append, it does not need to be NUL terminated
+//
+// @param length
+// The number of bytes in buf
+void scr_add(struct scroller *scr, const char *buf, size_t length);
 
 // Give the scroller a new window to display itself in
 //
@@ -196,5 +199,21 @@ void scr_move(struct scroller *scr, SWINDOW *win);
 // Controls how the scroller should update the screen
 void scr_refresh(struct scroller *scr, int focus, enum win_refresh dorefresh);
 
+// Places the cursor where scr_refresh leaves it, without redrawing
+//
+// Used when the scroller's contents are unchanged, but another window
+// was drawn after it and moved the cursor.
+//
+// @param scr
+// The scroller to operate on
+//
+// @param focus
+// True if the scroller has focus, false otherwise
+//
+// @param dorefresh
+// Controls how the scroller should update the screen
+void scr_show_cursor(struct scroller *scr, int focus,
+        enum win_refresh dorefresh);
+
 
 #endif
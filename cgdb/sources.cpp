@@ -44,11 +44,27 @@
 #include <ctype.h>
 #endif
 
+#if HAVE_ERRNO_H
+#include <errno.h>
+#endif /* HAVE_ERRNO_H */
+
+#if HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif /* HAVE_SYS_INOTIFY_H */
+
 #ifdef HAVE_STDINT_H
 #include <stdint.h>
 #endif
 
+#if HAVE_REGEX_H
+#include <regex.h>
+#endif /* HAVE_REGEX_H */
+
 #include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 
 /* Local Includes */
 #include "sys_util.h"
@@ -64,6 +80,7 @@
 #include "highlight_groups.h"
 #include "interface.h"
 #include "tgdb.h"
+#include "grep_literal.h"
 
 int sources_syntax_on = 1;
 
@@ -130,6 +147,8 @@ static void init_file_buffer(struct buffer *buf)
     buf->file_data = NULL;
     buf->tabstop = cgdbrc_get_int(CGDBRC_TABSTOP);
     buf->language = TOKENIZER_LANGUAGE_UNKNOWN;
+    buf->bytes = 0;
+    buf->generation = 0;
 }
 
 static void release_file_buffer(struct buffer *buf)
@@ -141,6 +160,9 @@ static void release_file_buffer(struct buffer *buf)
             sbfree(buf->lines[i].attrs);
             buf->lines[i].attrs = NULL;
 
+            sbfree(buf->lines[i].search_attrs);
+            buf->lines[i].search_attrs = NULL;
+
             sbfree(buf->lines[i].line);
             buf->lines[i].line = NULL;
         }
@@ -157,7 +179,31 @@ static void release_file_buffer(struct buffer *buf)
 
         buf->max_width = 0;
         buf->language = TOKENIZER_LANGUAGE_UNKNOWN;
+        buf->bytes = 0;
+
+        /* A reload may get the same memory back, so the window can't
+         * tell the lines apart by their address */
+        buf->generation++;
+    }
+}
+
+/* Count the memory used by a buffer. The search matches are left out,
+ * they are only kept for the lines shown. */
+static size_t source_buffer_bytes(struct buffer *buf)
+{
+    size_t bytes;
+    int i;
+
+    bytes = sbcount(buf->lines) * sizeof(struct source_line) +
+            sbcount(buf->addrs) * sizeof(uint64_t) +
+            sbcount(buf->file_data);
+
+    for (i = 0; i < sbcount(buf->lines); i++) {
+        bytes += sbcount(buf->lines[i].line) +
+                sbcount(buf->lines[i].attrs) * sizeof(struct hl_line_attr);
     }
+
+    return bytes;
 }
 
 /** 
@@ -174,15 +220,64 @@ static int release_file_memory(struct list_node *node)
     if (!node)
         return -1;
 
-    /* Release file buffers */
+    /* Release file buffers. The line flags are kept, they don't depend
+     * on the file buffer being loaded. */
     release_file_buffer(&node->file_buf);
 
-    // Free the flags associated with the file buffer
-    node->lflags.clear();
-
     return 0;
 }
 
+/* source_find_line_flags:  Find the flags of a line.
+ * -----------------------
+ *
+ *   node:  The file to search.
+ *   line:  The line, 0-indexed.
+ *
+ * Return Value:  The first entry at or after line, or lflags.end().
+ */
+static std::vector<line_flags>::iterator
+source_find_line_flags(struct list_node *node, int line)
+{
+    return std::lower_bound(node->lflags.begin(), node->lflags.end(), line,
+        [](const line_flags &lf, int line) { return lf.line < line; });
+}
+
+/* source_get_line_flags:  Get the flags of a line, adding them if needed.
+ * ----------------------
+ *
+ *   node:  The file the line is in.
+ *   line:  The line, 0-indexed.
+ *
+ * Return Value:  The flags of the line.
+ */
+static line_flags &source_get_line_flags(struct list_node *node, int line)
+{
+    auto iter = source_find_line_flags(node, line);
+
+    if (iter == node->lflags.end() || iter->line != line) {
+        iter = node->lflags.insert(iter, line_flags());
+        iter->line = line;
+    }
+
+    return *iter;
+}
+
+/* source_prune_line_flags:  Remove the flags of a line if they're unused.
+ * ------------------------
+ *
+ *   node:  The file the line is in.
+ *   line:  The line, 0-indexed.
+ */
+static void source_prune_line_flags(struct list_node *node, int line)
+{
+    auto iter = source_find_line_flags(node, line);
+
+    if (iter != node->lflags.end() && iter->line == line &&
+        iter->breakpt == line_flags::breakpt_status::none &&
+        iter->marks.empty())
+        node->lflags.erase(iter);
+}
+
 static char *detab_buffer(char *buffer, int tabstop)
 {
     int i;
@@ -292,6 +387,8 @@ static int load_file_buf(struct buffer *buf, const char *filename)
                 sline.line[line_len] = 0;
                 sline.len = line_len;
                 sline.attrs = NULL;
+                sline.search_attrs = NULL;
+                sline.search_generation = 0;
 
                 /* Add this line to lines array */
                 sbpush(buf->lines, sline);
@@ -308,6 +405,8 @@ static int load_file_buf(struct buffer *buf, const char *filename)
                 strncpy(sline.line, line_start, len);
                 sline.len = len;
                 sline.attrs = NULL;
+                sline.search_attrs = NULL;
+                sline.search_generation = 0;
 
                 sbpush(buf->lines, sline);
             }
@@ -484,11 +583,7 @@ int source_highlight(struct list_node *node)
         highlight_node(node);
     }
 
-    /* Allocate the breakpoints array */
-    if (node->lflags.empty()) {
-        int count = sbcount(node->file_buf.lines);
-        node->lflags.resize(count);
-    }
+    node->file_buf.bytes = source_buffer_bytes(&node->file_buf);
 
     if (node->file_buf.lines)
         return 0;
@@ -514,7 +609,24 @@ struct sviewer *source_new(SWINDOW *win)
     rv->jump_back_mark.node = NULL;
     rv->jump_back_mark.line = -1;
 
+    rv->matches = NULL;
+    rv->cur_match = -1;
+    rv->bp_nodes = NULL;
+
+    rv->watch_fd = -1;
+    rv->watches = NULL;
+#if HAVE_SYS_INOTIFY_H
+    rv->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (rv->watch_fd == -1)
+        clog_error(CLOG_CGDB, "inotify_init1 failed: %s", strerror(errno));
+#endif
+
     rv->addr_frame = 0;
+    rv->use_clock = 0;
+
+    /* Let curses scroll the terminal when the source scrolls */
+    swin_idlok(win, 1);
+    rv->shown.node = NULL;
 
     rv->hlregex = NULL;
     rv->last_hlregex = NULL;
@@ -522,6 +634,245 @@ struct sviewer *source_new(SWINDOW *win)
     return rv;
 }
 
+#if HAVE_SYS_INOTIFY_H
+/* The events that mean a file in a watched directory may have changed */
+#define SOURCE_WATCH_EVENTS (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | \
+        IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR)
+#endif
+
+/* source_watch_add:  Watch the directory of a source file.
+ * -----------------
+ *
+ * Files in the same directory share the watch.
+ *
+ *   path:   The path of the source file
+ *   return: The watch descriptor, or -1 if the file is not watched
+ */
+static int source_watch_add(struct sviewer *sview, const char *path)
+{
+#if HAVE_SYS_INOTIFY_H
+    const char *slash = strrchr(path, '/');
+    struct sviewer_watch watch;
+    std::string dir;
+    int dirs, files;
+    int i, wd;
+
+    if (sview->watch_fd == -1 || path[0] == '*')
+        return -1;
+
+    if (!slash)
+        dir = ".";
+    else if (slash == path)
+        dir = "/";
+    else
+        dir.assign(path, slash - path);
+
+    wd = inotify_add_watch(sview->watch_fd, dir.c_str(), SOURCE_WATCH_EVENTS);
+    if (wd == -1)
+        return -1;
+
+    for (i = 0; i < sbcount(sview->watches); i++) {
+        if (sview->watches[i].wd == wd) {
+            sview->watches[i].files++;
+            return wd;
+        }
+    }
+
+    watch.wd = wd;
+    watch.files = 1;
+    sbpush(sview->watches, watch);
+
+    source_watch_counts(sview, &dirs, &files);
+    clog_info(CLOG_CGDB, "Watching %d source files in %d directories",
+            files, dirs);
+
+    return wd;
+#else
+    return -1;
+#endif
+}
+
+/* source_watch_remove:  Stop watching a file's directory.
+ * --------------------
+ *
+ * The directory is only unwatched once no other file in it is watched.
+ *
+ *   wd:     The watch descriptor returned by source_watch_add
+ *   active: If 0, the kernel already removed the watch
+ */
+static void source_watch_remove(struct sviewer *sview, int wd, int active)
+{
+    int i, count = sbcount(sview->watches);
+
+    for (i = 0; i < count; i++) {
+        if (sview->watches[i].wd == wd) {
+            if (--sview->watches[i].files == 0 || !active) {
+#if HAVE_SYS_INOTIFY_H
+                if (active)
+                    inotify_rm_watch(sview->watch_fd, wd);
+#endif
+                sview->watches[i] = sview->watches[count - 1];
+                sbsetcount(sview->watches, count - 1);
+            }
+            return;
+        }
+    }
+}
+
+int source_watch_fd(struct sviewer *sview)
+{
+    return sview->watch_fd;
+}
+
+#if HAVE_SYS_INOTIFY_H
+/* source_watch_event:  Mark the files an inotify event is about.
+ * -------------------
+ *
+ *   return: The number of loaded files newly marked as changed
+ */
+static int source_watch_event(struct sviewer *sview,
+        const struct inotify_event *event)
+{
+    struct list_node *node;
+    int changed = 0;
+
+    for (node = sview->list_head; node; node = node->next) {
+        int match;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            /* Events were lost, every file has to be checked */
+            match = 1;
+        } else if (node->watch_wd != event->wd) {
+            match = 0;
+        } else if (event->mask & IN_IGNORED) {
+            /* The directory is gone, fall back to checking the file */
+            node->watch_wd = -1;
+            match = 1;
+        } else {
+            const char *name = strrchr(node->path, '/');
+
+            name = name ? name + 1 : node->path;
+            match = event->len && strcmp(name, event->name) == 0;
+        }
+
+        if (match) {
+            if (!node->watch_changed && node->file_buf.lines)
+                changed++;
+            node->watch_changed = 1;
+        }
+    }
+
+    if (event->mask & IN_IGNORED)
+        source_watch_remove(sview, event->wd, 0);
+
+    return changed;
+}
+#endif
+
+int source_watch_process(struct sviewer *sview)
+{
+    int changed = 0;
+
+#if HAVE_SYS_INOTIFY_H
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t len;
+
+    if (sview->watch_fd == -1)
+        return 0;
+
+    while ((len = read(sview->watch_fd, buf, sizeof(buf))) > 0) {
+        char *p = buf;
+
+        while (p < buf + len) {
+            const struct inotify_event *event =
+                    (const struct inotify_event *)p;
+
+            changed += source_watch_event(sview, event);
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+
+    return changed;
+}
+
+/* A file that source_trim may release */
+static int source_can_trim(struct sviewer *sview, struct list_node *node)
+{
+    return node->file_buf.lines && node->path[0] != '*' &&
+            node != sview->cur && node != sview->shown.node;
+}
+
+int source_trim(struct sviewer *sview)
+{
+    size_t budget = (size_t)cgdbrc_get_int(CGDBRC_SOURCE_MEMORY) << 20;
+    size_t bytes = 0;
+    struct list_node *node;
+    int released = 0;
+
+    /* No limit */
+    if (budget == 0)
+        return 0;
+
+    /* The sourcememory option can be set in cgdbrc, before there is a
+     * source viewer. It is applied as files are loaded. */
+    if (!sview)
+        return 0;
+
+    for (node = sview->list_head; node; node = node->next) {
+        if (node->file_buf.lines)
+            bytes += node->file_buf.bytes;
+    }
+
+    while (bytes > budget) {
+        struct list_node *oldest = NULL;
+
+        for (node = sview->list_head; node; node = node->next) {
+            if (source_can_trim(sview, node) &&
+                    (!oldest || node->last_used < oldest->last_used))
+                oldest = node;
+        }
+
+        if (!oldest)
+            break;
+
+        /* The marks, breakpoints and lines are in the node, not the
+         * buffer, load_file gets the rest back */
+        bytes -= oldest->file_buf.bytes;
+        release_file_memory(oldest);
+        released++;
+    }
+
+    return released;
+}
+
+void source_memory_usage(struct sviewer *sview, int *loaded, int *files,
+        size_t *bytes)
+{
+    struct list_node *node;
+
+    *loaded = 0;
+    *files = 0;
+    *bytes = 0;
+    for (node = sview->list_head; node; node = node->next) {
+        (*files)++;
+        if (node->file_buf.lines) {
+            (*loaded)++;
+            *bytes += node->file_buf.bytes;
+        }
+    }
+}
+
+void source_watch_counts(struct sviewer *sview, int *dirs, int *files)
+{
+    int i;
+
+    *dirs = sbcount(sview->watches);
+    *files = 0;
+    for (i = 0; i < *dirs; i++)
+        *files += sview->watches[i].files;
+}
+
 struct list_node *source_add(struct sviewer *sview, const char *path)
 {
     struct list_node *new_node;
@@ -540,12 +891,15 @@ struct list_node *source_add(struct sviewer *sview, const char *path)
     new_node->sel_rline = 0;
     new_node->exe_line = -1;
     new_node->last_modification = 0;    /* No timestamp yet */
+    new_node->watch_wd = source_watch_add(sview, path);
+    new_node->watch_changed = 1;        /* Not checked yet */
     new_node->language = TOKENIZER_LANGUAGE_UNKNOWN;
     new_node->addr_start = 0;
     new_node->addr_end = 0;
 
     /* Initialize all local marks to -1 */
     memset(new_node->local_marks, 0xff, sizeof(new_node->local_marks));
+    new_node->last_used = 0;
 
     if (sview->list_head == NULL) {
         /* List is empty, this is the first node */
@@ -572,6 +926,8 @@ void source_add_disasm_line(struct list_node *node, const char *line)
     sline.line = detab_buffer(sline.line, node->file_buf.tabstop);
 
     sline.attrs = NULL;
+    sline.search_attrs = NULL;
+    sline.search_generation = 0;
     sline.len = sbcount(sline.line);
 
     colon = strchr((char*)line, ':');
@@ -589,7 +945,44 @@ void source_add_disasm_line(struct list_node *node, const char *line)
     sbpush(node->file_buf.addrs, addr);
 
     sbpush(node->file_buf.lines, sline);
-    node->lflags.emplace_back();
+}
+
+/* source_clear_matches:  Empty the quickfix list.
+ * ---------------------
+ */
+static void source_clear_matches(struct sviewer *sview)
+{
+    int i;
+
+    for (i = 0; i < sbcount(sview->matches); i++)
+        free(sview->matches[i].text);
+
+    sbfree(sview->matches);
+    sview->matches = NULL;
+    sview->cur_match = -1;
+}
+
+/* source_drop_matches:  Remove the matches in a file from the quickfix list.
+ * --------------------
+ *
+ *   node:  The file being removed.
+ */
+static void source_drop_matches(struct sviewer *sview, struct list_node *node)
+{
+    int i, count = 0;
+
+    for (i = 0; i < sbcount(sview->matches); i++) {
+        if (sview->matches[i].node == node) {
+            free(sview->matches[i].text);
+            if (i <= sview->cur_match)
+                sview->cur_match--;
+        } else {
+            sview->matches[count++] = sview->matches[i];
+        }
+    }
+
+    if (sview->matches)
+        sbsetcount(sview->matches, count);
 }
 
 int source_del(struct sviewer *sview, const char *path)
@@ -611,6 +1004,10 @@ int source_del(struct sviewer *sview, const char *path)
     /* Release file buffers */
     release_file_buffer(&cur->file_buf);
 
+    /* Stop watching for changes */
+    if (cur->watch_wd != -1)
+        source_watch_remove(sview, cur->watch_wd, 1);
+
     /* Release file name */
     free(cur->path);
     cur->path = NULL;
@@ -630,6 +1027,45 @@ int source_del(struct sviewer *sview, const char *path)
             sview->global_marks[i].node = NULL;
     }
 
+    if (sview->shown.node == cur)
+        sview->shown.node = NULL;
+
+    /* And from the files with breakpoints */
+    for (i = 0; i < sbcount(sview->bp_nodes); i++) {
+        if (sview->bp_nodes[i] == cur) {
+            sview->bp_nodes[i] = sview->bp_nodes[sbcount(sview->bp_nodes) - 1];
+            sbsetcount(sview->bp_nodes, sbcount(sview->bp_nodes) - 1);
+            break;
+        }
+    }
+
+    /* And drop its matches from the quickfix list */
+    source_drop_matches(sview, cur);
+
+    return 0;
+}
+
+int source_preload(struct sviewer *sview, const char *path)
+{
+    struct list_node *node = source_get_node(sview, path);
+
+    if (!node) {
+        if (!fs_verify_file_exists(path))
+            return -1;
+
+        node = source_add(sview, path);
+    }
+
+    if (node->file_buf.lines)
+        return 1;
+
+    if (load_file(node))
+        return -1;
+
+    /* It is about to be shown, keep it over the files shown before */
+    node->last_used = ++sview->use_clock;
+    source_trim(sview);
+
     return 0;
 }
 
@@ -660,11 +1096,15 @@ char *source_current_file(struct sviewer *sview)
 static int source_get_mark_char(struct sviewer *sview,
     struct list_node *node, int line)
 {
-    if (!node || (line < 0) || (line >= node->lflags.size()))
+    std::vector<line_flags>::iterator iter;
+
+    if (!node || (line < 0) || (line >= sbcount(node->file_buf.lines)))
         return -1;
 
-    if (!node->lflags[line].marks.empty()) {
-        return node->lflags[line].marks.front();
+    iter = source_find_line_flags(node, line);
+    if (iter != node->lflags.end() && iter->line == line &&
+        !iter->marks.empty()) {
+        return iter->marks.front();
     }
 
     return 0;
@@ -697,12 +1137,15 @@ int source_set_mark(struct sviewer *sview, int key)
 
     if (ret) {
         if (old_node && old_line != -1) {
-            auto& marks{ old_node->lflags[old_line].marks };
+            auto& marks{ source_get_line_flags(old_node, old_line).marks };
             marks.erase(std::find(marks.begin(), marks.end(), key));
+            source_prune_line_flags(old_node, old_line);
         }
         if (add) {
-            sview->cur->lflags[sel_line].marks.push_front(key);
+            source_get_line_flags(sview->cur, sel_line).marks.push_front(key);
         }
+
+        source_redraw(sview);
     }
 
     return ret;
@@ -743,6 +1186,196 @@ int source_goto_mark(struct sviewer *sview, int key)
     return 0;
 }
 
+/* The most threads source_grep will search with */
+#define SOURCE_GREP_MAX_THREADS 8
+
+/* A file to search, and the lines in it that matched */
+struct source_grep_job {
+    struct list_node *node;
+    std::vector<std::pair<int, std::string> > matches;
+};
+
+/* source_grep_contains:  Check if a line contains a literal string.
+ * ---------------------
+ *
+ * literal must already be lower case if icase is set.
+ */
+static int source_grep_contains(const char *line, const std::string &literal,
+        int icase)
+{
+    size_t len = literal.size();
+
+    if (!icase)
+        return strstr(line, literal.c_str()) != NULL;
+
+    for (; *line; ++line) {
+        size_t i;
+
+        for (i = 0; i < len; ++i) {
+            if (tolower((unsigned char)line[i]) != (unsigned char)literal[i])
+                break;
+        }
+
+        if (i == len)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* source_grep_file:  Search one file, called from the worker threads.
+ * -----------------
+ *
+ * Loaded files are searched in memory, the others are read from disk.
+ * Nothing shared is modified, so any number of files can be searched
+ * at once.
+ */
+static void source_grep_file(struct source_grep_job *job, const char *regex,
+        int icase, const std::string &literal)
+{
+    struct buffer *buf = &job->node->file_buf;
+    regex_t t;
+    int i;
+
+    if (regcomp(&t, regex, REG_EXTENDED | REG_NOSUB | (icase ? REG_ICASE : 0)))
+        return;
+
+    if (buf->lines) {
+        for (i = 0; i < sbcount(buf->lines); ++i) {
+            const char *line = buf->lines[i].line;
+
+            if (!literal.empty() && !source_grep_contains(line, literal, icase))
+                continue;
+
+            if (regexec(&t, line, 0, NULL, 0) == 0)
+                job->matches.push_back(std::make_pair(i, std::string(line)));
+        }
+    } else {
+        FILE *file = fopen(job->node->path, "r");
+        char *line = NULL;
+        size_t size = 0;
+        ssize_t len;
+
+        if (file) {
+            for (i = 0; (len = getline(&line, &size, file)) != -1; ++i) {
+                while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+                    line[--len] = '\0';
+
+                if (!literal.empty() && !source_grep_contains(line, literal, icase))
+                    continue;
+
+                if (regexec(&t, line, 0, NULL, 0) == 0)
+                    job->matches.push_back(std::make_pair(i, std::string(line)));
+            }
+
+            free(line);
+            fclose(file);
+        }
+    }
+
+    regfree(&t);
+}
+
+int source_grep(struct sviewer *sview, const char *regex, int icase, int load)
+{
+    std::vector<source_grep_job> jobs;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next(0);
+    std::string literal;
+    struct list_node *node;
+    unsigned int nthreads;
+    regex_t t;
+
+    /* Make sure the regex is valid before starting any workers */
+    if (regcomp(&t, regex, REG_EXTENDED | REG_NOSUB | (icase ? REG_ICASE : 0)))
+        return -1;
+    regfree(&t);
+
+    literal = grep_literal(regex);
+    if (icase) {
+        for (char &c : literal) {
+            /* Case folding of multibyte characters is left to the regex */
+            if ((unsigned char)c >= 0x80) {
+                literal.clear();
+                break;
+            }
+            c = tolower((unsigned char)c);
+        }
+    }
+
+    for (node = sview->list_head; node; node = node->next) {
+        if (node->file_buf.lines || (load && node->path[0] != '*')) {
+            source_grep_job job;
+            job.node = node;
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    /* Report the matches by file name rather than by recent use */
+    std::sort(jobs.begin(), jobs.end(),
+            [](const source_grep_job &a, const source_grep_job &b) {
+                return strcmp(a.node->path, b.node->path) < 0;
+            });
+
+    auto worker = [&]() {
+        size_t i;
+
+        while ((i = next++) < jobs.size())
+            source_grep_file(&jobs[i], regex, icase, literal);
+    };
+
+    nthreads = std::thread::hardware_concurrency();
+    nthreads = std::min(nthreads ? nthreads : 1, (unsigned int)SOURCE_GREP_MAX_THREADS);
+    nthreads = std::min(nthreads, (unsigned int)jobs.size());
+
+    /* This thread searches too */
+    for (unsigned int i = 1; i < nthreads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread &thread : threads)
+        thread.join();
+
+    source_clear_matches(sview);
+
+    for (source_grep_job &job : jobs) {
+        for (std::pair<int, std::string> &match : job.matches) {
+            struct sviewer_match m;
+
+            m.node = job.node;
+            m.line = match.first;
+            m.text = cgdb_strdup(match.second.c_str());
+            sbpush(sview->matches, m);
+        }
+    }
+
+    return sbcount(sview->matches);
+}
+
+int source_goto_match(struct sviewer *sview, int offset)
+{
+    struct sviewer_match *match;
+    int index = sview->cur_match + offset;
+
+    if (index < 0 || index >= sbcount(sview->matches))
+        return 0;
+
+    match = &sview->matches[index];
+
+    /* Files searched on disk are loaded when first jumped to */
+    if (load_file(match->node))
+        return 0;
+
+    if (sview->cur) {
+        sview->jump_back_mark.line = sview->cur->sel_line;
+        sview->jump_back_mark.node = sview->cur;
+    }
+
+    sview->cur_match = index;
+    sview->cur = match->node;
+    source_set_sel_line(sview, match->line + 1);
+    return 1;
+}
+
 static int get_line_leading_ws_count(const char *otext, int length)
 {
     int i;
@@ -759,7 +1392,262 @@ static int get_line_leading_ws_count(const char *otext, int length)
     return column_offset;
 }
 
-/** 
+/**
+ * Get the hlsearch matches for a line.
+ *
+ * The matches are cached in the line until the regular expression changes,
+ * so redrawing or scrolling over lines already displayed does no regex work.
+ *
+ * @param info
+ * The regular expression to search the line with.
+ *
+ * @param sline
+ * The line to search.
+ *
+ * @return
+ * The line attributes of the matches. Owned by the line, do not free.
+ */
+static struct hl_line_attr *source_get_search_attrs(
+        struct hl_regex_info **info, struct source_line *sline)
+{
+    unsigned long generation = hl_regex_generation(*info);
+
+    if (sline->search_generation != generation) {
+        sbfree(sline->search_attrs);
+        sline->search_attrs = hl_regex_highlight(info, sline->line, HLG_SEARCH);
+        sline->search_generation = generation;
+    }
+
+    return sline->search_attrs;
+}
+
+/* The attributes and settings source_display_line draws with */
+struct source_draw {
+    int count;                  /* The number of lines in the file */
+    int width;                  /* The width of the window */
+    int lwidth;                 /* The width of the line numbers */
+    char fmt[16];               /* The format of the line numbers */
+    int focus_attr;
+    int showmarks;
+    int do_hlsearch;
+    int mark_attr;
+    int sellineno, exelineno;
+    int enabled_bp, disabled_bp;
+    enum LineDisplayStyle exe_display_style, sel_display_style;
+    int exe_line_display_is_arrow, sel_line_display_is_arrow;
+    int exe_arrow_attr, sel_arrow_attr;
+    int exe_block_attr, sel_block_attr;
+    struct hl_line_attr *sel_highlight_attrs;
+    struct hl_line_attr *exe_highlight_attrs;
+};
+
+/* source_display_line:  Draw a single row of the source window.
+ * --------------------
+ *
+ *   sview:  Source viewer object
+ *   draw:   The attributes to draw with
+ *   row:    The row of the window to draw
+ *   line:   The line of the file to draw in the row, 0-indexed. Lines
+ *           outside of the file are drawn as ~.
+ */
+static void source_display_line(struct sviewer *sview,
+    const struct source_draw *draw, int row, int line)
+{
+    int column_offset = 0;
+    /* Is this the current selected line? */
+    int is_sel_line = (line >= 0 && sview->cur->sel_line == line);
+    /* Is this the current executing line */
+    int is_exe_line = (line >= 0 && sview->cur->exe_line == line);
+    struct source_line *sline = (line < 0 || line >= draw->count)?
+        NULL:&sview->cur->file_buf.lines[line];
+    struct hl_line_attr *printline_attrs = (sline)?sline->attrs:0;
+
+    swin_wmove(sview->win, row, 0);
+
+    /* Print the line number */
+    if (line < 0 || line >= draw->count) {
+        for (int j = 1; j < draw->lwidth; j++)
+            swin_waddch(sview->win, ' ');
+        swin_waddch(sview->win, '~');
+    } else {
+        int line_attr = 0;
+        switch (source_get_breakpoint(sview->cur, line))
+        {
+            case line_flags::breakpt_status::enabled:
+                line_attr = draw->enabled_bp;
+                break;
+            case line_flags::breakpt_status::disabled:
+                line_attr = draw->disabled_bp;
+                break;
+            case line_flags::breakpt_status::none:
+                if (is_exe_line)
+                    line_attr = draw->exelineno;
+                else if (is_sel_line)
+                    line_attr = draw->sellineno;
+                break;
+        }
+
+        swin_wattron(sview->win, line_attr);
+        swin_wprintw(sview->win, draw->fmt, line + 1);
+        swin_wattroff(sview->win, line_attr);
+    }
+
+    if (!swin_has_colors()) {
+        /* TODO:
+        swin_wprintw(sview->win, "%.*s\n",
+                sview->cur->file_buf.lines[line].line,
+                sview->cur->file_buf.lines[line].len);
+        */
+        return;
+    }
+
+    /* Print the vertical bar or mark */
+    {
+        SWIN_CHTYPE vert_bar_char;
+        int vert_bar_attr;
+        int mc;
+
+        if (draw->showmarks &&
+            ((mc = source_get_mark_char(sview, sview->cur, line)) > 0)) {
+            vert_bar_char = mc;
+            vert_bar_attr = draw->mark_attr;
+        } else if (is_exe_line && draw->exe_line_display_is_arrow) {
+            vert_bar_attr = draw->exe_arrow_attr;
+            vert_bar_char = SWIN_SYM_LTEE;
+        } else if (is_sel_line && draw->sel_line_display_is_arrow) {
+            vert_bar_attr = draw->sel_arrow_attr;
+            vert_bar_char = SWIN_SYM_LTEE;
+        } else {
+            vert_bar_attr = draw->focus_attr;
+            vert_bar_char = SWIN_SYM_VLINE;
+        }
+
+        swin_wattron(sview->win, vert_bar_attr);
+        swin_waddch(sview->win, vert_bar_char);
+        swin_wattroff(sview->win, vert_bar_attr);
+    }
+
+    /* Print the marker */
+    if (is_exe_line || is_sel_line) {
+        enum LineDisplayStyle display_style;
+        int arrow_attr, block_attr;
+        struct hl_line_attr *highlight_attr;
+
+        if (is_exe_line) {
+            display_style = draw->exe_display_style;
+            arrow_attr = draw->exe_arrow_attr;
+            block_attr = draw->exe_block_attr;
+            highlight_attr = draw->exe_highlight_attrs;
+        } else {
+            display_style = draw->sel_display_style;
+            arrow_attr = draw->sel_arrow_attr;
+            block_attr = draw->sel_block_attr;
+            highlight_attr = draw->sel_highlight_attrs;
+        }
+
+        switch (display_style) {
+            case LINE_DISPLAY_SHORT_ARROW:
+                swin_wattron(sview->win, arrow_attr);
+                swin_waddch(sview->win, '>');
+                swin_wattroff(sview->win, arrow_attr);
+                break;
+            case LINE_DISPLAY_LONG_ARROW:
+                swin_wattron(sview->win, arrow_attr);
+                column_offset = get_line_leading_ws_count(
+                    sline->line, sline->len);
+                column_offset -= (sview->cur->sel_col + 1);
+                if (column_offset < 0)
+                    column_offset = 0;
+
+                /* Now actually draw the arrow */
+                for (int j = 0; j < column_offset; j++)
+                    swin_waddch(sview->win, SWIN_SYM_HLINE);
+
+                swin_waddch(sview->win, '>');
+                swin_wattroff(sview->win, arrow_attr);
+
+                break;
+            case LINE_DISPLAY_HIGHLIGHT:
+                swin_waddch(sview->win, ' ');
+                printline_attrs = highlight_attr;
+                break;
+            case LINE_DISPLAY_BLOCK:
+                column_offset = get_line_leading_ws_count(
+                    sline->line, sline->len);
+                column_offset -= (sview->cur->sel_col + 1);
+                if (column_offset < 0)
+                    column_offset = 0;
+
+                /* Now actually draw the space to the block */
+                for (int j = 0; j < column_offset; j++)
+                    swin_waddch(sview->win, ' ');
+
+                /* Draw the block */
+                swin_wattron(sview->win, block_attr);
+                swin_waddch(sview->win, ' ');
+                swin_wattroff(sview->win, block_attr);
+                break;
+        }
+    } else {
+        swin_waddch(sview->win, ' ');
+    }
+
+
+    /* Print the text */
+    if (line < 0 || line >= draw->count) {
+        for (int j = 2 + draw->lwidth; j < draw->width; j++)
+            swin_waddch(sview->win, ' ');
+    } else {
+        int x, y;
+        y = swin_getcury(sview->win);
+        x = swin_getcurx(sview->win);
+
+        hl_printline(sview->win, sline->line, sline->len,
+            printline_attrs, -1, -1, sview->cur->sel_col + column_offset,
+            draw->width - draw->lwidth - 2);
+
+        // if highlight search is on
+        //   display the last successful search
+        //   unless we are starting a new search
+        if (draw->do_hlsearch && sview->last_hlregex && !sview->hlregex) {
+            struct hl_line_attr *attrs = source_get_search_attrs(
+                    &sview->last_hlregex, sline);
+            if (sbcount(attrs)) {
+                hl_printline_highlight(sview->win, sline->line, sline->len,
+                    attrs, x, y, sview->cur->sel_col + column_offset,
+                    draw->width - draw->lwidth - 2);
+            }
+        }
+
+        // if highlight search is on
+        //   display the current search
+        if (draw->do_hlsearch && sview->hlregex) {
+            struct hl_line_attr *attrs = source_get_search_attrs(
+                    &sview->hlregex, sline);
+            if (sbcount(attrs)) {
+                hl_printline_highlight(sview->win, sline->line, sline->len,
+                    attrs, x, y, sview->cur->sel_col + column_offset,
+                    draw->width - draw->lwidth - 2);
+            }
+        }
+
+
+        // if the currently line being displayed is the selected line
+        //   display the current search as an incremental search
+        if (is_sel_line && sview->hlregex) {
+            struct hl_line_attr *attrs = hl_regex_highlight(
+                    &sview->hlregex, sline->line, HLG_INCSEARCH);
+            if (sbcount(attrs)) {
+                hl_printline_highlight(sview->win, sline->line, sline->len,
+                    attrs, x, y, sview->cur->sel_col + column_offset,
+                    draw->width - draw->lwidth - 2);
+                sbfree(attrs);
+            }
+        }
+    }
+}
+
+/**
  * Display the source.
  *
  * A line in the source viewer looks like,
@@ -801,30 +1689,18 @@ int source_display(struct sviewer *sview, int focus,
     enum win_refresh dorefresh, int no_hlsearch)
 {
     int i;
-    int lwidth;
     int line;
-    int count;
-
-    enum LineDisplayStyle exe_display_style, sel_display_style;
-    int sellineno, exelineno;
-    int enabled_bp, disabled_bp;
-    int exe_line_display_is_arrow, sel_line_display_is_arrow;
-    int exe_arrow_attr, sel_arrow_attr;
-    int exe_block_attr, sel_block_attr;
-    char fmt[16];
-    int width, height;
-    int focus_attr = focus ? SWIN_A_BOLD : 0;
-    int showmarks = cgdbrc_get_int(CGDBRC_SHOWMARKS);
+    int height;
+    int delta = 0;
+    int scroll;
     int hlsearch = cgdbrc_get_int(CGDBRC_HLSEARCH);
-    int mark_attr;
-    int do_hlsearch = hlsearch && !no_hlsearch;
-
-    struct hl_line_attr *sel_highlight_attrs = 0;
-    struct hl_line_attr *exe_highlight_attrs = 0;
+    struct source_draw draw;
+    struct sviewer_display *shown = &sview->shown;
 
     /* Check that a file is loaded */
     if (!sview->cur || !sview->cur->file_buf.lines) {
         logo_display(sview->win);
+        shown->node = NULL;
 
         if (dorefresh == WIN_REFRESH)
             swin_wrefresh(sview->win);
@@ -834,260 +1710,132 @@ int source_display(struct sviewer *sview, int focus,
         return 0;
     }
 
-    sellineno = hl_groups_get_attr(
+    draw.focus_attr = focus ? SWIN_A_BOLD : 0;
+    draw.showmarks = cgdbrc_get_int(CGDBRC_SHOWMARKS);
+    draw.do_hlsearch = hlsearch && !no_hlsearch;
+
+    draw.sellineno = hl_groups_get_attr(
         hl_groups_instance, HLG_SELECTED_LINE_NUMBER);
-    exelineno = hl_groups_get_attr(
+    draw.exelineno = hl_groups_get_attr(
         hl_groups_instance, HLG_EXECUTING_LINE_NUMBER);
-    enabled_bp = hl_groups_get_attr(
+    draw.enabled_bp = hl_groups_get_attr(
         hl_groups_instance, HLG_ENABLED_BREAKPOINT);
-    disabled_bp = hl_groups_get_attr(
+    draw.disabled_bp = hl_groups_get_attr(
         hl_groups_instance, HLG_DISABLED_BREAKPOINT);
 
-    exe_display_style = cgdbrc_get_displaystyle(CGDBRC_EXECUTING_LINE_DISPLAY);
-    exe_arrow_attr = hl_groups_get_attr(
+    draw.exe_display_style =
+        cgdbrc_get_displaystyle(CGDBRC_EXECUTING_LINE_DISPLAY);
+    draw.exe_arrow_attr = hl_groups_get_attr(
         hl_groups_instance, HLG_EXECUTING_LINE_ARROW);
-    exe_block_attr = hl_groups_get_attr(
+    draw.exe_block_attr = hl_groups_get_attr(
         hl_groups_instance, HLG_EXECUTING_LINE_BLOCK);
 
-    sel_display_style = cgdbrc_get_displaystyle(CGDBRC_SELECTED_LINE_DISPLAY);
-    sel_arrow_attr = hl_groups_get_attr(
+    draw.sel_display_style =
+        cgdbrc_get_displaystyle(CGDBRC_SELECTED_LINE_DISPLAY);
+    draw.sel_arrow_attr = hl_groups_get_attr(
         hl_groups_instance, HLG_SELECTED_LINE_ARROW);
-    sel_block_attr = hl_groups_get_attr(
+    draw.sel_block_attr = hl_groups_get_attr(
         hl_groups_instance, HLG_SELECTED_LINE_BLOCK);
 
-    exe_line_display_is_arrow =
-        exe_display_style == LINE_DISPLAY_SHORT_ARROW ||
-        exe_display_style == LINE_DISPLAY_LONG_ARROW;
-    sel_line_display_is_arrow = 
-        sel_display_style == LINE_DISPLAY_SHORT_ARROW ||
-        sel_display_style == LINE_DISPLAY_LONG_ARROW;
+    draw.exe_line_display_is_arrow =
+        draw.exe_display_style == LINE_DISPLAY_SHORT_ARROW ||
+        draw.exe_display_style == LINE_DISPLAY_LONG_ARROW;
+    draw.sel_line_display_is_arrow =
+        draw.sel_display_style == LINE_DISPLAY_SHORT_ARROW ||
+        draw.sel_display_style == LINE_DISPLAY_LONG_ARROW;
 
-    mark_attr = hl_groups_get_attr(hl_groups_instance, HLG_MARK);
+    draw.mark_attr = hl_groups_get_attr(hl_groups_instance, HLG_MARK);
+
+    draw.sel_highlight_attrs = 0;
+    draw.exe_highlight_attrs = 0;
+    sbpush(draw.sel_highlight_attrs,
+        hl_line_attr(0, HLG_SELECTED_LINE_HIGHLIGHT));
+    sbpush(draw.exe_highlight_attrs,
+        hl_line_attr(0, HLG_EXECUTING_LINE_HIGHLIGHT));
 
-    sbpush(sel_highlight_attrs, hl_line_attr(0, HLG_SELECTED_LINE_HIGHLIGHT));
-    sbpush(exe_highlight_attrs, hl_line_attr(0, HLG_EXECUTING_LINE_HIGHLIGHT));
-    
     /* Make sure cursor is visible */
     swin_curs_set(!!focus);
 
     /* Initialize variables */
     height = swin_getmaxy(sview->win);
-    width = swin_getmaxx(sview->win);
+    draw.width = swin_getmaxx(sview->win);
 
     /* Set starting line number (center source file if it's small enough) */
-    count = sbcount(sview->cur->file_buf.lines);
-    if (count < height) {
-        line = (count - height) / 2;
+    draw.count = sbcount(sview->cur->file_buf.lines);
+    if (draw.count < height) {
+        line = (draw.count - height) / 2;
     } else {
         line = sview->cur->sel_line - height / 2;
-        if (line > count - height)
-            line = count - height;
+        if (line > draw.count - height)
+            line = draw.count - height;
         else if (line < 0)
             line = 0;
     }
 
     /* Print 'height' lines of the file, starting at 'line' */
-    lwidth = log10_uint(count) + 1;
-    snprintf(fmt, sizeof(fmt), "%%%dd", lwidth);
-
-    for (i = 0; i < height; i++, line++) {
-
-        int column_offset = 0;
-        /* Is this the current selected line? */
-        int is_sel_line = (line >= 0 && sview->cur->sel_line == line);
-        /* Is this the current executing line */
-        int is_exe_line = (line >= 0 && sview->cur->exe_line == line);
-        struct source_line *sline = (line < 0 || line >= count)?
-            NULL:&sview->cur->file_buf.lines[line];
-        struct hl_line_attr *printline_attrs = (sline)?sline->attrs:0;
-
-        swin_wmove(sview->win, i, 0);
-
-        /* Print the line number */
-        if (line < 0 || line >= count) {
-            for (int j = 1; j < lwidth; j++)
-                swin_waddch(sview->win, ' ');
-            swin_waddch(sview->win, '~');
-        } else {
-            int line_attr = 0;
-            switch (sview->cur->lflags[line].breakpt)
-            {
-                case line_flags::breakpt_status::enabled:
-                    line_attr = enabled_bp;
-                    break;
-                case line_flags::breakpt_status::disabled:
-                    line_attr = disabled_bp;
-                    break;
-                case line_flags::breakpt_status::none:
-                    if (is_exe_line)
-                        line_attr = exelineno;
-                    else if (is_sel_line)
-                        line_attr = sellineno;
-                    break;
-            }
-
-            swin_wattron(sview->win, line_attr);
-            swin_wprintw(sview->win, fmt, line + 1);
-            swin_wattroff(sview->win, line_attr);
-        }
-
-        if (!swin_has_colors()) {
-            /* TODO:
-            swin_wprintw(sview->win, "%.*s\n",
-                    sview->cur->file_buf.lines[line].line,
-                    sview->cur->file_buf.lines[line].len);
-            */
-            continue;
-        }
-
-        /* Print the vertical bar or mark */
-        {
-            SWIN_CHTYPE vert_bar_char;
-            int vert_bar_attr;
-            int mc;
-
-            if (showmarks &&
-                ((mc = source_get_mark_char(sview, sview->cur, line)) > 0)) {
-                vert_bar_char = mc;
-                vert_bar_attr = mark_attr;
-            } else if (is_exe_line && exe_line_display_is_arrow) {
-                vert_bar_attr = exe_arrow_attr;
-                vert_bar_char = SWIN_SYM_LTEE;
-            } else if (is_sel_line && sel_line_display_is_arrow) {
-                vert_bar_attr = sel_arrow_attr;
-                vert_bar_char = SWIN_SYM_LTEE;
-            } else {
-                vert_bar_attr = focus_attr;
-                vert_bar_char = SWIN_SYM_VLINE;
-            }
-
-            swin_wattron(sview->win, vert_bar_attr);
-            swin_waddch(sview->win, vert_bar_char);
-            swin_wattroff(sview->win, vert_bar_attr);
-        }
-
-        /* Print the marker */
-        if (is_exe_line || is_sel_line) {
-            enum LineDisplayStyle display_style;
-            int arrow_attr, block_attr;
-            struct hl_line_attr *highlight_attr;
-
-            if (is_exe_line) {
-                display_style = exe_display_style;
-                arrow_attr = exe_arrow_attr;
-                block_attr = exe_block_attr;
-                highlight_attr = exe_highlight_attrs;
-            } else {
-                display_style = sel_display_style;
-                arrow_attr = sel_arrow_attr;
-                block_attr = sel_block_attr;
-                highlight_attr = sel_highlight_attrs;
-            }
-
-            switch (display_style) {
-                case LINE_DISPLAY_SHORT_ARROW:
-                    swin_wattron(sview->win, arrow_attr);
-                    swin_waddch(sview->win, '>');
-                    swin_wattroff(sview->win, arrow_attr);
-                    break;
-                case LINE_DISPLAY_LONG_ARROW:
-                    swin_wattron(sview->win, arrow_attr);
-                    column_offset = get_line_leading_ws_count(
-                        sline->line, sline->len);
-                    column_offset -= (sview->cur->sel_col + 1);
-                    if (column_offset < 0)
-                        column_offset = 0;
-
-                    /* Now actually draw the arrow */
-                    for (int j = 0; j < column_offset; j++)
-                        swin_waddch(sview->win, SWIN_SYM_HLINE);
+    draw.lwidth = log10_uint(draw.count) + 1;
+    snprintf(draw.fmt, sizeof(draw.fmt), "%%%dd", draw.lwidth);
+
+    /* If nothing but the selected and executing lines changed since the
+     * window was last drawn, and the view moved by less than a window,
+     * scroll what's already there and only draw the rows that changed.
+     * With idlok, curses scrolls the terminal instead of sending every
+     * row again. */
+    scroll = shown->node == sview->cur &&
+        shown->generation == sview->cur->file_buf.generation &&
+        shown->count == draw.count &&
+        shown->language == sview->cur->file_buf.language &&
+        shown->height == height &&
+        shown->width == draw.width &&
+        shown->sel_col == sview->cur->sel_col &&
+        shown->focus == !!focus &&
+        shown->do_hlsearch == draw.do_hlsearch &&
+        shown->hlregex == hl_regex_generation(sview->hlregex) &&
+        shown->last_hlregex == hl_regex_generation(sview->last_hlregex);
+
+    if (scroll) {
+        delta = line - shown->top;
+        scroll = delta > -height && delta < height;
+    }
 
-                    swin_waddch(sview->win, '>');
-                    swin_wattroff(sview->win, arrow_attr);
+    if (scroll && delta) {
+        /* Only allow scrolling while scrolling, writing to the last
+         * column of the last row would scroll the window otherwise */
+        swin_scrollok(sview->win, 1);
+        swin_wscrl(sview->win, delta);
+        swin_scrollok(sview->win, 0);
+    }
 
-                    break;
-                case LINE_DISPLAY_HIGHLIGHT:
-                    swin_waddch(sview->win, ' ');
-                    printline_attrs = highlight_attr;
-                    break;
-                case LINE_DISPLAY_BLOCK:
-                    column_offset = get_line_leading_ws_count(
-                        sline->line, sline->len);
-                    column_offset -= (sview->cur->sel_col + 1);
-                    if (column_offset < 0)
-                        column_offset = 0;
-
-                    /* Now actually draw the space to the block */
-                    for (int j = 0; j < column_offset; j++)
-                        swin_waddch(sview->win, ' ');
-
-                    /* Draw the block */
-                    swin_wattron(sview->win, block_attr);
-                    swin_waddch(sview->win, ' ');
-                    swin_wattroff(sview->win, block_attr);
-                    break;
-            }
-        } else {
-            swin_waddch(sview->win, ' ');
+    for (i = 0; i < height; i++, line++) {
+        if (scroll) {
+            /* Rows that scrolled into view, and the rows of the
+             * selected and executing lines before and after */
+            int exposed = delta > 0 ? i >= height - delta : i < -delta;
+
+            if (!exposed && line != sview->cur->sel_line &&
+                line != shown->sel_line && line != sview->cur->exe_line &&
+                line != shown->exe_line)
+                continue;
         }
 
-
-        /* Print the text */
-        if (line < 0 || line >= count) {
-            for (int j = 2 + lwidth; j < width; j++)
-                swin_waddch(sview->win, ' ');
-        } else {
-            int x, y;
-            y = swin_getcury(sview->win);
-            x = swin_getcurx(sview->win);
-
-            hl_printline(sview->win, sline->line, sline->len,
-                printline_attrs, -1, -1, sview->cur->sel_col + column_offset,
-                width - lwidth - 2);
-
-            // if highlight search is on
-            //   display the last successful search
-            //   unless we are starting a new search
-            if (do_hlsearch && sview->last_hlregex && !sview->hlregex) {
-                struct hl_line_attr *attrs = hl_regex_highlight(
-                        &sview->last_hlregex, sline->line, HLG_SEARCH);
-                if (sbcount(attrs)) {
-                    hl_printline_highlight(sview->win, sline->line, sline->len,
-                        attrs, x, y, sview->cur->sel_col + column_offset,
-                        width - lwidth - 2);
-                    sbfree(attrs);
-                }
-            }
-
-            // if highlight search is on
-            //   display the current search
-            if (do_hlsearch && sview->hlregex) {
-                struct hl_line_attr *attrs = hl_regex_highlight(
-                        &sview->hlregex, sline->line, HLG_SEARCH);
-                if (sbcount(attrs)) {
-                    hl_printline_highlight(sview->win, sline->line, sline->len,
-                        attrs, x, y, sview->cur->sel_col + column_offset,
-                        width - lwidth - 2);
-                    sbfree(attrs);
-                }
-            }
-
-
-            // if the currently line being displayed is the selected line
-            //   display the current search as an incremental search
-            if (is_sel_line && sview->hlregex) {
-                struct hl_line_attr *attrs = hl_regex_highlight(
-                        &sview->hlregex, sline->line, HLG_INCSEARCH);
-                if (sbcount(attrs)) {
-                    hl_printline_highlight(sview->win, sline->line, sline->len,
-                        attrs, x, y, sview->cur->sel_col + column_offset,
-                        width - lwidth - 2);
-                    sbfree(attrs);
-                }
-            }
-        }
+        source_display_line(sview, &draw, i, line);
     }
 
+    shown->node = sview->cur;
+    shown->generation = sview->cur->file_buf.generation;
+    shown->count = draw.count;
+    shown->language = sview->cur->file_buf.language;
+    shown->top = line - height;
+    shown->height = height;
+    shown->width = draw.width;
+    shown->sel_line = sview->cur->sel_line;
+    shown->sel_col = sview->cur->sel_col;
+    shown->exe_line = sview->cur->exe_line;
+    shown->focus = !!focus;
+    shown->do_hlsearch = draw.do_hlsearch;
+    shown->hlregex = hl_regex_generation(sview->hlregex);
+    shown->last_hlregex = hl_regex_generation(sview->last_hlregex);
+
     switch(dorefresh) {
         case WIN_NO_REFRESH:
             swin_wnoutrefresh(sview->win);
@@ -1097,8 +1845,8 @@ int source_display(struct sviewer *sview, int focus,
             break;
     }
 
-    sbfree(sel_highlight_attrs);
-    sbfree(exe_highlight_attrs);
+    sbfree(draw.sel_highlight_attrs);
+    sbfree(draw.exe_highlight_attrs);
 
     return 0;
 }
@@ -1107,6 +1855,14 @@ void source_move(struct sviewer *sview, SWINDOW *win)
 {
     swin_delwin(sview->win);
     sview->win = win;
+
+    swin_idlok(win, 1);
+    source_redraw(sview);
+}
+
+void source_redraw(struct sviewer *sview)
+{
+    sview->shown.node = NULL;
 }
 
 static int clamp_line(struct sviewer *sview, int line)
@@ -1215,6 +1971,9 @@ int source_set_exec_line(struct sviewer *sview, const char *path, int sel_line,
     if (load_file(sview->cur))
         return 4;
 
+    sview->cur->last_used = ++sview->use_clock;
+    source_trim(sview);
+
     /* Update line, if set */
     if (sel_line > 0)
         sview->cur->sel_line = clamp_line(sview, sel_line - 1);
@@ -1258,6 +2017,16 @@ void source_free(struct sviewer *sview)
     hl_regex_free(&sview->last_hlregex);
     sview->last_hlregex = NULL;
 
+    source_clear_matches(sview);
+
+    sbfree(sview->bp_nodes);
+    sview->bp_nodes = NULL;
+
+    if (sview->watch_fd != -1)
+        close(sview->watch_fd);
+    sbfree(sview->watches);
+    sview->watches = NULL;
+
     swin_delwin(sview->win);
     sview->win = NULL;
 
@@ -1354,13 +2123,49 @@ int source_search_regex(struct sviewer *sview,
 
 static void source_clear_breaks(struct sviewer *sview)
 {
-    struct list_node *node;
+    int i;
 
-    for (node = sview->list_head; node != NULL; node = node->next)
+    /* Only the files that have breakpoints need to be visited */
+    for (i = 0; i < sbcount(sview->bp_nodes); i++)
     {
+        struct list_node *node = sview->bp_nodes[i];
+
         for (auto& lf : node->lflags)
             lf.breakpt = line_flags::breakpt_status::none;
+
+        node->lflags.erase(std::remove_if(node->lflags.begin(),
+            node->lflags.end(),
+            [](const line_flags &lf) { return lf.marks.empty(); }),
+            node->lflags.end());
+    }
+
+    if (sview->bp_nodes)
+        sbsetcount(sview->bp_nodes, 0);
+}
+
+/* source_add_breakpoint:  Set the breakpoint status of a line.
+ * ----------------------
+ *
+ *   sview:    The source viewer object.
+ *   node:     The file the breakpoint is in.
+ *   line:     The line, 0-indexed.
+ *   enabled:  Whether the breakpoint is enabled.
+ */
+static void source_add_breakpoint(struct sviewer *sview,
+    struct list_node *node, int line, int enabled)
+{
+    int i;
+
+    for (i = 0; i < sbcount(sview->bp_nodes); i++) {
+        if (sview->bp_nodes[i] == node)
+            break;
     }
+    if (i == sbcount(sview->bp_nodes))
+        sbpush(sview->bp_nodes, node);
+
+    source_get_line_flags(node, line).breakpt = enabled
+        ? line_flags::breakpt_status::enabled
+        : line_flags::breakpt_status::disabled;
 }
 
 void source_set_breakpoints(struct sviewer *sview,
@@ -1370,62 +2175,83 @@ void source_set_breakpoints(struct sviewer *sview,
     struct list_node *node;
 
     source_clear_breaks(sview);
+    source_redraw(sview);
 
     // Loop over each breakpoint and let the source view and the 
     // disassembly view know about them. This way if you set a breakpoint
     // in one mode, then switch modes, the other mode will know about
     // it as well.
+    //
+    // The file doesn't need to be loaded, lines past the end of the
+    // file are never displayed.
     for (i = 0; i < sbcount(breakpoints); i++) {
         if (breakpoints[i].path) {
             node = source_get_node(sview, breakpoints[i].path);
-            if (!load_file(node)) {
-                int line = breakpoints[i].line;
-                int enabled = breakpoints[i].enabled;
-                if (line > 0 && line <= node->lflags.size()) {
-                    node->lflags[line - 1].breakpt = enabled
-                        ? line_flags::breakpt_status::enabled
-                        : line_flags::breakpt_status::disabled;
-                }
+            if (node && breakpoints[i].line > 0) {
+                source_add_breakpoint(sview, node, breakpoints[i].line - 1,
+                    breakpoints[i].enabled);
             }
         }
         if (breakpoints[i].addr) {
             int line = 0;
             node = source_get_asmnode(sview, breakpoints[i].addr, &line);
-            if (node) {
-                node->lflags[line].breakpt = breakpoints[i].enabled
-                    ? line_flags::breakpt_status::enabled
-                    : line_flags::breakpt_status::disabled;
-            }
+            if (node)
+                source_add_breakpoint(sview, node, line, breakpoints[i].enabled);
         }
     }
 }
 
+line_flags::breakpt_status source_get_breakpoint(struct list_node *node,
+        int line)
+{
+    std::vector<line_flags>::iterator iter;
+
+    if (!node)
+        return line_flags::breakpt_status::none;
+
+    iter = source_find_line_flags(node, line);
+    if (iter == node->lflags.end() || iter->line != line)
+        return line_flags::breakpt_status::none;
+
+    return iter->breakpt;
+}
+
 int source_reload(struct sviewer *sview, const char *path, int force)
 {
     time_t timestamp;
     struct list_node *cur;
-    struct list_node *prev = NULL;
     int auto_source_reload = cgdbrc_get_int(CGDBRC_AUTOSOURCERELOAD);
+    int changed = 0;
+    int dirty;
 
     if (!path)
         return -1;
 
-    if (get_timestamp(path, &timestamp) == -1)
-        return -1;
-
     /* Find the target node */
     for (cur = sview->list_head; cur != NULL; cur = cur->next) {
         if (strcmp(path, cur->path) == 0)
             break;
-        prev = cur;
     }
 
-    if (cur == NULL)
-        return 1;               /* Node not found */
+    if (cur == NULL) {
+        /* Node not found, let the caller know if the file exists */
+        if (get_timestamp(path, &timestamp) == -1)
+            return -1;
+        return 1;
+    }
+
+    /* A loaded file in a watched directory only needs to be looked at
+     * after the watcher saw it change. */
+    if (force || cur->watch_wd == -1 || cur->watch_changed ||
+            !cur->file_buf.lines) {
+        if (get_timestamp(path, &timestamp) == -1)
+            return -1;
+
+        changed = cur->last_modification < timestamp;
+    }
 
     /* If the file timestamp or tab size changed, reload the file */
-    int dirty = cur->last_modification < timestamp;
-    dirty |= cgdbrc_get_int(CGDBRC_TABSTOP) != cur->file_buf.tabstop;
+    dirty = changed || cgdbrc_get_int(CGDBRC_TABSTOP) != cur->file_buf.tabstop;
 
     if ((auto_source_reload || force) && dirty) {
 
@@ -1434,7 +2260,13 @@ int source_reload(struct sviewer *sview, const char *path, int force)
 
         if (load_file(cur))
             return -1;
+
+        changed = 0;
     }
 
+    /* Keep checking a changed file until it is reloaded */
+    if (!changed)
+        cur->watch_changed = 0;
+
     return 0;
 }
@@ -3,11 +3,10 @@
  * 
  * Source file management routines for the GUI.  Provides the ability to
  * add files to the list, load files, and display within a curses window.
- * Files are buffered in memory when they are displayed, and held in
- * memory for the duration of execution.  If memory consumption becomes a
- * problem, this can be optimized to unload files which have not been
- * displayed recently, or only load portions of large files at once. (May
- * affect syntax highlighting.)
+ * Files are buffered in memory when they are displayed. When the loaded
+ * files use more memory than the sourcememory option allows, the files
+ * shown the longest time ago are released, see source_trim.  Their marks,
+ * breakpoints and positions are kept, so they load again transparently.
  *
  */
 
@@ -15,8 +14,8 @@
 #define _SOURCES_H_
 
 #include "sys_win.h"
-#include <deque>
 #include <list>
+#include <vector>
 
 /* ----------- */
 /* Definitions */
@@ -38,6 +37,33 @@ struct sviewer_mark {
     int line;
 };
 
+/* A line matched by source_grep */
+struct sviewer_match {
+    struct list_node *node;
+    int line;
+    char *text;
+};
+
+/* A directory watched for changes to source files */
+struct sviewer_watch {
+    int wd;                             /* inotify watch descriptor */
+    int files;                          /* Files watched in the directory */
+};
+
+/* What source_display last drew in the window */
+struct sviewer_display {
+    struct list_node *node;             /* The file drawn, NULL to redraw */
+    unsigned long generation;           /* Of the file drawn's buffer */
+    int count;                          /* And how many there were */
+    enum tokenizer_language_support language; /* Their highlighting */
+    int top;                            /* The line in the first row */
+    int height, width;                  /* The size of the window */
+    int sel_line, sel_col, exe_line;    /* The selected and executing lines */
+    int focus, do_hlsearch;
+    unsigned long hlregex;              /* The generations of the searches */
+    unsigned long last_hlregex;
+};
+
 /* Source viewer object */
 struct sviewer {
     struct list_node *list_head;           /* File list */
@@ -45,8 +71,16 @@ struct sviewer {
     struct list_node *cur_exe;             /* Current node we're executing */
     sviewer_mark global_marks[MARK_COUNT]; /* Global A-Z marks */
     sviewer_mark jump_back_mark;           /* Location where last jump occurred from */
+    struct sviewer_match *matches;         /* Quickfix list from :grep */
+    int cur_match;                         /* Current match, -1 if none */
+    struct list_node **bp_nodes;           /* Files with breakpoints */
+
+    int watch_fd;                          /* inotify descriptor, or -1 */
+    struct sviewer_watch *watches;         /* Watched directories */
 
     SWINDOW *win;                          /* Curses window */
+    struct sviewer_display shown;          /* What the window shows */
+    unsigned long use_clock;               /* Ticks when a file is used */
     uint64_t addr_frame;                   /* Current frame address 
                                               Zero if unknown. */
     /**
@@ -73,6 +107,12 @@ struct source_line {
     char *line;
     int len;
     struct hl_line_attr *attrs;
+
+    /* The matches of a search on this line, used for hlsearch.
+     * Computed when the line is displayed, and only valid while
+     * search_generation is the generation of the regex searched for. */
+    struct hl_line_attr *search_attrs;
+    unsigned long search_generation;
 };
 
 struct buffer {
@@ -82,10 +122,14 @@ struct buffer {
     char *file_data;            /* Entire file pointer if read in that way */
     int tabstop;                /* Tabstop value used to load file */
     enum tokenizer_language_support language;   /* The language type of this file */
+    size_t bytes;               /* Memory used by the buffer, roughly */
+    unsigned long generation;   /* Bumped each time the lines are freed */
 };
 
+/* The breakpoint and marks on a single line */
 struct line_flags {
     enum class breakpt_status{ none, enabled, disabled };
+    int line;                       /* The line, 0-indexed */
     breakpt_status breakpt = breakpt_status::none;
     std::list<unsigned char> marks;
 };
@@ -93,7 +137,7 @@ struct line_flags {
 struct list_node {
     char *path;                    /* Full path to source file */
     struct buffer file_buf;        /* File buffer */
-    std::deque<line_flags> lflags; /* Breakpoints */
+    std::vector<line_flags> lflags;/* Lines with a breakpoint or mark, sorted */
     int sel_line;                  /* Current line selected in viewer */
     int sel_col;                   /* Current column selected in viewer */
     int exe_line;                  /* Current line executing, or -1 if not set */
@@ -102,8 +146,11 @@ struct list_node {
     enum tokenizer_language_support language;   /* The language type of this file */
 
     time_t last_modification;   /* timestamp of last modification */
+    int watch_wd;               /* Watch on the file's directory, or -1 */
+    int watch_changed;          /* File may have changed since last checked */
 
     int local_marks[MARK_COUNT];/* Line numbers for local (a..z) marks */
+    unsigned long last_used;    /* sview->use_clock when last used */
 
     uint64_t addr_start;        /* Disassembly start address */
     uint64_t addr_end;          /* Disassembly end address */
@@ -150,6 +197,20 @@ struct list_node *source_get_node(struct sviewer *sview, const char *path);
  */
 int source_del(struct sviewer *sview, const char *path);
 
+/* source_preload:  Load a source file without showing it.
+ * ---------------
+ *
+ * The file is added to the list if it isn't there yet, then loaded and
+ * highlighted, so showing it later is instant.
+ *
+ *   sview:  Source viewer object
+ *   path:   Full path to the source file
+ *
+ * Return Value:  0 if the file was loaded, 1 if it was loaded already, or
+ *                -1 on error.
+ */
+int source_preload(struct sviewer *sview, const char *path);
+
 /* source_length:  Get the length of a source file.  If the source file hasn't
  * --------------  been buffered already, it will be loaded into memory.
  *
@@ -170,6 +231,17 @@ int source_length(struct sviewer *sview, const char *path);
  */
 char *source_current_file(struct sviewer *sview);
 
+/* source_redraw:  Redraw the whole window on the next source_display.
+ * --------------
+ *
+ *   sview:  Source viewer object
+ *
+ * source_display only redraws the rows that changed when the selected or
+ * executing line moves. Call this when anything else drawn may have
+ * changed, like the highlighting colors or display options.
+ */
+void source_redraw(struct sviewer *sview);
+
 /* source_display:  Display a portion of a file in a curses window.
  * ---------------
  *
@@ -292,6 +364,21 @@ void source_free(struct sviewer *sview);
 void source_set_breakpoints(struct sviewer *sview,
         struct tgdb_breakpoint *breakpoints);
 
+/**
+ * Get the breakpoint status of a line.
+ *
+ * @param node
+ * The file to check
+ *
+ * @param line
+ * The line to check, 0-indexed
+ *
+ * @return
+ * The status of the breakpoint on the line, none if there isn't one.
+ */
+line_flags::breakpt_status source_get_breakpoint(struct list_node *node,
+        int line);
+
 /**
  * Check's to see if the current source file has changed. If it has it loads
  * the new source file up.
@@ -310,6 +397,60 @@ void source_set_breakpoints(struct sviewer *sview,
  */
 int source_reload(struct sviewer *sview, const char *path, int force);
 
+/* source_watch_fd:  Get the descriptor reporting changes to source files.
+ * ----------------
+ *
+ * The directories of the source files are watched with inotify, so
+ * source_reload only has to check the files that changed. When this
+ * descriptor is readable, source_watch_process should be called.
+ *
+ *   sview:  The source viewer object
+ *   return: The descriptor, or -1 if files are not watched
+ */
+int source_watch_fd(struct sviewer *sview);
+
+/* source_watch_process:  Read the pending file change notifications.
+ * ---------------------
+ *
+ * The changed files are only marked, they are reloaded by source_reload.
+ *
+ *   sview:  The source viewer object
+ *   return: The number of loaded files marked as changed
+ */
+int source_watch_process(struct sviewer *sview);
+
+/* source_watch_counts:  Get the number of watched directories and files.
+ * --------------------
+ *
+ *   sview:  The source viewer object
+ *   dirs:   Set to the number of directories watched
+ *   files:  Set to the number of files watched
+ */
+void source_watch_counts(struct sviewer *sview, int *dirs, int *files);
+
+/* source_trim:  Release the files used the longest time ago.
+ * ------------
+ *
+ * Loaded files are released until they fit in the sourcememory option.
+ * The file shown is never released, nor is disassembly, which can't be
+ * read again from disk.
+ *
+ *   sview:  The source viewer object, or NULL if there is none yet
+ *   return: The number of files released
+ */
+int source_trim(struct sviewer *sview);
+
+/* source_memory_usage:  Get the memory used by the loaded files.
+ * --------------------
+ *
+ *   sview:  The source viewer object
+ *   loaded: Set to the number of files loaded
+ *   files:  Set to the number of files in the list
+ *   bytes:  Set to the memory the loaded files use, roughly
+ */
+void source_memory_usage(struct sviewer *sview, int *loaded, int *files,
+        size_t *bytes);
+
 /* ----- */
 /* Marks */
 /* ----- */
@@ -332,4 +473,35 @@ int source_set_mark(struct sviewer *sview, int key);
  */
 int source_goto_mark(struct sviewer *sview, int key);
 
+/* ------- */
+/* Grep    */
+/* ------- */
+
+/* source_grep:  Search every source file for a regular expression.
+ * ------------
+ *
+ * The files are searched in parallel. The matching lines replace the
+ * quickfix list (sview->matches), sorted by file and line.
+ *
+ *   sview:  The source viewer object
+ *   regex:  The (extended) regular expression to search for
+ *   icase:  If 1, ignore case
+ *   load:   If 1, files that are not loaded are read from disk and searched
+ *           too, otherwise only the loaded files are searched
+ *   return: The number of matches, or -1 if regex is invalid
+ */
+int source_grep(struct sviewer *sview, const char *regex, int icase, int load);
+
+/* source_goto_match:  Goto a match in the quickfix list.
+ * ------------------
+ *
+ * Like source_goto_mark, the location jumped from is remembered in the
+ * jump back mark.
+ *
+ *   sview:  The source viewer object
+ *   offset: The match to go to, relative to the current match
+ *   return: 1 if a jump was successful, 0 otherwise
+ */
+int source_goto_match(struct sviewer *sview, int offset);
+
 #endif
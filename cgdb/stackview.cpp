@@ -0,0 +1,293 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif /* HAVE_STDIO_H */
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "tokenizer.h"
+#include "interface.h"
+#include "sources.h"
+#include "replies.h"
+#include "stackview.h"
+
+extern struct tgdb *tgdb;
+
+/* The frames counted by the first -stack-info-depth. Each time the user
+ * scrolls to the end of a capped count, the cap is doubled. */
+#define STACKVIEW_DEPTH_STEP 256
+
+struct stackview_frame {
+    bool loaded;            /* The frame has been fetched */
+    std::string text;       /* The row shown for the frame */
+    std::string path;       /* The file of the frame, empty if unknown */
+    int line;               /* The line in the file or 0 if unknown */
+};
+
+/* The frames of the stack, as many as were counted */
+static std::vector<stackview_frame> frames;
+
+/* The number of frames counted, or -1 if they haven't been counted */
+static int depth = -1;
+
+/* The cap of the last -stack-info-depth. If depth is the cap, there may
+ * be more frames. */
+static int max_depth = STACKVIEW_DEPTH_STEP;
+
+/* The -stack-info-depth and -stack-list-frames on their way */
+static struct replies depth_replies, frames_replies;
+
+/* The levels of the -stack-list-frames on its way, or -1 if none */
+static int pending_low = -1, pending_high = -1;
+
+/* gdb could not get the stack, it is not fetched again until it changes */
+static bool no_stack;
+
+/* The thread the frames belong to, or 0 if unknown */
+static int thread_id;
+
+static int stackview_count(void);
+static bool stackview_row(int row, std::string &text);
+static void stackview_status(std::string &text);
+static void stackview_fetch(int first, int last);
+static void stackview_select(int row);
+
+static struct infowin_view stackview = {
+    "Stack",
+    stackview_count,
+    stackview_row,
+    stackview_status,
+    stackview_fetch,
+    stackview_select
+};
+
+struct infowin_view *stackview_get(void)
+{
+    return &stackview;
+}
+
+static int stackview_count(void)
+{
+    return std::max(depth, 0);
+}
+
+static bool stackview_row(int row, std::string &text)
+{
+    if (row < 0 || row >= (int)frames.size() || !frames[row].loaded)
+        return false;
+
+    text = frames[row].text;
+    return true;
+}
+
+static void stackview_status(std::string &text)
+{
+    char buf[64];
+
+    if (no_stack) {
+        text = "no stack";
+    } else if (depth < 0) {
+        text = "counting frames";
+    } else {
+        snprintf(buf, sizeof(buf), "%d%s frames", depth,
+                depth == max_depth ? "+" : "");
+        text = buf;
+    }
+}
+
+/* The stack changed, count it again once it is shown */
+static void stackview_invalidate(void)
+{
+    replies_drop(&depth_replies);
+    replies_drop(&frames_replies);
+
+    std::vector<stackview_frame>().swap(frames);
+    depth = -1;
+    max_depth = STACKVIEW_DEPTH_STEP;
+    pending_low = pending_high = -1;
+    no_stack = false;
+}
+
+static void stackview_request_depth(int cap)
+{
+    max_depth = cap;
+    replies_expect(&depth_replies);
+    tgdb_request_stack_depth(tgdb, cap);
+}
+
+static bool stackview_missing(int row)
+{
+    return !frames[row].loaded;
+}
+
+static void stackview_fetch(int first, int last)
+{
+    int margin = (last - first + 1) / 2;
+
+    if (no_stack || replies_waiting(&depth_replies))
+        return;
+
+    if (depth < 0) {
+        stackview_request_depth(max_depth);
+        return;
+    }
+
+    /* Count further as the user nears the end of a capped count */
+    if (depth == max_depth && last + margin >= depth)
+        stackview_request_depth(max_depth * 2);
+
+    if (replies_waiting(&frames_replies) ||
+            !infowin_missing_rows(first, last, depth, stackview_missing,
+                &pending_low, &pending_high))
+        return;
+
+    replies_expect(&frames_replies);
+    tgdb_request_stack_frames(tgdb, pending_low, pending_high);
+}
+
+static void stackview_select(int row)
+{
+    struct sviewer *sview = if_get_sview();
+    stackview_frame &frame = frames[row];
+
+    if (!frame.loaded)
+        return;
+
+    tgdb_request_select_frame(tgdb, row);
+
+    /* Jump to the frame's line right away if the file can be shown,
+     * otherwise let gdb say where the frame is, which may show the
+     * disassembly instead */
+    if (!frame.path.empty() &&
+            source_reload(sview, frame.path.c_str(), 0) != -1) {
+        if_show_file(frame.path.c_str(), frame.line, frame.line);
+    } else {
+        tgdb_request_current_location(tgdb);
+    }
+}
+
+/* Format a frame like gdb's backtrace does */
+static std::string stackview_format(struct tgdb_frame *tf)
+{
+    char buf[64];
+    std::string text;
+
+    snprintf(buf, sizeof(buf), "#%-3d ", tf->level);
+    text = buf;
+
+    if (tf->addr && (tf->level != 0 || !tf->file)) {
+        snprintf(buf, sizeof(buf), "0x%016" PRIx64 " in ", tf->addr);
+        text.append(buf);
+    }
+
+    text.append(tf->func ? tf->func : "??");
+    text.append(" ()");
+
+    if (tf->file && tf->line) {
+        snprintf(buf, sizeof(buf), ":%d", tf->line);
+        text.append(" at ");
+        text.append(tf->file);
+        text.append(buf);
+    } else if (tf->from) {
+        text.append(" from ");
+        text.append(tf->from);
+    }
+
+    return text;
+}
+
+void stackview_update_depth(struct tgdb_response *response)
+{
+    if (!replies_receive(&depth_replies))
+        return;
+
+    if (response->choice.update_stack_depth.error) {
+        no_stack = true;
+        depth = 0;
+    } else {
+        depth = response->choice.update_stack_depth.depth;
+    }
+
+    frames.resize(depth);
+
+    if_info_changed(&stackview);
+}
+
+void stackview_update_frames(struct tgdb_response *response)
+{
+    struct tgdb_frame *tfs = response->choice.update_stack_frames.frames;
+    int i;
+
+    if (!replies_receive(&frames_replies))
+        return;
+
+    if (response->choice.update_stack_frames.error) {
+        no_stack = true;
+    } else {
+        for (i = 0; i < sbcount(tfs); i++) {
+            struct tgdb_frame *tf = &tfs[i];
+
+            if (tf->level < 0 || tf->level >= (int)frames.size())
+                continue;
+
+            stackview_frame &frame = frames[tf->level];
+            frame.loaded = true;
+            frame.text = stackview_format(tf);
+            frame.path = tf->fullname ? tf->fullname :
+                (tf->file ? tf->file : "");
+            frame.line = tf->line;
+        }
+
+        /* Show the frames gdb left out, rather than asking again */
+        for (i = pending_low; i <= pending_high; i++) {
+            if (i < (int)frames.size() && !frames[i].loaded) {
+                char buf[64];
+
+                snprintf(buf, sizeof(buf), "#%-3d <unavailable>", i);
+                frames[i].loaded = true;
+                frames[i].text = buf;
+            }
+        }
+    }
+
+    pending_low = pending_high = -1;
+
+    if_info_changed(&stackview);
+}
+
+void stackview_inferior_changed(struct tgdb_response *response)
+{
+    switch (response->header) {
+        case TGDB_INFERIOR_RUNNING:
+            stackview_invalidate();
+            break;
+        case TGDB_INFERIOR_STOPPED: {
+            int id = response->choice.inferior_stopped.thread_id;
+
+            /* Another thread has another stack */
+            if (id && id != thread_id) {
+                stackview_invalidate();
+                thread_id = id;
+            }
+            break;
+        }
+        case TGDB_INFERIOR_EXITED:
+            thread_id = 0;
+            stackview_invalidate();
+            break;
+        default:
+            return;
+    }
+
+    if_info_changed(&stackview);
+}
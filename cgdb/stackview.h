@@ -0,0 +1,39 @@
+// The stack view of the info window
+//
+// The view counts the frames with a capped -stack-info-depth and only gets
+// the frames that are on screen with -stack-list-frames, so a deep
+// recursion costs no more than a shallow stack. The frames are kept until
+// the inferior runs again.
+
+#ifndef _STACKVIEW_H_
+#define _STACKVIEW_H_
+
+#include "infowin.h"
+#include "tgdb.h"
+
+// Get the stack view, to show in the info window
+//
+// @return
+// The stack view
+struct infowin_view *stackview_get(void);
+
+// Handle a TGDB_UPDATE_STACK_DEPTH response
+//
+// @param response
+// The response from tgdb
+void stackview_update_depth(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_STACK_FRAMES response
+//
+// @param response
+// The response from tgdb
+void stackview_update_frames(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, the frames may be out of date
+//
+// @param response
+// The response from tgdb
+void stackview_inferior_changed(struct tgdb_response *response);
+
+#endif
@@ -0,0 +1,199 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif /* HAVE_STDIO_H */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+#include "sys_util.h"
+#include "tokenizer.h"
+#include "interface.h"
+#include "replies.h"
+#include "threadview.h"
+
+extern struct tgdb *tgdb;
+
+/* The details of the threads that were read, by thread number */
+static std::map<int, std::string> details;
+
+/* The -thread-info on their way, and the threads they are for unless
+ * they are stale */
+static struct replies info_replies;
+static std::set<int> pending;
+
+/* The selected thread, or 0 if unknown */
+static int current_thread;
+
+static int threadview_count(void);
+static bool threadview_row(int row, std::string &text);
+static void threadview_status(std::string &text);
+static void threadview_fetch(int first, int last);
+static void threadview_select(int row);
+
+static struct infowin_view threadview = {
+    "Threads",
+    threadview_count,
+    threadview_row,
+    threadview_status,
+    threadview_fetch,
+    threadview_select
+};
+
+struct infowin_view *threadview_get(void)
+{
+    return &threadview;
+}
+
+static int threadview_count(void)
+{
+    return tgdb_thread_count(tgdb);
+}
+
+static bool threadview_row(int row, std::string &text)
+{
+    int id = tgdb_thread_id(tgdb, row);
+    std::map<int, std::string>::iterator it = details.find(id);
+
+    if (it == details.end())
+        return false;
+
+    /* Mark the selected thread like info threads does */
+    text = (id == current_thread) ? "* " : "  ";
+    text.append(it->second);
+
+    return true;
+}
+
+static void threadview_status(std::string &text)
+{
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "%d threads", tgdb_thread_count(tgdb));
+    text = buf;
+}
+
+/* Forget the details, the threads moved on */
+static void threadview_invalidate(void)
+{
+    replies_drop(&info_replies);
+    pending.clear();
+    details.clear();
+}
+
+static void threadview_fetch(int first, int last)
+{
+    int i;
+
+    last = std::min(last, tgdb_thread_count(tgdb) - 1);
+
+    for (i = std::max(first, 0); i <= last; i++) {
+        int id = tgdb_thread_id(tgdb, i);
+
+        if (!details.count(id) && !pending.count(id)) {
+            pending.insert(id);
+            replies_expect(&info_replies);
+            tgdb_request_thread_info(tgdb, id);
+        }
+    }
+}
+
+static void threadview_select(int row)
+{
+    int id = tgdb_thread_id(tgdb, row);
+
+    if (id && !infowin_running())
+        tgdb_request_select_thread(tgdb, id);
+}
+
+/* Format a thread like info threads does */
+static std::string threadview_format(struct tgdb_thread *thread)
+{
+    char buf[64];
+    std::string text;
+
+    snprintf(buf, sizeof(buf), "%-4d ", thread->id);
+    text = buf;
+
+    text.append(thread->target_id ? thread->target_id : "?");
+
+    if (thread->name) {
+        text.append(" \"");
+        text.append(thread->name);
+        text.append("\"");
+    }
+
+    if (thread->running) {
+        text.append(" (running)");
+    } else if (thread->func) {
+        text.append(" in ");
+        text.append(thread->func);
+        text.append(" ()");
+
+        if (thread->file && thread->line) {
+            snprintf(buf, sizeof(buf), ":%d", thread->line);
+            text.append(" at ");
+            text.append(thread->file);
+            text.append(buf);
+        }
+    }
+
+    return text;
+}
+
+void threadview_threads_changed(struct tgdb_response *response)
+{
+    if (response->choice.threads_changed.exited)
+        details.erase(response->choice.threads_changed.thread_id);
+
+    if_info_changed(&threadview);
+}
+
+void threadview_update_thread_info(struct tgdb_response *response)
+{
+    struct tgdb_thread *thread = &response->choice.update_thread_info.thread;
+
+    if (!replies_receive(&info_replies))
+        return;
+
+    pending.erase(thread->id);
+
+    /* A thread that exited is gone from the list already */
+    if (response->choice.update_thread_info.error) {
+        char buf[64];
+
+        snprintf(buf, sizeof(buf), "%-4d <unknown>", thread->id);
+        details[thread->id] = buf;
+    } else {
+        details[thread->id] = threadview_format(thread);
+    }
+
+    if_info_changed(&threadview);
+}
+
+void threadview_inferior_changed(struct tgdb_response *response)
+{
+    switch (response->header) {
+        case TGDB_INFERIOR_RUNNING:
+            threadview_invalidate();
+            break;
+        case TGDB_INFERIOR_STOPPED:
+            /* The details were dropped when it ran */
+            if (response->choice.inferior_stopped.thread_id)
+                current_thread = response->choice.inferior_stopped.thread_id;
+            break;
+        case TGDB_INFERIOR_EXITED:
+            current_thread = 0;
+            threadview_invalidate();
+            break;
+        default:
+            return;
+    }
+
+    if_info_changed(&threadview);
+}
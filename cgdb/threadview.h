@@ -0,0 +1,39 @@
+// The threads view of the info window
+//
+// The view lists the threads tgdb knows from the =thread-created and
+// =thread-exited notifications, without ever asking gdb for all of them.
+// The details of a thread, like where it is, are read with -thread-info
+// only for the rows on screen.
+
+#ifndef _THREADVIEW_H_
+#define _THREADVIEW_H_
+
+#include "infowin.h"
+#include "tgdb.h"
+
+// Get the threads view, to show in the info window
+//
+// @return
+// The threads view
+struct infowin_view *threadview_get(void);
+
+// Handle a TGDB_THREADS_CHANGED response
+//
+// @param response
+// The response from tgdb
+void threadview_threads_changed(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_THREAD_INFO response
+//
+// @param response
+// The response from tgdb
+void threadview_update_thread_info(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, the details may be out of date
+//
+// @param response
+// The response from tgdb
+void threadview_inferior_changed(struct tgdb_response *response);
+
+#endif
@@ -0,0 +1,581 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif /* HAVE_STDIO_H */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "tokenizer.h"
+#include "interface.h"
+#include "replies.h"
+#include "varview.h"
+
+extern struct tgdb *tgdb;
+
+struct varview_node {
+    std::string name;       /* The name of the variable object in gdb */
+    std::string exp;        /* The expression or field shown */
+    std::string value;      /* The value, or why there is none */
+    std::string text;       /* The row shown, made when the value changes */
+    int numchild;           /* The children gdb has, as far as it knows */
+    bool has_more;          /* A pretty printed container may have more */
+    bool created;           /* The variable object exists in gdb */
+    bool expanded;          /* The children are shown */
+    int depth;              /* 0 for a watch or a local */
+
+    /* The children, NULL until they are fetched */
+    std::vector<varview_node *> children;
+};
+
+struct varview_entry {
+    varview_node *parent;   /* The node the row is a child of, or NULL */
+    int index;              /* The index of the row in its parent */
+    varview_node *node;     /* The node of the row, NULL until fetched */
+};
+
+/* The watch expressions and the locals of the selected frame */
+static std::vector<varview_node *> watches, locals;
+
+/* The nodes with a variable object in gdb, or on its way, by its name */
+static std::map<std::string, varview_node *> nodes;
+
+/* The rows shown, made again when a node is expanded or added */
+static std::vector<varview_entry> rows;
+static bool rows_valid;
+
+/* The number given to the last variable object made */
+static int last_id;
+
+/* The inferior stopped or another frame was selected since the last
+ * -var-update, it is sent when the view is shown */
+static bool need_update = true;
+
+/* The -stack-list-variables sent with each -var-update */
+static struct replies update_replies;
+
+/* The -var-list-children on their way, and the parent and first child
+ * of the one that isn't stale */
+static struct replies children_replies;
+static std::string children_pending;
+static int children_from;
+
+static int varview_count(void);
+static bool varview_row(int row, std::string &text);
+static void varview_fetch(int first, int last);
+static void varview_select(int row);
+
+static struct infowin_view varview = {
+    "Variables",
+    varview_count,
+    varview_row,
+    NULL,
+    varview_fetch,
+    varview_select
+};
+
+struct infowin_view *varview_get(void)
+{
+    return &varview;
+}
+
+static varview_node *varview_node_new(const std::string &exp, int depth)
+{
+    varview_node *node = new varview_node();
+
+    node->exp = exp;
+    node->numchild = 0;
+    node->has_more = false;
+    node->created = false;
+    node->expanded = false;
+    node->depth = depth;
+
+    return node;
+}
+
+/* Make the row shown for a node */
+static void varview_format(varview_node *node)
+{
+    node->text.assign(node->depth * 2, ' ');
+
+    if (node->numchild > 0 || node->has_more)
+        node->text.append(node->expanded ? "- " : "+ ");
+    else
+        node->text.append("  ");
+
+    node->text.append(node->exp);
+    node->text.append(" = ");
+    node->text.append(node->value);
+}
+
+/* Drop the children of a node, gdb deleted them or is told to */
+static void varview_forget_children(varview_node *node)
+{
+    size_t i;
+
+    /* The children on their way belong to the dropped ones */
+    if (!children_pending.empty() &&
+            (children_pending == node->name ||
+             children_pending.compare(0, node->name.size() + 1,
+                 node->name + ".") == 0)) {
+        replies_drop(&children_replies);
+        children_pending.clear();
+    }
+
+    for (i = 0; i < node->children.size(); i++) {
+        varview_node *child = node->children[i];
+
+        if (child) {
+            varview_forget_children(child);
+            nodes.erase(child->name);
+            delete child;
+        }
+    }
+
+    node->children.clear();
+    rows_valid = false;
+}
+
+/* Delete a watch or a local and its variable object */
+static void varview_delete(varview_node *node)
+{
+    std::map<std::string, varview_node *>::iterator it =
+        nodes.find(node->name);
+
+    varview_forget_children(node);
+
+    /* One on its way is deleted when gdb says it made it */
+    if (it != nodes.end() && it->second == node) {
+        if (node->created)
+            tgdb_request_var_delete(tgdb, node->name.c_str(), 0);
+        nodes.erase(it);
+    }
+
+    delete node;
+    rows_valid = false;
+}
+
+/* Create the variable object of a watch or a local, if it has none */
+static void varview_create(varview_node *node)
+{
+    if (node->created || nodes.count(node->name))
+        return;
+
+    nodes[node->name] = node;
+    tgdb_request_var_create(tgdb, node->name.c_str(), node->exp.c_str());
+}
+
+static void varview_add_rows(varview_node *parent, int index,
+        varview_node *node)
+{
+    varview_entry row = { parent, index, node };
+    size_t i;
+
+    rows.push_back(row);
+
+    if (!node || !node->expanded)
+        return;
+
+    for (i = 0; i < node->children.size(); i++)
+        varview_add_rows(node, i, node->children[i]);
+
+    /* A row for the children a pretty printer hasn't given yet */
+    if (node->has_more)
+        varview_add_rows(node, node->children.size(), NULL);
+}
+
+static std::vector<varview_entry> &varview_rows(void)
+{
+    size_t i;
+
+    if (!rows_valid) {
+        rows.clear();
+        for (i = 0; i < watches.size(); i++)
+            varview_add_rows(NULL, i, watches[i]);
+        for (i = 0; i < locals.size(); i++)
+            varview_add_rows(NULL, i, locals[i]);
+        rows_valid = true;
+    }
+
+    return rows;
+}
+
+static int varview_count(void)
+{
+    return varview_rows().size();
+}
+
+static bool varview_row(int row, std::string &text)
+{
+    std::vector<varview_entry> &r = varview_rows();
+
+    if (row < 0 || row >= (int)r.size() || !r[row].node)
+        return false;
+
+    text = r[row].node->text;
+    return true;
+}
+
+/* Update the values and get the locals of the selected frame */
+static void varview_update(void)
+{
+    size_t i;
+
+    need_update = false;
+    replies_expect(&update_replies);
+
+    if (!nodes.empty())
+        tgdb_request_var_update(tgdb);
+
+    /* A watch that could not be evaluated may work in this frame */
+    for (i = 0; i < watches.size(); i++)
+        varview_create(watches[i]);
+
+    tgdb_request_stack_variables(tgdb);
+}
+
+static bool varview_missing(int row)
+{
+    return !rows[row].node;
+}
+
+static void varview_fetch(int first, int last)
+{
+    std::vector<varview_entry> &r = varview_rows();
+    int low, high, j;
+    varview_node *parent;
+    int to;
+
+    if (need_update && !replies_waiting(&update_replies))
+        varview_update();
+
+    if (replies_waiting(&update_replies) ||
+            replies_waiting(&children_replies) ||
+            !infowin_missing_rows(first, last, r.size(), varview_missing,
+                &low, &high))
+        return;
+
+    /* The children of one parent at a time */
+    parent = r[low].parent;
+    for (j = low; j < high && r[j + 1].parent == parent; j++)
+        ;
+
+    to = r[j].index + 1;
+
+    /* A pretty printer has no count, ask for a screen of children */
+    if (r[j].index == (int)parent->children.size())
+        to = std::max(to, r[low].index + last - first + 1);
+
+    replies_expect(&children_replies);
+    children_pending = parent->name;
+    children_from = r[low].index;
+    tgdb_request_var_children(tgdb, parent->name.c_str(), children_from, to);
+}
+
+static void varview_select(int row)
+{
+    std::vector<varview_entry> &r = varview_rows();
+    varview_node *node = r[row].node;
+
+    if (!node || (node->numchild <= 0 && !node->has_more))
+        return;
+
+    node->expanded = !node->expanded;
+
+    if (node->expanded) {
+        node->children.resize(std::max(node->numchild,
+                    (int)node->children.size()), NULL);
+    } else if (!node->children.empty()) {
+        /* gdb updates every variable object on each stop, don't keep
+         * the children of a container the user is done with */
+        varview_forget_children(node);
+        tgdb_request_var_delete(tgdb, node->name.c_str(), 1);
+    }
+
+    varview_format(node);
+    rows_valid = false;
+}
+
+void varview_add_watch(const char *expression)
+{
+    char name[32];
+    varview_node *node = varview_node_new(expression, 0);
+
+    snprintf(name, sizeof(name), "cgdb_w%d", ++last_id);
+    node->name = name;
+    node->value = "...";
+    varview_format(node);
+
+    watches.push_back(node);
+    rows_valid = false;
+
+    /* Otherwise it is created when the inferior stops */
+    if (!infowin_running())
+        varview_create(node);
+
+    if_info_changed(&varview);
+}
+
+int varview_remove_watch(const char *expression)
+{
+    std::vector<varview_node *>::iterator it = watches.begin();
+    int count = 0;
+
+    while (it != watches.end()) {
+        if (!expression || (*it)->exp == expression) {
+            varview_delete(*it);
+            it = watches.erase(it);
+            count++;
+        } else {
+            ++it;
+        }
+    }
+
+    if_info_changed(&varview);
+
+    return count;
+}
+
+void varview_update_variables(struct tgdb_response *response)
+{
+    char **names = response->choice.update_stack_variables.names;
+    std::vector<varview_node *> old_locals;
+    bool changed = false;
+    int i;
+    size_t j;
+
+    if (!replies_receive(&update_replies))
+        return;
+
+    /* A local with the same name is the same variable object, it is
+     * floating and was already evaluated again in the selected frame */
+    old_locals.swap(locals);
+    for (i = 0; i < sbcount(names); i++) {
+        varview_node *node = NULL;
+
+        for (j = 0; j < old_locals.size(); j++) {
+            if (old_locals[j] && old_locals[j]->exp == names[i]) {
+                node = old_locals[j];
+                old_locals[j] = NULL;
+                break;
+            }
+        }
+
+        if (!node) {
+            char name[32];
+
+            node = varview_node_new(names[i], 0);
+            snprintf(name, sizeof(name), "cgdb_l%d", ++last_id);
+            node->name = name;
+            node->value = "...";
+            varview_format(node);
+            changed = true;
+        } else if (j != (size_t)i) {
+            changed = true;
+        }
+
+        varview_create(node);
+        locals.push_back(node);
+    }
+
+    for (j = 0; j < old_locals.size(); j++) {
+        if (old_locals[j]) {
+            varview_delete(old_locals[j]);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        rows_valid = false;
+        if_info_changed(&varview);
+    }
+}
+
+void varview_update_create(struct tgdb_response *response)
+{
+    struct tgdb_varobj *var = &response->choice.update_var_create.var;
+    std::map<std::string, varview_node *>::iterator it =
+        nodes.find(var->name);
+    varview_node *node;
+
+    /* The watch or local was deleted before gdb made it */
+    if (it == nodes.end()) {
+        if (!response->choice.update_var_create.error)
+            tgdb_request_var_delete(tgdb, var->name, 0);
+        return;
+    }
+
+    node = it->second;
+
+    if (response->choice.update_var_create.error) {
+        /* Try again on the next stop */
+        nodes.erase(it);
+        node->value = response->choice.update_var_create.error;
+        node->numchild = 0;
+        node->has_more = false;
+    } else {
+        node->created = true;
+        node->value = var->value ? var->value : "";
+        node->numchild = std::max(var->numchild, 0);
+        node->has_more = var->has_more;
+    }
+
+    varview_format(node);
+    if_info_changed(&varview);
+}
+
+void varview_update_children(struct tgdb_response *response)
+{
+    struct tgdb_varobj *children =
+        response->choice.update_var_children.children;
+    std::map<std::string, varview_node *>::iterator it;
+    varview_node *parent;
+    int i, index;
+
+    if (!replies_receive(&children_replies))
+        return;
+
+    children_pending.clear();
+
+    it = nodes.find(response->choice.update_var_children.name);
+    if (it == nodes.end())
+        return;
+    parent = it->second;
+
+    for (i = 0; i < sbcount(children); i++) {
+        struct tgdb_varobj *var = &children[i];
+        varview_node *child;
+
+        index = children_from + i;
+        if (index >= (int)parent->children.size())
+            parent->children.resize(index + 1, NULL);
+        if (parent->children[index])
+            continue;
+
+        child = varview_node_new(var->exp ? var->exp : var->name,
+                parent->depth + 1);
+        child->name = var->name;
+        child->value = var->value ? var->value : "";
+        child->numchild = std::max(var->numchild, 0);
+        child->has_more = var->has_more;
+        child->created = true;
+        varview_format(child);
+
+        parent->children[index] = child;
+        nodes[child->name] = child;
+    }
+
+    if (response->choice.update_var_children.error) {
+        /* Fill in the children gdb can't get, so they aren't fetched
+         * again */
+        for (index = 0; index < (int)parent->children.size(); index++) {
+            if (!parent->children[index]) {
+                varview_node *child = varview_node_new("?",
+                        parent->depth + 1);
+                child->value = "<unavailable>";
+                varview_format(child);
+                parent->children[index] = child;
+            }
+        }
+        parent->has_more = false;
+    } else if (parent->has_more &&
+            !response->choice.update_var_children.has_more) {
+        /* The pretty printer has no more children */
+        parent->has_more = false;
+        parent->children.resize(std::min((int)parent->children.size(),
+                    children_from + sbcount(children)));
+    }
+
+    varview_format(parent);
+    rows_valid = false;
+    if_info_changed(&varview);
+}
+
+void varview_update_changes(struct tgdb_response *response)
+{
+    struct tgdb_varobj *changes = response->choice.update_var_changes.changes;
+    bool changed = false;
+    int i;
+
+    for (i = 0; i < sbcount(changes); i++) {
+        struct tgdb_varobj *var = &changes[i];
+        std::map<std::string, varview_node *>::iterator it =
+            nodes.find(var->name);
+        varview_node *node;
+
+        if (it == nodes.end())
+            continue;
+        node = it->second;
+
+        if (var->in_scope == -1) {
+            /* The variable object can't be used anymore, a watch or local
+             * is created again by the update */
+            varview_forget_children(node);
+            tgdb_request_var_delete(tgdb, node->name.c_str(), 0);
+            nodes.erase(it);
+            node->created = false;
+            node->expanded = false;
+            node->numchild = 0;
+            node->has_more = false;
+            node->value = "<invalid>";
+            if (node->depth == 0)
+                need_update = true;
+        } else {
+            if (var->in_scope == 0)
+                node->value = "<out of scope>";
+            else if (var->value)
+                node->value = var->value;
+
+            /* gdb deleted the children of a variable whose type changed,
+             * the children of a pretty printer are read again */
+            if (var->type_changed ||
+                    (var->numchild >= 0 && var->numchild != node->numchild)) {
+                if (!var->type_changed && !node->children.empty())
+                    tgdb_request_var_delete(tgdb, node->name.c_str(), 1);
+                varview_forget_children(node);
+                if (var->numchild >= 0)
+                    node->numchild = var->numchild;
+                if (node->expanded)
+                    node->children.resize(node->numchild, NULL);
+            }
+            node->has_more = var->has_more;
+        }
+
+        varview_format(node);
+        changed = true;
+    }
+
+    if (changed)
+        if_info_changed(&varview);
+}
+
+void varview_inferior_changed(struct tgdb_response *response)
+{
+    size_t i;
+
+    switch (response->header) {
+        case TGDB_INFERIOR_RUNNING:
+            break;
+        case TGDB_INFERIOR_STOPPED:
+            need_update = true;
+            break;
+        case TGDB_INFERIOR_EXITED:
+            /* The locals are gone, the watches may still be evaluated */
+            need_update = true;
+            for (i = 0; i < locals.size(); i++)
+                varview_delete(locals[i]);
+            locals.clear();
+            break;
+        default:
+            return;
+    }
+
+    if_info_changed(&varview);
+}
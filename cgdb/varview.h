@@ -0,0 +1,67 @@
+// The variables view of the info window
+//
+// The view shows the watch expressions and then the arguments and locals of
+// the selected frame, each backed by a gdb/mi variable object. A stop costs
+// one -var-update for all of them, and only the values it reports changed
+// are formatted again. The children of a variable are read as they scroll
+// into view, so expanding a big container doesn't read all of it.
+
+#ifndef _VARVIEW_H_
+#define _VARVIEW_H_
+
+#include "infowin.h"
+#include "tgdb.h"
+
+// Get the variables view, to show in the info window
+//
+// @return
+// The variables view
+struct infowin_view *varview_get(void);
+
+// Add a watch expression, shown above the locals
+//
+// @param expression
+// The expression to watch
+void varview_add_watch(const char *expression);
+
+// Remove watch expressions
+//
+// @param expression
+// The expression to stop watching, or NULL to remove all of them
+//
+// @return
+// The number of watch expressions removed
+int varview_remove_watch(const char *expression);
+
+// Handle a TGDB_UPDATE_STACK_VARIABLES response
+//
+// @param response
+// The response from tgdb
+void varview_update_variables(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_VAR_CREATE response
+//
+// @param response
+// The response from tgdb
+void varview_update_create(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_VAR_CHILDREN response
+//
+// @param response
+// The response from tgdb
+void varview_update_children(struct tgdb_response *response);
+
+// Handle a TGDB_UPDATE_VAR_CHANGES response
+//
+// @param response
+// The response from tgdb
+void varview_update_changes(struct tgdb_response *response);
+
+// Handle a TGDB_INFERIOR_RUNNING, TGDB_INFERIOR_STOPPED or
+// TGDB_INFERIOR_EXITED response, the values may be out of date
+//
+// @param response
+// The response from tgdb
+void varview_inferior_changed(struct tgdb_response *response);
+
+#endif
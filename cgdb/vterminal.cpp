@@ -91,6 +91,11 @@ struct VTerminal
     // be better to return a std::string
     // Also: Error handling?
     void fetch_row(int row, int start_col, int end_col, int &attr, int &width);
+    // Fetch a row as runs of cells with the same attributes
+    //
+    // See vterminal_fetch_row_spans for comments
+    void fetch_row_spans(int row, int split_start, int split_end,
+            std::string &utf8text, std::vector<VTerminalSpan> &spans);
     // Fetch a single cell
     bool fetch_cell(int row, int col, VTermScreenCell *cell);
 
@@ -341,6 +346,54 @@ VTerminal::sb_popline(int cols, VTermScreenCell *cells)
 
 int ansi_get_closest_color_value(int r, int g, int b);
 
+// The ncurses color to use for an entry of the 256 color palette
+struct PaletteColor {
+    // The ncurses color index, 0 through 7
+    int index;
+    // True if the color must be drawn bold
+    bool bold;
+};
+
+// Map the 256 color palette onto the 8 ncurses colors.
+//
+// The mapping never changes, so it is computed once. Colors 16 and
+// up need a nearest color search.
+static const PaletteColor &get_palette_color(int idx)
+{
+    static PaletteColor palette[256];
+    static bool palette_inited = false;
+
+    if (!palette_inited) {
+        for (int num = 0; num < 256; num++) {
+            int index;
+
+            if (num < 16) {
+                index = num;
+            } else if (num >= 232) {
+                int gray = 255 * (num - 232) / (255 - 232);
+                index = ansi_get_closest_color_value( gray, gray, gray );
+            } else {
+                int red = ((num - 16) / 36);
+                int green = (((num - 16) - red * 36) / 6);
+                int blue = ((num - 16) % 6);
+                index = ansi_get_closest_color_value( red * 255 / 6,
+                        green * 255 / 6, blue * 255 / 6 );
+            }
+
+            // Colors 8 through 15 are high intensity colors
+            // To my knowledge, the only way to handle this with ncurses is
+            // to bold the corresponding low intensity numbers.
+            // https://en.wikipedia.org/wiki/ANSI_escape_code
+            palette[num].bold = (index >= 8 && index < 16);
+            palette[num].index = palette[num].bold ? index - 8 : index;
+        }
+
+        palette_inited = true;
+    }
+
+    return palette[idx & 0xff];
+}
+
 static int get_ncurses_color_index(VTermColor &color, bool &bold)
 {
     int index = -1;
@@ -351,65 +404,92 @@ static int get_ncurses_color_index(VTermColor &color, bool &bold)
     } else if (VTERM_COLOR_IS_DEFAULT_BG(&color)) {
         index = -1;
     } else if (VTERM_COLOR_IS_INDEXED(&color)) {
-        if (color.indexed.idx < 16) {
-            index = color.indexed.idx;
-        } else if (color.indexed.idx >=232) {
-            int num = color.indexed.idx;
-            int gray = 255 * (MIN(num, 255) - 232) / (255 - 232);
-            index = ansi_get_closest_color_value( gray, gray, gray );
-        } else if (color.indexed.idx >= 16) {
-            int num = color.indexed.idx;
-            int red = ((num - 16) / 36);
-            int green = (((num - 16) - red * 36) / 6);
-            int blue = ((num - 16) % 6);
-            index = ansi_get_closest_color_value( red * 255 / 6,
-                    green * 255 / 6, blue * 255 / 6 );
-        }
+        const PaletteColor &palette_color =
+                get_palette_color(color.indexed.idx);
 
-        // Colors 8 through 15 are high intensity colors
-        // To my knowledge, the only way to handle this with ncurses is
-        // to bold the corresponding low intensity numbers.
-        // https://en.wikipedia.org/wiki/ANSI_escape_code
-        if (index >=8 && index < 16) {
-            index = index - 8;
-            bold = true;
-        }
+        index = palette_color.index;
+        bold = palette_color.bold;
     } else if (VTERM_COLOR_IS_RGB(&color)) {
         // TODO: RGB is currently unsupported
     }
     return index;
 }
 
-void
-VTerminal::fetch_row(int row, int start_col, int end_col, int &attr, int &width)
-{
-  int col = start_col;
-  size_t line_len = 0;
-  char *ptr = textbuf;
+// The cell attributes cgdb can draw, only one is used at a time
+enum CellStyle {
+    CELL_STYLE_NORMAL,
+    CELL_STYLE_BOLD,
+    CELL_STYLE_UNDERLINE,
+    CELL_STYLE_BLINK,
+    CELL_STYLE_REVERSE,
+    CELL_STYLE_COUNT
+};
 
- row = row - scroll_offset;
+// Get the curses attribute for a foreground and background color index
+// (-1 through 7) and a cell style.
+//
+// There are only a few hundred combinations, so the attributes are
+// remembered rather than computed for every cell drawn.
+static int get_cell_attr(int fg_index, int bg_index, CellStyle style)
+{
+    struct CellAttr {
+        bool cached;
+        int attr;
+    };
+    static CellAttr cell_attrs[9][9][CELL_STYLE_COUNT];
+    static const int style_attrs[CELL_STYLE_COUNT] = {
+        0, SWIN_A_BOLD, SWIN_A_UNDERLINE, SWIN_A_BLINK, SWIN_A_REVERSE
+    };
+
+    CellAttr &cell_attr = cell_attrs[fg_index + 1][bg_index + 1][style];
+
+    if (!cell_attr.cached) {
+        hl_get_color_attr_from_index(fg_index, bg_index, cell_attr.attr);
+        cell_attr.attr |= style_attrs[style];
+        cell_attr.cached = true;
+    }
 
-  while (col < end_col) {
-    VTermScreenCell cell;
-    fetch_cell(row, col, &cell);
+    return cell_attr.attr;
+}
 
+// Get the curses attribute to draw a cell with
+static int get_screen_cell_attr(VTermScreenCell &cell)
+{
     // TODO: What about rgb colors?
     bool fg_bold = false, bg_bold = false;
     int fg_index = get_ncurses_color_index(cell.fg, fg_bold);
     int bg_index = get_ncurses_color_index(cell.bg, bg_bold);
-    hl_get_color_attr_from_index(fg_index, bg_index, attr);
 
     // set attributes
+    CellStyle style = CELL_STYLE_NORMAL;
     if (cell.attrs.bold || fg_bold || bg_bold) {
-        attr |= SWIN_A_BOLD;
+        style = CELL_STYLE_BOLD;
     } else if (cell.attrs.underline) {
-        attr |= SWIN_A_UNDERLINE;
+        style = CELL_STYLE_UNDERLINE;
     } else if (cell.attrs.blink) {
-        attr |= SWIN_A_BLINK;
+        style = CELL_STYLE_BLINK;
     } else if (cell.attrs.reverse) {
-        attr |= SWIN_A_REVERSE;
+        style = CELL_STYLE_REVERSE;
     }
 
+    return get_cell_attr(fg_index, bg_index, style);
+}
+
+void
+VTerminal::fetch_row(int row, int start_col, int end_col, int &attr, int &width)
+{
+  int col = start_col;
+  size_t line_len = 0;
+  char *ptr = textbuf;
+
+ row = row - scroll_offset;
+
+  while (col < end_col) {
+    VTermScreenCell cell;
+    fetch_cell(row, col, &cell);
+
+    attr = get_screen_cell_attr(cell);
+
     int cell_len = 0;
     if (cell.chars[0]) {
       for (int i = 0; cell.chars[i]; i++) {
@@ -433,6 +513,51 @@ VTerminal::fetch_row(int row, int start_col, int end_col, int &attr, int &width)
   width = col - start_col;
 }
 
+void
+VTerminal::fetch_row_spans(int row, int split_start, int split_end,
+        std::string &utf8text, std::vector<VTerminalSpan> &spans)
+{
+  int height, width;
+  char cellbuf[VTERM_MAX_CHARS_PER_CELL * 6];
+
+  vterm_get_size(vt, &height, &width);
+
+  utf8text.clear();
+  spans.clear();
+
+  row = row - scroll_offset;
+
+  for (int col = 0; col < width; ) {
+    VTermScreenCell cell;
+    fetch_cell(row, col, &cell);
+
+    int attr = get_screen_cell_attr(cell);
+
+    int cell_len = 0;
+    if (cell.chars[0]) {
+      for (int i = 0; i < VTERM_MAX_CHARS_PER_CELL && cell.chars[i]; i++) {
+        cell_len += fill_utf8(cell.chars[i], cellbuf + cell_len);
+      }
+    } else {
+      cellbuf[0] = ' ';
+      cell_len = 1;
+    }
+
+    // Start a new span when the attributes change
+    if (spans.empty() || spans.back().attr != attr ||
+            col == split_start || col == split_end) {
+      VTerminalSpan span = { attr, 0, 0 };
+      spans.push_back(span);
+    }
+
+    utf8text.append(cellbuf, cell_len);
+    spans.back().width += cell.width;
+    spans.back().len += cell_len;
+
+    col += cell.width;
+  }
+}
+
 bool
 VTerminal::fetch_cell(int row, int col, VTermScreenCell *cell)
 {
@@ -552,15 +677,11 @@ void vterminal_fetch_row(VTerminal *terminal, int row,
     }
 }
 
-void vterminal_fetch_row_col(VTerminal *terminal, int row,
-        int col, std::string &utf8text, int &attr, int &width)
+void vterminal_fetch_row_spans(VTerminal *terminal, int row,
+        int split_start, int split_end, std::string &utf8text,
+        std::vector<VTerminalSpan> &spans)
 {
-    terminal->fetch_row(row, col, col+1, attr, width);
-    if (terminal->textbuf[0] != '\0') {
-        utf8text = terminal->textbuf;
-    } else {
-        utf8text = "";
-    }
+    terminal->fetch_row_spans(row, split_start, split_end, utf8text, spans);
 }
 
 void vterminal_get_cursor_pos(VTerminal *terminal, int &row, int &col)
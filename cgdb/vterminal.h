@@ -2,6 +2,7 @@
 #define VTERMINAL_H
 
 #include <string>
+#include <vector>
 #include <stddef.h>
 
 // A virtual terminal based on vterm
@@ -73,30 +74,45 @@ void vterminal_write(VTerminal *terminal, const char *data, size_t len);
 // The width of the virtual terminal
 void vterminal_get_height_width(VTerminal *terminal, int &height, int &width);
 
-// Fetch the text and attributes for a row and column
-// 
+// A run of cells in a row that share the same attributes
+struct VTerminalSpan
+{
+    // The attributes of the cells
+    int attr;
+
+    // The number of columns the cells cover
+    int width;
+
+    // The number of bytes of utf8 text for the cells
+    int len;
+};
+
+// Fetch the text and attributes for a row, as runs of cells
+//
+// Every column of the row is covered by a span, empty cells are
+// returned as spaces so that they are colored when drawn.
+//
 // @param terminal
 // The terminal to operate on
 //
 // @param row
 // The row to fetch at
 //
-// @param col
-// The column to fetch at
+// @param split_start
+// @param split_end
+// Spans are also broken at these columns, even if the attributes do
+// not change, so a region of the row can be drawn differently.
+// Use -1 if not needed.
 //
 // @param utf8text
-// Will return the text at the row/col
-//
-// @param attr
-// Will return the attributes at the row/col
-//
-// @param width
-// Will return the width of the row/col.
-// An ascii character is size 1, width == 1
-// A wide unicode character is size 2, width == 2
-// The next column you access should be col + width
-void vterminal_fetch_row_col(VTerminal *terminal, int row,
-        int col, std::string &utf8text, int &attr, int &width);
+// Will return the text of the row, the text of each span follows
+// the text of the one before it
+//
+// @param spans
+// Will return the spans of the row, from left to right
+void vterminal_fetch_row_spans(VTerminal *terminal, int row,
+        int split_start, int split_end, std::string &utf8text,
+        std::vector<VTerminalSpan> &spans);
 
 // Fetch the text for a row and column range
 // 
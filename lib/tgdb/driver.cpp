@@ -121,9 +121,9 @@ static int set_up_signal(void)
     return 0;
 }
 
-static int gdb_input(int fd)
+static int gdb_input()
 {
-    int result = tgdb_process(tgdb, fd);
+    int result = tgdb_process(tgdb);
 
     if (result == -1) {
         clog_error(CLOG_CGDB, "file descriptor closed");
@@ -159,7 +159,7 @@ static int stdin_input()
     return 0;
 }
 
-int main_loop(int gdbfd, int mifd)
+int main_loop(int gdbfd)
 {
     int max;
     fd_set rfds;
@@ -167,14 +167,12 @@ int main_loop(int gdbfd, int mifd)
 
     while (!gdb_quit) {
         max = (gdbfd > STDIN_FILENO) ? gdbfd : STDIN_FILENO;
-        max = (max > mifd) ? max : mifd;
 
         /* Clear the set and 
          *
          * READ FROM:
          * stdin          (user or gui) 
-         * master         (gdb's stdout)
-         * gui_stdout     (gui's stdout sending new info)
+         * gdbfd          (gdb's console and mi output)
          *
          */
         FD_ZERO(&rfds);
@@ -182,7 +180,6 @@ int main_loop(int gdbfd, int mifd)
         /* Let the terminal emulate the char's when TGDB is busy */
         FD_SET(STDIN_FILENO, &rfds);
         FD_SET(gdbfd, &rfds);
-        FD_SET(mifd, &rfds);
 
         result = select(max + 1, &rfds, NULL, NULL, NULL);
 
@@ -197,27 +194,18 @@ int main_loop(int gdbfd, int mifd)
             stdin_input();
         }
 
-        /* gdb's output -> stdout  */
+        /* gdb's output -> stdout, gdb's mi output -> tgdb  */
         if (FD_ISSET(gdbfd, &rfds))
-            if (gdb_input(gdbfd) == -1)
+            if (gdb_input() == -1)
                 return -1;
-
-        /* gdb's mi output -> tgdb  */
-        if (FD_ISSET(mifd, &rfds)) {
-            if (gdb_input(mifd) == -1)
-                return -1;
-        }
     }
 
     return 0;
 }
 
-void console_output(void *context, const std::string &str) {
-    std::string::const_iterator iter = str.begin();
-    for (; iter != str.end(); ++iter) {
-        if (write(STDOUT_FILENO, &*iter, 1) != 1) {
-            clog_error(CLOG_CGDB, "could not write byte");
-        }
+void console_output(void *context, const char *data, size_t size) {
+    if (io_writen(STDOUT_FILENO, data, size) != (ssize_t)size) {
+        clog_error(CLOG_CGDB, "could not write bytes");
     }
 }
 
@@ -237,7 +225,7 @@ tgdb_callbacks callbacks = {
 
 int main(int argc, char **argv)
 {
-    int gdb_console_fd, gdb_mi_fd;
+    int gdb_fd;
 
 #if 0
     int c;
@@ -261,14 +249,14 @@ int main(int argc, char **argv)
     }
 
     if (tgdb_start_gdb(tgdb, NULL, argc - 1, argv + 1, 0, 0,
-            &gdb_console_fd, &gdb_mi_fd ) == -1) {
+            &gdb_fd) == -1) {
         clog_error(CLOG_CGDB, "tgdb_start error");
         goto driver_end;
     }
 
     set_up_signal();
 
-    main_loop(gdb_console_fd, gdb_mi_fd);
+    main_loop(gdb_fd);
 
     if (tgdb_shutdown(tgdb) == -1)
         clog_error(CLOG_CGDB, "could not shutdown");
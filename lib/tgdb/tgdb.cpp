@@ -26,8 +26,9 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
+#include <algorithm>
 #include <list>
-#include <sstream>
+#include <vector>
 
 #include "tgdb.h"
 #include "fork_util.h"
@@ -38,6 +39,8 @@
 #include "stretchy.h"
 #include "cgdb_clog.h"
 #include "gdbwire.h"
+#include "tgdb_io.h"
+#include "tgdb_mi.h"
 
 /* }}} */
 
@@ -97,8 +100,11 @@ struct tgdb {
     char **disasm;
     uint64_t address_start, address_end;
 
-    // The gdbwire context to talk to GDB with.
-    struct gdbwire *wire;
+    // The I/O thread reading and parsing GDB's output.
+    struct tgdb_io *io;
+
+    // The I/O thread's read size and budget, see tgdb_set_read_limits.
+    int read_size, read_budget;
 
     // True if the disassemble command supports /s, otherwise false.
     int disassemble_supports_s_mode;
@@ -113,6 +119,44 @@ struct tgdb {
     // Temporary buffer used to store the line by line console output
     // in order to search for the unsupported new ui string above.
     std::string *undefined_new_ui_command;
+
+    // True once the gdb/mi new-ui has shown a prompt. The new-ui command
+    // clearly worked then, so the console output is no longer searched.
+    bool new_ui_confirmed;
+
+    // Reused buffer for translating target output from LF to CRLF.
+    std::string *target_output;
+
+    // The source files from the last -file-list-exec-source-files,
+    // valid until tgdb_invalidate_source_files is called.
+    char **source_files;
+    bool source_files_valid;
+
+    // Bumped each time the source files are invalidated. A reply is only
+    // kept if nothing was invalidated after its request was sent.
+    unsigned long source_files_generation;
+    unsigned long source_files_request_generation;
+
+    // The line the user is typing at the gdb console, see
+    // tgdb_watch_console_input.
+    std::string *console_line;
+
+    // The thread gdb last stopped in or selected, or 0 if unknown
+    int thread_id;
+
+    // The variable object of the running -var-create or -var-list-children.
+    // Their error replies don't say which one it was.
+    std::string *var_name;
+
+    // The threads of the inferior, in the order they were created
+    std::vector<int> *thread_ids;
+
+    // The thread of the running -thread-info
+    int thread_info_id;
+
+    // The address and length of the running -data-read-memory-bytes
+    std::string *memory_address;
+    int memory_count;
 };
 
 // This is the type of request
@@ -162,6 +206,55 @@ struct tgdb_request {
             // The address to set breakpoint in (if file is null)
             uint64_t addr;
         } until_line;
+
+        struct {
+            // The most frames to count
+            int max_depth;
+        } stack_depth;
+
+        struct {
+            // The levels of the first and last frame to get
+            int low;
+            int high;
+        } stack_frames;
+
+        struct {
+            // The level of the frame to select
+            int level;
+        } select_frame;
+
+        struct {
+            // The name of the variable object
+            const char *name;
+
+            // The expression to create the variable object for
+            const char *expression;
+
+            // The range of children to get
+            int from;
+            int to;
+
+            // True to delete only the children
+            int children_only;
+        } var;
+
+        struct {
+            // The expression for the address of the first byte
+            const char *address;
+
+            // The number of bytes to read
+            int count;
+        } read_memory;
+
+        struct {
+            // The number of the thread
+            int id;
+        } thread;
+
+        struct {
+            // The numbers of the registers to get, a stretchy buffer
+            int *numbers;
+        } register_values;
     } choice;
 };
 
@@ -170,6 +263,7 @@ struct tgdb_request {
 /* Temporary prototypes {{{ */
 struct tgdb_response *tgdb_create_response(enum tgdb_response_type header);
 void tgdb_send_response(struct tgdb *tgdb, struct tgdb_response *response);
+static int tgdb_delete_response(struct tgdb_response *com);
 static void tgdb_run_request(struct tgdb *tgdb, struct tgdb_request *request);
 static void tgdb_unqueue_and_deliver_command(struct tgdb *tgdb);
 void tgdb_run_or_queue_request(struct tgdb *tgdb,
@@ -266,6 +360,38 @@ static void tgdb_commands_send_source_files(struct tgdb *tgdb,
     tgdb_send_response(tgdb, response);
 }
 
+/* Send the cached source files. The cache keeps them, the response only
+ * borrows them for the callback. */
+static void tgdb_commands_send_cached_source_files(struct tgdb *tgdb)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_SOURCE_FILES);
+    response->choice.update_source_files.source_files = tgdb->source_files;
+    tgdb->callbacks.command_response_callback(
+            tgdb->callbacks.context, response);
+    response->choice.update_source_files.source_files = NULL;
+    tgdb_delete_response(response);
+}
+
+static void tgdb_free_source_files(char **source_files)
+{
+    int i;
+
+    for (i = 0; i < sbcount(source_files); i++) {
+        free(source_files[i]);
+    }
+    sbfree(source_files);
+}
+
+/* Drop the cached source files, gdb may have loaded or unloaded code */
+static void tgdb_invalidate_source_files(struct tgdb *tgdb)
+{
+    tgdb_free_source_files(tgdb->source_files);
+    tgdb->source_files = NULL;
+    tgdb->source_files_valid = false;
+    tgdb->source_files_generation++;
+}
+
 /* This function is capable of parsing the output of 'info source'.
  * It can get both the absolute and relative path to the source file.
  */
@@ -287,7 +413,15 @@ tgdb_commands_process_info_sources(struct tgdb *tgdb,
             files = files->next;
         }
 
-        tgdb_commands_send_source_files(tgdb, source_files);
+        if (tgdb->source_files_request_generation ==
+                tgdb->source_files_generation) {
+            tgdb_free_source_files(tgdb->source_files);
+            tgdb->source_files = source_files;
+            tgdb->source_files_valid = true;
+            tgdb_commands_send_cached_source_files(tgdb);
+        } else {
+            tgdb_commands_send_source_files(tgdb, source_files);
+        }
 
         gdbwire_mi_command_free(mi_command);
     }
@@ -396,6 +530,264 @@ static void tgdb_commands_process_info_frame(struct tgdb *tgdb,
     }
 }
 
+static void tgdb_commands_process_stack_depth(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_STACK_DEPTH);
+
+    if (result_record->result_class == GDBWIRE_MI_DONE) {
+        response->choice.update_stack_depth.depth =
+            tgdb_find_int(result_record->result, "depth", 0);
+    } else {
+        response->choice.update_stack_depth.error = 1;
+    }
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_stack_frames(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_STACK_FRAMES);
+
+    if (tgdb_parse_stack_frames(result_record,
+                &response->choice.update_stack_frames.frames) == -1)
+        response->choice.update_stack_frames.error = 1;
+
+    tgdb_send_response(tgdb, response);
+}
+
+/* This parses the reply of -stack-list-frames for the source files,
+ *   ^done,stack=[frame={level="0",...,fullname="/home/foo/main.c",...},...]
+ */
+static void tgdb_commands_process_frame_files(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_FRAME_FILES);
+    struct gdbwire_mi_result *stack =
+        tgdb_find_result(result_record->result, "stack");
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !stack ||
+            stack->kind != GDBWIRE_MI_LIST) {
+        response->choice.update_frame_files.error = 1;
+    } else {
+        char **paths = NULL;
+        struct gdbwire_mi_result *frame;
+
+        for (frame = stack->variant.result; frame; frame = frame->next) {
+            const char *fullname;
+
+            if (frame->kind != GDBWIRE_MI_TUPLE)
+                continue;
+
+            fullname = tgdb_find_cstring(frame->variant.result, "fullname");
+            if (fullname)
+                sbpush(paths, cgdb_strdup(fullname));
+        }
+
+        response->choice.update_frame_files.paths = paths;
+    }
+
+    tgdb_send_response(tgdb, response);
+}
+
+/* This parses the reply of -stack-list-variables --no-values,
+ *   ^done,variables=[{name="argc",arg="1"},{name="i"}]
+ */
+static void tgdb_commands_process_stack_variables(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_STACK_VARIABLES);
+    struct gdbwire_mi_result *variables =
+        tgdb_find_result(result_record->result, "variables");
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !variables ||
+            variables->kind != GDBWIRE_MI_LIST) {
+        response->choice.update_stack_variables.error = 1;
+    } else {
+        char **names = NULL;
+        struct gdbwire_mi_result *variable;
+
+        for (variable = variables->variant.result; variable;
+                variable = variable->next) {
+            const char *name;
+
+            if (variable->kind != GDBWIRE_MI_TUPLE)
+                continue;
+
+            name = tgdb_find_cstring(variable->variant.result, "name");
+            if (name)
+                sbpush(names, cgdb_strdup(name));
+        }
+
+        response->choice.update_stack_variables.names = names;
+    }
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_var_create(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_VAR_CREATE);
+    struct tgdb_varobj *var = &response->choice.update_var_create.var;
+
+    if (result_record->result_class == GDBWIRE_MI_DONE) {
+        tgdb_parse_varobj(result_record->result, var);
+    } else {
+        const char *msg = tgdb_find_cstring(result_record->result, "msg");
+
+        response->choice.update_var_create.error =
+            cgdb_strdup(msg ? msg : "error");
+    }
+
+    // The error reply has no name, it is always the one asked for
+    free(var->name);
+    var->name = cgdb_strdup(tgdb->var_name->c_str());
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_var_children(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_VAR_CHILDREN);
+
+    response->choice.update_var_children.name =
+        cgdb_strdup(tgdb->var_name->c_str());
+
+    if (result_record->result_class == GDBWIRE_MI_DONE) {
+        response->choice.update_var_children.children = tgdb_parse_varobjs(
+                tgdb_find_result(result_record->result, "children"));
+        response->choice.update_var_children.has_more =
+            tgdb_find_int(result_record->result, "has_more", 0);
+    } else {
+        response->choice.update_var_children.error = 1;
+    }
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_var_update(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response;
+
+    // Without variable objects there is nothing to update
+    if (result_record->result_class != GDBWIRE_MI_DONE)
+        return;
+
+    response = tgdb_create_response(TGDB_UPDATE_VAR_CHANGES);
+    response->choice.update_var_changes.changes = tgdb_parse_varobjs(
+            tgdb_find_result(result_record->result, "changelist"));
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_read_memory(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_MEMORY);
+
+    response->choice.update_memory.address =
+        cgdb_strdup(tgdb->memory_address->c_str());
+    response->choice.update_memory.count = tgdb->memory_count;
+
+    if (tgdb_parse_memory(result_record,
+                &response->choice.update_memory.blocks) == -1)
+        response->choice.update_memory.error = 1;
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_thread_info(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_THREAD_INFO);
+    struct tgdb_thread *thread = &response->choice.update_thread_info.thread;
+
+    if (tgdb_parse_thread_info(result_record, thread) == -1)
+        response->choice.update_thread_info.error = 1;
+    thread->id = tgdb->thread_info_id;
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_register_names(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_REGISTER_NAMES);
+
+    if (tgdb_parse_register_names(result_record,
+                &response->choice.update_register_names.names) == -1)
+        response->choice.update_register_names.error = 1;
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_changed_registers(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_CHANGED_REGISTERS);
+
+    if (tgdb_parse_changed_registers(result_record,
+                &response->choice.update_changed_registers.numbers) == -1)
+        response->choice.update_changed_registers.error = 1;
+
+    tgdb_send_response(tgdb, response);
+}
+
+static void tgdb_commands_process_register_values(struct tgdb *tgdb,
+        struct gdbwire_mi_result_record *result_record)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_UPDATE_REGISTER_VALUES);
+
+    if (tgdb_parse_register_values(result_record,
+                &response->choice.update_register_values.registers) == -1)
+        response->choice.update_register_values.error = 1;
+
+    tgdb_send_response(tgdb, response);
+}
+
+/* Add or remove a thread of the thread table */
+static void tgdb_thread_changed(struct tgdb *tgdb, int id, bool exited)
+{
+    std::vector<int> &ids = *tgdb->thread_ids;
+    std::vector<int>::iterator it;
+    struct tgdb_response *response;
+
+    if (id <= 0)
+        return;
+
+    // gdb numbers threads in order, so they are added at the end
+    it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (exited) {
+        if (it == ids.end() || *it != id)
+            return;
+        ids.erase(it);
+    } else {
+        if (it != ids.end() && *it == id)
+            return;
+        ids.insert(it, id);
+    }
+
+    response = tgdb_create_response(TGDB_THREADS_CHANGED);
+    response->choice.threads_changed.thread_id = id;
+    response->choice.threads_changed.exited = exited;
+    tgdb_send_response(tgdb, response);
+}
+
 static void gdbwire_stream_record_callback(void *context,
     struct gdbwire_mi_stream_record *stream_record)
 {
@@ -445,19 +837,22 @@ static void gdbwire_stream_record_callback(void *context,
             break;
         case GDBWIRE_MI_TARGET:
         {
-            std::string cstring(stream_record->cstring);
-            std::string cstring_crnl;
-            for (auto c : cstring) {
-                if (c == '\n') {
-                    cstring_crnl.push_back('\r');
-                    cstring_crnl.push_back('\n');
-                } else {
-                    cstring_crnl.push_back(c);
-                }
+            // Translate LF to CRLF, copying the text between newlines
+            // in one piece
+            std::string &crlf = *tgdb->target_output;
+            const char *str = stream_record->cstring;
+            const char *newline;
+
+            crlf.clear();
+            while ((newline = strchr(str, '\n')) != NULL) {
+                crlf.append(str, newline - str);
+                crlf.append("\r\n", 2);
+                str = newline + 1;
             }
+            crlf.append(str);
 
             tgdb->callbacks.console_output_callback(
-                    tgdb->callbacks.context, cstring_crnl.c_str());
+                    tgdb->callbacks.context, crlf.data(), crlf.size());
             break;
         }
         case GDBWIRE_MI_LOG:
@@ -513,6 +908,27 @@ source_position_changed(struct tgdb *tgdb, gdbwire_mi_result *result)
     }
 }
 
+/**
+ * Tell the front end the inferior stopped.
+ *
+ * @param tgdb
+ * The TGDB context to use.
+ *
+ * @param thread_id
+ * The thread that stopped or was selected, or 0 if unknown.
+ */
+static void tgdb_inferior_stopped(struct tgdb *tgdb, int thread_id)
+{
+    struct tgdb_response *response =
+        tgdb_create_response(TGDB_INFERIOR_STOPPED);
+
+    if (thread_id)
+        tgdb->thread_id = thread_id;
+
+    response->choice.inferior_stopped.thread_id = thread_id;
+    tgdb_send_response(tgdb, response);
+}
+
 void tgdb_breakpoints_changed(void *context);
 static void gdbwire_async_record_callback(void *context,
         struct gdbwire_mi_async_record *async_record)
@@ -521,14 +937,68 @@ static void gdbwire_async_record_callback(void *context,
 
     switch (async_record->async_class) {
         case GDBWIRE_MI_ASYNC_STOPPED:
+            tgdb_inferior_stopped(tgdb,
+                    tgdb_find_int(async_record->result, "thread-id", 0));
+            source_position_changed(tgdb, async_record->result);
+            break;
         case GDBWIRE_MI_ASYNC_THREAD_SELECTED:
+            // The user selected a thread or a frame, like with up or down
+            tgdb_inferior_stopped(tgdb,
+                    tgdb_find_int(async_record->result, "id", 0));
             source_position_changed(tgdb, async_record->result);
             break;
+        case GDBWIRE_MI_ASYNC_RUNNING:
+            tgdb_send_response(tgdb,
+                    tgdb_create_response(TGDB_INFERIOR_RUNNING));
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_CREATED:
+            tgdb_thread_changed(tgdb,
+                    tgdb_find_int(async_record->result, "id", 0), false);
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_EXITED:
+            tgdb_thread_changed(tgdb,
+                    tgdb_find_int(async_record->result, "id", 0), true);
+            break;
+        case GDBWIRE_MI_ASYNC_MEMORY_CHANGED: {
+            struct tgdb_response *response =
+                tgdb_create_response(TGDB_MEMORY_CHANGED);
+
+            cgdb_hexstr_to_u64(
+                    tgdb_find_cstring(async_record->result, "addr"),
+                    &response->choice.memory_changed.addr);
+            cgdb_hexstr_to_u64(
+                    tgdb_find_cstring(async_record->result, "len"),
+                    &response->choice.memory_changed.len);
+            tgdb_send_response(tgdb, response);
+            break;
+        }
         case GDBWIRE_MI_ASYNC_BREAKPOINT_CREATED:
         case GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED:
         case GDBWIRE_MI_ASYNC_BREAKPOINT_DELETED:
             tgdb_breakpoints_changed(tgdb);
             break;
+        case GDBWIRE_MI_ASYNC_LIBRARY_LOADED:
+        case GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED:
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED:
+            tgdb_invalidate_source_files(tgdb);
+            break;
+        case GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED: {
+            struct tgdb_response *response =
+                tgdb_create_response(TGDB_INFERIOR_EXITED);
+            const char *exit_code;
+
+            tgdb_invalidate_source_files(tgdb);
+
+            tgdb->thread_id = 0;
+
+            // gdb gives the exit code in octal
+            exit_code = tgdb_find_cstring(async_record->result, "exit-code");
+            if (exit_code)
+                response->choice.inferior_exited.exit_status =
+                    strtol(exit_code, NULL, 8);
+            tgdb_send_response(tgdb, response);
+            break;
+        }
         default:
             break;
     }
@@ -567,10 +1037,60 @@ static void gdbwire_result_record_callback(void *context,
         case TGDB_REQUEST_INFO_FRAME:
             tgdb_commands_process_info_frame(tgdb, result_record);
             break;
+        case TGDB_REQUEST_STACK_DEPTH:
+            tgdb_commands_process_stack_depth(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_STACK_FRAMES:
+            tgdb_commands_process_stack_frames(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_FRAME_FILES:
+            tgdb_commands_process_frame_files(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_SELECT_FRAME:
+            // gdb doesn't send =thread-selected for its own mi commands
+            if (result_record->result_class == GDBWIRE_MI_DONE)
+                tgdb_inferior_stopped(tgdb, tgdb->thread_id);
+            break;
+        case TGDB_REQUEST_STACK_VARIABLES:
+            tgdb_commands_process_stack_variables(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_VAR_CREATE:
+            tgdb_commands_process_var_create(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_VAR_CHILDREN:
+            tgdb_commands_process_var_children(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_VAR_UPDATE:
+            tgdb_commands_process_var_update(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_READ_MEMORY:
+            tgdb_commands_process_read_memory(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_THREAD_INFO:
+            tgdb_commands_process_thread_info(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_REGISTER_NAMES:
+            tgdb_commands_process_register_names(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_CHANGED_REGISTERS:
+            tgdb_commands_process_changed_registers(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_REGISTER_VALUES:
+            tgdb_commands_process_register_values(tgdb, result_record);
+            break;
+        case TGDB_REQUEST_SELECT_THREAD:
+            // gdb doesn't send =thread-selected for its own mi commands
+            if (result_record->result_class == GDBWIRE_MI_DONE) {
+                tgdb_inferior_stopped(tgdb, tgdb_find_int(
+                            result_record->result, "new-thread-id", 0));
+                source_position_changed(tgdb, result_record->result);
+            }
+            break;
         case TGDB_REQUEST_TTY:
         case TGDB_REQUEST_DEBUGGER_COMMAND:
         case TGDB_REQUEST_MODIFY_BREAKPOINT:
         case TGDB_REQUEST_UNTIL_LINE:
+        case TGDB_REQUEST_VAR_DELETE:
             break;
     }
 }
@@ -579,6 +1099,13 @@ void tgdb_console_at_prompt(void *context);
 static void gdbwire_prompt_callback(void *context, const char *prompt)
 {
     struct tgdb *tgdb = (struct tgdb*)context;
+
+    // The new-ui is up, stop looking for the message saying it isn't
+    if (!tgdb->new_ui_confirmed) {
+        tgdb->new_ui_confirmed = true;
+        std::string().swap(*tgdb->undefined_new_ui_command);
+    }
+
     tgdb_console_at_prompt(tgdb);
 }
 
@@ -594,16 +1121,6 @@ static void gdbwire_parse_error_callback(void *context, const char *mi,
         mi, token, position.start_column, position.end_column);
 }
 
-static struct gdbwire_callbacks wire_callbacks =
-    {
-        0,
-        gdbwire_stream_record_callback,
-        gdbwire_async_record_callback,
-        gdbwire_result_record_callback,
-        gdbwire_prompt_callback,
-        gdbwire_parse_error_callback
-    };
-
 int free_char_star(void *item)
 {
     char *s = (char *) item;
@@ -614,9 +1131,52 @@ int free_char_star(void *item)
     return 0;
 }
 
-void tgdb_commands_process(struct tgdb *tgdb, const std::string &str)
+/**
+ * Handle the records the I/O thread parsed out of the gdb/mi output.
+ *
+ * @param tgdb
+ * The TGDB context to use.
+ *
+ * @param output
+ * The parsed records, freed by this function.
+ */
+static void tgdb_commands_process(struct tgdb *tgdb,
+        struct gdbwire_mi_output *output)
 {
-   gdbwire_push_data(tgdb->wire, str.data(), str.size());
+    struct gdbwire_mi_output *cur;
+
+    for (cur = output; cur; cur = cur->next) {
+        switch (cur->kind) {
+            case GDBWIRE_MI_OUTPUT_OOB: {
+                struct gdbwire_mi_oob_record *oob_record =
+                    cur->variant.oob_record;
+                switch (oob_record->kind) {
+                    case GDBWIRE_MI_ASYNC:
+                        gdbwire_async_record_callback(tgdb,
+                                oob_record->variant.async_record);
+                        break;
+                    case GDBWIRE_MI_STREAM:
+                        gdbwire_stream_record_callback(tgdb,
+                                oob_record->variant.stream_record);
+                        break;
+                }
+                break;
+            }
+            case GDBWIRE_MI_OUTPUT_RESULT:
+                gdbwire_result_record_callback(tgdb,
+                        cur->variant.result_record);
+                break;
+            case GDBWIRE_MI_OUTPUT_PROMPT:
+                gdbwire_prompt_callback(tgdb, cur->line);
+                break;
+            case GDBWIRE_MI_OUTPUT_PARSE_ERROR:
+                gdbwire_parse_error_callback(tgdb, cur->line,
+                        cur->variant.error.token, cur->variant.error.pos);
+                break;
+        }
+    }
+
+    gdbwire_mi_output_free(output);
 }
 
 void tgdb_commands_set_current_request_type(struct tgdb *tgdb,
@@ -655,12 +1215,28 @@ static struct tgdb *initialize_tgdb_context(tgdb_callbacks callbacks)
     tgdb->address_start = 0;
     tgdb->address_end = 0;
 
-    wire_callbacks.context = (void*)tgdb;
-    tgdb->wire = gdbwire_create(wire_callbacks);
+    tgdb->io = NULL;
+    tgdb->read_size = TGDB_IO_DEFAULT_READ_SIZE;
+    tgdb->read_budget = TGDB_IO_DEFAULT_READ_BUDGET;
 
     tgdb->disassemble_supports_s_mode = 0;
     tgdb->gdb_supports_new_ui_command = true;
     tgdb->undefined_new_ui_command = new std::string();
+    tgdb->new_ui_confirmed = false;
+    tgdb->target_output = new std::string();
+
+    tgdb->source_files = NULL;
+    tgdb->source_files_valid = false;
+    tgdb->source_files_generation = 0;
+    tgdb->source_files_request_generation = 0;
+    tgdb->console_line = new std::string();
+
+    tgdb->thread_id = 0;
+    tgdb->var_name = new std::string();
+    tgdb->thread_ids = new std::vector<int>();
+    tgdb->thread_info_id = 0;
+    tgdb->memory_address = new std::string();
+    tgdb->memory_count = 0;
 
     return tgdb;
 }
@@ -695,7 +1271,8 @@ static void tgdb_command_error(void *context, const std::string &msg)
     struct tgdb *tgdb = (struct tgdb*)context;
 
     /* Send cgdb the error message */
-    tgdb->callbacks.console_output_callback(tgdb->callbacks.context, msg);
+    tgdb->callbacks.console_output_callback(tgdb->callbacks.context,
+            msg.data(), msg.size());
 }
 
 void tgdb_console_at_prompt(void *context)
@@ -736,6 +1313,22 @@ static void tgdb_request_destroy(tgdb_request_ptr request_ptr)
         case TGDB_REQUEST_DISASSEMBLE_PC:
         case TGDB_REQUEST_DISASSEMBLE_FUNC:
             break;
+        case TGDB_REQUEST_VAR_CREATE:
+        case TGDB_REQUEST_VAR_CHILDREN:
+        case TGDB_REQUEST_VAR_DELETE:
+            free((char *) request_ptr->choice.var.name);
+            request_ptr->choice.var.name = NULL;
+            free((char *) request_ptr->choice.var.expression);
+            request_ptr->choice.var.expression = NULL;
+            break;
+        case TGDB_REQUEST_READ_MEMORY:
+            free((char *) request_ptr->choice.read_memory.address);
+            request_ptr->choice.read_memory.address = NULL;
+            break;
+        case TGDB_REQUEST_REGISTER_VALUES:
+            sbfree(request_ptr->choice.register_values.numbers);
+            request_ptr->choice.register_values.numbers = NULL;
+            break;
         default:
             break;
     }
@@ -785,8 +1378,7 @@ struct tgdb *tgdb_initialize(tgdb_callbacks callbacks)
 
 int tgdb_start_gdb(struct tgdb *tgdb,
         const char *debugger, int argc, char **argv,
-        int gdb_win_rows, int gdb_win_cols, int *gdb_console_fd,
-        int *gdb_mi_fd)
+        int gdb_win_rows, int gdb_win_cols, int *gdb_fd)
 {
     tgdb->debugger_pid = invoke_debugger(debugger, argc, argv,
             gdb_win_rows, gdb_win_cols, 
@@ -797,15 +1389,32 @@ int tgdb_start_gdb(struct tgdb *tgdb,
     if (tgdb->debugger_pid == -1)
         return -1;
 
-    *gdb_console_fd = tgdb->debugger_stdout;
-    *gdb_mi_fd = tgdb->gdb_mi_ui_fd;
+    tgdb->io = tgdb_io_create(tgdb->debugger_stdout, tgdb->gdb_mi_ui_fd);
+    if (!tgdb->io)
+        return -1;
+
+    tgdb_io_set_read_limits(tgdb->io, tgdb->read_size, tgdb->read_budget);
+
+    *gdb_fd = tgdb_io_get_fd(tgdb->io);
 
     return 0;
 }
 
 int tgdb_shutdown(struct tgdb *tgdb)
 {
+    // Stop reading before the descriptors go away
+    tgdb_io_destroy(tgdb->io);
+    tgdb->io = NULL;
+
     delete tgdb->undefined_new_ui_command;
+    delete tgdb->target_output;
+    delete tgdb->console_line;
+    delete tgdb->var_name;
+    delete tgdb->thread_ids;
+    delete tgdb->memory_address;
+
+    tgdb_free_source_files(tgdb->source_files);
+    tgdb->source_files = NULL;
 
     tgdb_request_ptr_list::iterator iter = tgdb->command_requests->begin();
     for (; iter != tgdb->command_requests->end(); ++iter) {
@@ -820,8 +1429,6 @@ int tgdb_shutdown(struct tgdb *tgdb)
         tgdb->debugger_stdin = -1;
     }
 
-    gdbwire_destroy(tgdb->wire);
-
     return 0;
 }
 
@@ -978,6 +1585,21 @@ static void tgdb_run_request(struct tgdb *tgdb, struct tgdb_request *request)
     /* A command for the debugger */
     tgdb_commands_set_current_request_type(tgdb, request->header);
 
+    if (request->header == TGDB_REQUEST_INFO_SOURCES)
+        tgdb->source_files_request_generation = tgdb->source_files_generation;
+
+    if (request->header == TGDB_REQUEST_VAR_CREATE ||
+            request->header == TGDB_REQUEST_VAR_CHILDREN)
+        *tgdb->var_name = request->choice.var.name;
+
+    if (request->header == TGDB_REQUEST_THREAD_INFO)
+        tgdb->thread_info_id = request->choice.thread.id;
+
+    if (request->header == TGDB_REQUEST_READ_MEMORY) {
+        *tgdb->memory_address = request->choice.read_memory.address;
+        tgdb->memory_count = request->choice.read_memory.count;
+    }
+
     if (request->header == TGDB_REQUEST_DEBUGGER_COMMAND) {
         // since debugger commands are sent to the debugger's stdin
         // and not to the new-ui mi window, then we don't have to wait
@@ -1009,8 +1631,69 @@ static void tgdb_unqueue_and_deliver_command(struct tgdb *tgdb)
     }
 }
 
+/**
+ * Check if a console command may change the program's symbols.
+ *
+ * gdb doesn't report the file and symbol-file commands over gdb/mi, so
+ * the source files are invalidated when the user types one of them.
+ *
+ * \param line
+ * The command line the user typed.
+ *
+ * \return
+ * True if the command may change the symbols, otherwise false.
+ */
+static bool tgdb_console_line_changes_symbols(const std::string &line)
+{
+    static const char *commands[] = {
+        "file", "symbol-file", "add-symbol-file", "remove-symbol-file",
+        "exec-file", "core-file", "source"
+    };
+    size_t start, end, i;
+
+    // Editing keys, history and completion make the line unknowable
+    for (i = 0; i < line.size(); ++i) {
+        if ((unsigned char)line[i] < ' ' || line[i] == 0x7f)
+            return true;
+    }
+
+    start = line.find_first_not_of(" \t");
+    if (start == std::string::npos)
+        return false;
+    end = line.find_first_of(" \t", start);
+    if (end == std::string::npos)
+        end = line.size();
+
+    // gdb accepts any unambiguous prefix of a command
+    for (i = 0; i < sizeof(commands) / sizeof(commands[0]); ++i) {
+        if (end - start >= 2 && end - start <= strlen(commands[i]) &&
+                line.compare(start, end - start, commands[i],
+                    end - start) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/* Watch the user's console input for commands that change the symbols */
+static void tgdb_watch_console_input(struct tgdb *tgdb, char c)
+{
+    std::string &line = *tgdb->console_line;
+
+    if (c != '\r' && c != '\n') {
+        line.push_back(c);
+        return;
+    }
+
+    if (tgdb_console_line_changes_symbols(line))
+        tgdb_invalidate_source_files(tgdb);
+    line.clear();
+}
+
 int tgdb_send_char(struct tgdb *tgdb, char c)
 {
+    tgdb_watch_console_input(tgdb, c);
+
     if (io_write_byte(tgdb->debugger_stdin, c) == -1) {
         clog_error(CLOG_CGDB, "io_write_byte failed");
         return -1;
@@ -1064,6 +1747,84 @@ static int tgdb_handle_sigchld(struct tgdb *tgdb)
     return result;
 }
 
+/**
+ * Answer a request that is dropped before it got to gdb with an error,
+ * so the front end doesn't wait for its reply forever.
+ *
+ * @param tgdb
+ * The tgdb instance to work on
+ *
+ * @param request
+ * The request that is dropped
+ */
+static void tgdb_fail_request(struct tgdb *tgdb, struct tgdb_request *request)
+{
+    struct tgdb_response *response;
+
+    switch (request->header) {
+        case TGDB_REQUEST_STACK_DEPTH:
+            response = tgdb_create_response(TGDB_UPDATE_STACK_DEPTH);
+            response->choice.update_stack_depth.error = 1;
+            break;
+        case TGDB_REQUEST_STACK_FRAMES:
+            response = tgdb_create_response(TGDB_UPDATE_STACK_FRAMES);
+            response->choice.update_stack_frames.error = 1;
+            break;
+        case TGDB_REQUEST_FRAME_FILES:
+            response = tgdb_create_response(TGDB_UPDATE_FRAME_FILES);
+            response->choice.update_frame_files.error = 1;
+            break;
+        case TGDB_REQUEST_STACK_VARIABLES:
+            response = tgdb_create_response(TGDB_UPDATE_STACK_VARIABLES);
+            response->choice.update_stack_variables.error = 1;
+            break;
+        case TGDB_REQUEST_VAR_CREATE:
+            response = tgdb_create_response(TGDB_UPDATE_VAR_CREATE);
+            response->choice.update_var_create.var.name =
+                cgdb_strdup(request->choice.var.name);
+            response->choice.update_var_create.error =
+                cgdb_strdup("interrupted");
+            break;
+        case TGDB_REQUEST_VAR_CHILDREN:
+            response = tgdb_create_response(TGDB_UPDATE_VAR_CHILDREN);
+            response->choice.update_var_children.name =
+                cgdb_strdup(request->choice.var.name);
+            response->choice.update_var_children.error = 1;
+            break;
+        case TGDB_REQUEST_READ_MEMORY:
+            response = tgdb_create_response(TGDB_UPDATE_MEMORY);
+            response->choice.update_memory.address =
+                cgdb_strdup(request->choice.read_memory.address);
+            response->choice.update_memory.count =
+                request->choice.read_memory.count;
+            response->choice.update_memory.error = 1;
+            break;
+        case TGDB_REQUEST_THREAD_INFO:
+            response = tgdb_create_response(TGDB_UPDATE_THREAD_INFO);
+            response->choice.update_thread_info.thread.id =
+                request->choice.thread.id;
+            response->choice.update_thread_info.error = 1;
+            break;
+        case TGDB_REQUEST_REGISTER_NAMES:
+            response = tgdb_create_response(TGDB_UPDATE_REGISTER_NAMES);
+            response->choice.update_register_names.error = 1;
+            break;
+        case TGDB_REQUEST_CHANGED_REGISTERS:
+            response = tgdb_create_response(TGDB_UPDATE_CHANGED_REGISTERS);
+            response->choice.update_changed_registers.error = 1;
+            break;
+        case TGDB_REQUEST_REGISTER_VALUES:
+            response = tgdb_create_response(TGDB_UPDATE_REGISTER_VALUES);
+            response->choice.update_register_values.error = 1;
+            break;
+        default:
+            // Nothing waits for a reply to the others
+            return;
+    }
+
+    tgdb_send_response(tgdb, response);
+}
+
 /**
  * If the user typed control_c at the prompt, clear the queues.
  *
@@ -1073,11 +1834,16 @@ static int tgdb_handle_sigchld(struct tgdb *tgdb)
 static void tgdb_handle_control_c(struct tgdb *tgdb)
 {
     if (tgdb->control_c) {
-        tgdb_request_ptr_list::iterator iter = tgdb->command_requests->begin();
-        for (; iter != tgdb->command_requests->end(); ++iter) {
+        // The front end may make new requests as it is told about the
+        // dropped ones, those are kept
+        tgdb_request_ptr_list dropped;
+        dropped.swap(*tgdb->command_requests);
+
+        tgdb_request_ptr_list::iterator iter = dropped.begin();
+        for (; iter != dropped.end(); ++iter) {
+            tgdb_fail_request(tgdb, *iter);
             tgdb_request_destroy(*iter);
         }
-        tgdb->command_requests->clear();
 
         tgdb->control_c = 0;
     }
@@ -1088,76 +1854,102 @@ static void tgdb_handle_control_c(struct tgdb *tgdb)
 // to determine if this gdb supports the new-ui command or not.
 // If the string is found, set tgdb->gdb_supports_new_ui_command to false
 static void tgdb_search_for_unsupported_new_ui_message(
-        struct tgdb *tgdb, const std::string &console_output)
+        struct tgdb *tgdb, const char *data, size_t size)
 {
-    static const char *new_ui_text = "Undefined command: \"new-ui\".";
-    
-    (*tgdb->undefined_new_ui_command) += console_output;
+    static const char new_ui_text[] = "Undefined command: \"new-ui\".";
+    static const size_t new_ui_length = sizeof(new_ui_text) - 1;
+    std::string &output = *tgdb->undefined_new_ui_command;
+    size_t start = 0, newline;
 
-    std::istringstream ss(*tgdb->undefined_new_ui_command);
-    std::string line;
-    while (getline(ss, line)) {
-        if (line.find(new_ui_text) == 0) {
+    output.append(data, size);
+
+    // Check the start of every line
+    for (;;) {
+        if (output.compare(start, new_ui_length, new_ui_text) == 0) {
             tgdb->gdb_supports_new_ui_command = false;
             break;
         }
+
+        newline = output.find('\n', start);
+        if (newline == std::string::npos)
+            break;
+        start = newline + 1;
     }
 
     // Remove everything up to the last newline character so that
     // only newly added new lines are searched
-    size_t pos = tgdb->undefined_new_ui_command->find_last_of("\n");
-    if (pos != std::string::npos) {
-        *tgdb->undefined_new_ui_command = 
-                tgdb->undefined_new_ui_command->substr(pos);
-    }
+    newline = output.rfind('\n');
+    if (newline != std::string::npos)
+        output.erase(0, newline + 1);
 }
 
-int tgdb_process(struct tgdb * tgdb, int fd)
+// The most I/O thread events handled by one call to tgdb_process
+#define TGDB_PROCESS_MAX_EVENTS 64
+
+int tgdb_process(struct tgdb *tgdb)
 {
-    const int n = 4096;
-    static char buf[n];
-    ssize_t size;
+    struct tgdb_io_event event;
     int result = 0;
+    int i;
 
     // If ^c has been typed at the prompt, clear the queues
     tgdb_handle_control_c(tgdb);
 
-    size = io_read(fd, buf, n);
-    if (size < 0) {
-        // Error reading from GDB
-        clog_error(CLOG_CGDB, "Error reading from gdb's stdout, closing down");
-        result = -1;
-        tgdb_add_quit_command(tgdb, false);
-    } else if (size == 0) {
-        // Read EOF from GDB
-        clog_info(CLOG_GDBIO, "read EOF from GDB, closing down");
-        tgdb_add_quit_command(tgdb, false);
-    } else {
-        if (fd == tgdb->debugger_stdout) {
-            // Read some GDB console output, process it
-            std::string str = sys_quote_nonprintables(buf, size);
-            clog_debug(CLOG_GDBIO, "%s", str.c_str());
-            std::string msg(buf, size);
-
-            // Determine if this gdb supports the new-ui command.
-            // If it does not, send the quit command to alert the user
-            // that they need a newer gdb.
-            tgdb_search_for_unsupported_new_ui_message(tgdb, msg);
-            if (!tgdb->gdb_supports_new_ui_command) {
-                tgdb_add_quit_command(tgdb, true);
-            }
+    // Clear the descriptor before taking the events, so that an event
+    // added from here on wakes the caller up again
+    tgdb_io_clear_fd(tgdb->io);
 
-            tgdb->callbacks.console_output_callback(
-                    tgdb->callbacks.context, msg);
-        } else if (fd == tgdb->gdb_mi_ui_fd){
-            // Read some GDB console output, process it
-            std::string msg(buf, size);
-            clog_debug(CLOG_GDBMIIO, "%s", msg.c_str());
-            tgdb_commands_process(tgdb, msg);
-        } else {
+    for (i = 0; i < TGDB_PROCESS_MAX_EVENTS; ++i) {
+        if (!tgdb_io_pop(tgdb->io, &event))
+            break;
+
+        switch (event.kind) {
+            case TGDB_IO_CONSOLE:
+                // Determine if this gdb supports the new-ui command.
+                // If it does not, send the quit command to alert the user
+                // that they need a newer gdb.
+                if (!tgdb->new_ui_confirmed) {
+                    tgdb_search_for_unsupported_new_ui_message(tgdb,
+                            event.data, event.size);
+                    if (!tgdb->gdb_supports_new_ui_command) {
+                        tgdb_add_quit_command(tgdb, true);
+                    }
+                }
+
+                tgdb->callbacks.console_output_callback(
+                        tgdb->callbacks.context, event.data, event.size);
+                break;
+            case TGDB_IO_MI:
+                // Ownership of the parsed output passes to
+                // tgdb_commands_process
+                tgdb_commands_process(tgdb, event.output);
+                event.output = NULL;
+                break;
+            case TGDB_IO_EOF:
+                // Read EOF from GDB
+                clog_info(CLOG_GDBIO, "read EOF from GDB, closing down");
+                tgdb_add_quit_command(tgdb, false);
+                break;
+            case TGDB_IO_ERROR:
+                // Error reading from GDB
+                clog_error(CLOG_CGDB,
+                        "Error reading from gdb's stdout, closing down");
+                result = -1;
+                tgdb_add_quit_command(tgdb, false);
+                break;
         }
+
+        tgdb_io_event_free(&event);
+
+        if (result == -1)
+            break;
     }
 
+    // Leave the rest for the next call, so that a flood of output from
+    // GDB can not starve the caller's other input
+    if (i == TGDB_PROCESS_MAX_EVENTS)
+        tgdb_io_wakeup(tgdb->io);
+
     return result;
 }
 
@@ -1212,14 +2004,8 @@ static int tgdb_delete_response(struct tgdb_response *com)
         }
         case TGDB_UPDATE_SOURCE_FILES:
         {
-            int i;
-            char **source_files = com->choice.update_source_files.source_files;
-
-            for (i = 0; i < sbcount(source_files); i++) {
-                free(source_files[i]);
-            }
-            sbfree(source_files);
-
+            tgdb_free_source_files(
+                    com->choice.update_source_files.source_files);
             com->choice.update_source_files.source_files = NULL;
             break;
         }
@@ -1235,6 +2021,74 @@ static int tgdb_delete_response(struct tgdb_response *com)
             sbfree(disasm);
             break;
         }
+        case TGDB_UPDATE_STACK_FRAMES:
+            tgdb_free_frames(com->choice.update_stack_frames.frames);
+            com->choice.update_stack_frames.frames = NULL;
+            break;
+        case TGDB_UPDATE_FRAME_FILES: {
+            int i;
+            char **paths = com->choice.update_frame_files.paths;
+
+            for (i = 0; i < sbcount(paths); i++) {
+                free(paths[i]);
+            }
+            sbfree(paths);
+            com->choice.update_frame_files.paths = NULL;
+            break;
+        }
+        case TGDB_UPDATE_STACK_VARIABLES: {
+            int i;
+            char **names = com->choice.update_stack_variables.names;
+
+            for (i = 0; i < sbcount(names); i++) {
+                free(names[i]);
+            }
+            sbfree(names);
+            com->choice.update_stack_variables.names = NULL;
+            break;
+        }
+        case TGDB_UPDATE_VAR_CREATE:
+            tgdb_free_varobj(&com->choice.update_var_create.var);
+            free(com->choice.update_var_create.error);
+            com->choice.update_var_create.error = NULL;
+            break;
+        case TGDB_UPDATE_VAR_CHILDREN:
+            free(com->choice.update_var_children.name);
+            com->choice.update_var_children.name = NULL;
+            tgdb_free_varobjs(com->choice.update_var_children.children);
+            com->choice.update_var_children.children = NULL;
+            break;
+        case TGDB_UPDATE_VAR_CHANGES:
+            tgdb_free_varobjs(com->choice.update_var_changes.changes);
+            com->choice.update_var_changes.changes = NULL;
+            break;
+        case TGDB_UPDATE_MEMORY:
+            free(com->choice.update_memory.address);
+            com->choice.update_memory.address = NULL;
+            tgdb_free_memory(com->choice.update_memory.blocks);
+            com->choice.update_memory.blocks = NULL;
+            break;
+        case TGDB_UPDATE_THREAD_INFO:
+            tgdb_free_thread(&com->choice.update_thread_info.thread);
+            break;
+        case TGDB_UPDATE_REGISTER_NAMES:
+            tgdb_free_register_names(com->choice.update_register_names.names);
+            com->choice.update_register_names.names = NULL;
+            break;
+        case TGDB_UPDATE_CHANGED_REGISTERS:
+            sbfree(com->choice.update_changed_registers.numbers);
+            com->choice.update_changed_registers.numbers = NULL;
+            break;
+        case TGDB_UPDATE_REGISTER_VALUES:
+            tgdb_free_registers(com->choice.update_register_values.registers);
+            com->choice.update_register_values.registers = NULL;
+            break;
+        case TGDB_MEMORY_CHANGED:
+        case TGDB_THREADS_CHANGED:
+        case TGDB_UPDATE_STACK_DEPTH:
+        case TGDB_INFERIOR_RUNNING:
+        case TGDB_INFERIOR_STOPPED:
+        case TGDB_INFERIOR_EXITED:
         case TGDB_QUIT:
             break;
     }
@@ -1251,6 +2105,15 @@ void tgdb_send_response(struct tgdb *tgdb, struct tgdb_response *response)
     tgdb_delete_response(response);
 }
 
+void tgdb_set_read_limits(struct tgdb *tgdb, int size, int budget)
+{
+    tgdb->read_size = size;
+    tgdb->read_budget = budget;
+
+    if (tgdb->io)
+        tgdb_io_set_read_limits(tgdb->io, size, budget);
+}
+
 int tgdb_resize_console(struct tgdb *tgdb, int rows, int cols)
 {
     struct winsize size;
@@ -1283,6 +2146,11 @@ void tgdb_request_inferiors_source_files(struct tgdb * tgdb)
 {
     tgdb_request_ptr request_ptr;
 
+    if (tgdb->source_files_valid) {
+        tgdb_commands_send_cached_source_files(tgdb);
+        return;
+    }
+
     request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
 
     request_ptr->header = TGDB_REQUEST_INFO_SOURCES;
@@ -1383,10 +2251,225 @@ void tgdb_request_until_line(struct tgdb *tgdb,
     tgdb_run_or_queue_request(tgdb, request_ptr, false);
 }
 
+void tgdb_request_stack_depth(struct tgdb *tgdb, int max_depth)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_STACK_DEPTH;
+
+    request_ptr->choice.stack_depth.max_depth = max_depth;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_stack_frames(struct tgdb *tgdb, int low, int high)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_STACK_FRAMES;
+
+    request_ptr->choice.stack_frames.low = low;
+    request_ptr->choice.stack_frames.high = high;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_frame_files(struct tgdb *tgdb, int count)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_FRAME_FILES;
+
+    request_ptr->choice.stack_frames.low = 0;
+    request_ptr->choice.stack_frames.high = count - 1;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_select_frame(struct tgdb *tgdb, int level)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_SELECT_FRAME;
+
+    request_ptr->choice.select_frame.level = level;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_stack_variables(struct tgdb *tgdb)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_STACK_VARIABLES;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_var_create(struct tgdb *tgdb, const char *name,
+        const char *expression)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_VAR_CREATE;
+
+    request_ptr->choice.var.name = cgdb_strdup(name);
+    request_ptr->choice.var.expression = cgdb_strdup(expression);
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_var_children(struct tgdb *tgdb, const char *name,
+        int from, int to)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_VAR_CHILDREN;
+
+    request_ptr->choice.var.name = cgdb_strdup(name);
+    request_ptr->choice.var.expression = NULL;
+    request_ptr->choice.var.from = from;
+    request_ptr->choice.var.to = to;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_var_update(struct tgdb *tgdb)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_VAR_UPDATE;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_var_delete(struct tgdb *tgdb, const char *name,
+        int children_only)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_VAR_DELETE;
+
+    request_ptr->choice.var.name = cgdb_strdup(name);
+    request_ptr->choice.var.expression = NULL;
+    request_ptr->choice.var.children_only = children_only;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_read_memory(struct tgdb *tgdb, const char *address,
+        int count)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_READ_MEMORY;
+
+    request_ptr->choice.read_memory.address = cgdb_strdup(address);
+    request_ptr->choice.read_memory.count = count;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+int tgdb_thread_count(struct tgdb *tgdb)
+{
+    return tgdb->thread_ids->size();
+}
+
+int tgdb_thread_id(struct tgdb *tgdb, int index)
+{
+    if (index < 0 || index >= (int)tgdb->thread_ids->size())
+        return 0;
+
+    return (*tgdb->thread_ids)[index];
+}
+
+void tgdb_request_thread_info(struct tgdb *tgdb, int id)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_THREAD_INFO;
+
+    request_ptr->choice.thread.id = id;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_select_thread(struct tgdb *tgdb, int id)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_SELECT_THREAD;
+
+    request_ptr->choice.thread.id = id;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_register_names(struct tgdb *tgdb)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_REGISTER_NAMES;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_changed_registers(struct tgdb *tgdb)
+{
+    tgdb_request_ptr request_ptr;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_CHANGED_REGISTERS;
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
+void tgdb_request_register_values(struct tgdb *tgdb, int *numbers)
+{
+    tgdb_request_ptr request_ptr;
+    int i;
+
+    request_ptr = (tgdb_request_ptr)cgdb_malloc(sizeof (struct tgdb_request));
+    request_ptr->header = TGDB_REQUEST_REGISTER_VALUES;
+
+    request_ptr->choice.register_values.numbers = NULL;
+    for (i = 0; i < sbcount(numbers); i++) {
+        sbpush(request_ptr->choice.register_values.numbers, numbers[i]);
+    }
+
+    tgdb_run_or_queue_request(tgdb, request_ptr, false);
+}
+
 /* }}}*/
 
 /* Process {{{*/
 
+/* Append str to command as an mi c-string, so spaces and quotes in an
+ * expression survive */
+static void tgdb_append_mi_cstring(std::string &command, const char *str)
+{
+    command.push_back('"');
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\')
+            command.push_back('\\');
+        command.push_back(*str);
+    }
+    command.push_back('"');
+}
+
 int tgdb_get_gdb_command(struct tgdb *tgdb, tgdb_request_ptr request,
         std::string &command)
 {
@@ -1449,6 +2532,99 @@ int tgdb_get_gdb_command(struct tgdb *tgdb, tgdb_request_ptr request,
             free(str);
             str = NULL;
             break;
+        case TGDB_REQUEST_STACK_DEPTH:
+            str = sys_aprintf("-stack-info-depth %d\n",
+                    request->choice.stack_depth.max_depth);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_STACK_FRAMES:
+        case TGDB_REQUEST_FRAME_FILES:
+            str = sys_aprintf("-stack-list-frames %d %d\n",
+                    request->choice.stack_frames.low,
+                    request->choice.stack_frames.high);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_SELECT_FRAME:
+            str = sys_aprintf("-stack-select-frame %d\n",
+                    request->choice.select_frame.level);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_STACK_VARIABLES:
+            command = "-stack-list-variables --no-values\n";
+            break;
+        case TGDB_REQUEST_VAR_CREATE:
+            command = "-var-create ";
+            command.append(request->choice.var.name);
+            command.append(" @ ");
+            tgdb_append_mi_cstring(command, request->choice.var.expression);
+            command.push_back('\n');
+            break;
+        case TGDB_REQUEST_VAR_CHILDREN:
+            str = sys_aprintf("-var-list-children --all-values %s %d %d\n",
+                    request->choice.var.name,
+                    request->choice.var.from,
+                    request->choice.var.to);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_VAR_UPDATE:
+            command = "-var-update --all-values *\n";
+            break;
+        case TGDB_REQUEST_VAR_DELETE:
+            str = sys_aprintf("-var-delete %s%s\n",
+                    request->choice.var.children_only ? "-c " : "",
+                    request->choice.var.name);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_REGISTER_NAMES:
+            command = "-data-list-register-names\n";
+            break;
+        case TGDB_REQUEST_CHANGED_REGISTERS:
+            command = "-data-list-changed-registers\n";
+            break;
+        case TGDB_REQUEST_REGISTER_VALUES: {
+            int *numbers = request->choice.register_values.numbers;
+            int i;
+
+            command = "-data-list-register-values x";
+            for (i = 0; i < sbcount(numbers); i++) {
+                command.push_back(' ');
+                command.append(std::to_string(numbers[i]));
+            }
+            command.push_back('\n');
+            break;
+        }
+        case TGDB_REQUEST_THREAD_INFO:
+            str = sys_aprintf("-thread-info %d\n", request->choice.thread.id);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_SELECT_THREAD:
+            str = sys_aprintf("-thread-select %d\n",
+                    request->choice.thread.id);
+            command = str;
+            free(str);
+            str = NULL;
+            break;
+        case TGDB_REQUEST_READ_MEMORY:
+            command = "-data-read-memory-bytes ";
+            tgdb_append_mi_cstring(command,
+                    request->choice.read_memory.address);
+            str = sys_aprintf(" %d\n", request->choice.read_memory.count);
+            command.append(str);
+            free(str);
+            str = NULL;
+            break;
         case TGDB_REQUEST_DISASSEMBLE_FUNC: {
             /* GDB 7.11 adds /s command to disassemble
 
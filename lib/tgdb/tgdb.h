@@ -93,6 +93,103 @@
         char *func;
     };
 
+    // This structure represents a frame of the stack
+    struct tgdb_frame {
+        // The level of the frame, 0 is the innermost frame
+        int level;
+
+        // The $pc of the frame or 0 if unknown
+        uint64_t addr;
+
+        // Function name or NULL if unknown
+        char *func;
+
+        // The file name as gdb knows it, or NULL if unknown
+        char *file;
+
+        // The absolute path to the file, or NULL if unknown
+        char *fullname;
+
+        // The line number in the file or 0 if unknown
+        int line;
+
+        // Shared library where this function is defined or NULL if unknown
+        char *from;
+    };
+
+    // This structure represents a gdb/mi variable object
+    struct tgdb_varobj {
+        // The name gdb knows the variable object by, like var1.a
+        char *name;
+
+        // The expression, or for a child the field name or index.
+        // NULL in a change from -var-update.
+        char *exp;
+
+        // The value or NULL if unknown
+        char *value;
+
+        // The type or NULL if unknown or unchanged
+        char *type;
+
+        // The number of children, or -1 if unknown or unchanged.
+        // For a pretty printed container, the children known so far.
+        int numchild;
+
+        // True if a pretty printed container may have more children
+        int has_more;
+
+        // For a change, 1 if the variable is in scope, 0 if not and
+        // -1 if the variable object can no longer be used
+        int in_scope;
+
+        // For a change, true if the type changed. The children of the
+        // variable object have been deleted then.
+        int type_changed;
+    };
+
+    // This structure represents a thread of the inferior
+    struct tgdb_thread {
+        // The number gdb gave the thread
+        int id;
+
+        // The thread as the target knows it, like Thread 0x7ffff (LWP 12)
+        char *target_id;
+
+        // The name of the thread or NULL if it has none
+        char *name;
+
+        // The function the thread is in or NULL if unknown
+        char *func;
+
+        // The file the thread is in or NULL if unknown
+        char *file;
+
+        // The line in the file or 0 if unknown
+        int line;
+
+        // True if the thread is running
+        int running;
+    };
+
+    // This structure represents the value of a register
+    struct tgdb_register {
+        // The number gdb gave the register
+        int number;
+
+        // The value, in hex
+        char *value;
+    };
+
+    // This structure represents memory of the inferior that could be read
+    struct tgdb_memory_block {
+        // The address of the first byte
+        uint64_t addr;
+
+        // The bytes, sbcount(bytes) is the length of the block
+        unsigned char *bytes;
+    };
+
     enum tgdb_request_type {
         // Get a list of all the source files in the program being debugged
         TGDB_REQUEST_INFO_SOURCES,
@@ -162,12 +259,65 @@
         TGDB_REQUEST_DISASSEMBLE_FUNC,
 
         // Request GDB to skip to the given line.
-        TGDB_REQUEST_UNTIL_LINE
+        TGDB_REQUEST_UNTIL_LINE,
+
+        // Count the frames of the stack, up to a limit.
+        //
+        // Walking a deep stack is slow, so the count is capped, see
+        // tgdb_request_stack_depth.
+        TGDB_REQUEST_STACK_DEPTH,
+
+        // Get a range of frames of the stack.
+        TGDB_REQUEST_STACK_FRAMES,
+
+        // Get the source files of the top frames of the stack.
+        TGDB_REQUEST_FRAME_FILES,
+
+        // Select a frame of the stack.
+        TGDB_REQUEST_SELECT_FRAME,
+
+        // Get the names of the arguments and locals of the selected frame.
+        TGDB_REQUEST_STACK_VARIABLES,
+
+        // Create a variable object.
+        TGDB_REQUEST_VAR_CREATE,
+
+        // Get a range of the children of a variable object.
+        TGDB_REQUEST_VAR_CHILDREN,
+
+        // Get the values of all variable objects that changed.
+        TGDB_REQUEST_VAR_UPDATE,
+
+        // Delete a variable object and its children, or only its children.
+        TGDB_REQUEST_VAR_DELETE,
+
+        // Read memory of the inferior.
+        TGDB_REQUEST_READ_MEMORY,
+
+        // Get the details of a thread.
+        TGDB_REQUEST_THREAD_INFO,
+
+        // Select a thread.
+        TGDB_REQUEST_SELECT_THREAD,
+
+        // Get the names of the registers.
+        TGDB_REQUEST_REGISTER_NAMES,
+
+        // Get the registers that changed since the last time they were
+        // asked for.
+        TGDB_REQUEST_CHANGED_REGISTERS,
+
+        // Get the values of some registers.
+        TGDB_REQUEST_REGISTER_VALUES
     };
 
     // This is the commands interface used between the front end and TGDB.
     // When TGDB is responding to a request or when an event is being generated
     // the front end will find out about it through one of these enums.
+    //
+    // The requests of the info window, like tgdb_request_stack_frames, are
+    // each answered once, in the order they were made. One that ^c drops
+    // before it gets to gdb is answered with an error.
     enum tgdb_response_type {
 
         // All breakpoints that are set
@@ -188,6 +338,60 @@
         // Disassemble function output
         TGDB_DISASSEMBLE_FUNC,
 
+        // The number of frames in the stack, see tgdb_request_stack_depth
+        TGDB_UPDATE_STACK_DEPTH,
+
+        // A range of frames of the stack, see tgdb_request_stack_frames
+        TGDB_UPDATE_STACK_FRAMES,
+
+        // The source files of the top frames, see tgdb_request_frame_files
+        TGDB_UPDATE_FRAME_FILES,
+
+        // The inferior is running. Anything the front end read about the
+        // stack, variables or memory of the inferior is out of date.
+        TGDB_INFERIOR_RUNNING,
+
+        // The inferior stopped, or the user selected another thread or
+        // frame.
+        TGDB_INFERIOR_STOPPED,
+
+        // The inferior exited or was killed.
+        TGDB_INFERIOR_EXITED,
+
+        // The arguments and locals of the selected frame,
+        // see tgdb_request_stack_variables
+        TGDB_UPDATE_STACK_VARIABLES,
+
+        // A variable object was created, see tgdb_request_var_create
+        TGDB_UPDATE_VAR_CREATE,
+
+        // Some children of a variable object, see tgdb_request_var_children
+        TGDB_UPDATE_VAR_CHILDREN,
+
+        // The variable objects that changed, see tgdb_request_var_update
+        TGDB_UPDATE_VAR_CHANGES,
+
+        // Memory of the inferior, see tgdb_request_read_memory
+        TGDB_UPDATE_MEMORY,
+
+        // The user changed memory of the inferior, from the gdb console.
+        TGDB_MEMORY_CHANGED,
+
+        // A thread was created or exited, see tgdb_thread_count
+        TGDB_THREADS_CHANGED,
+
+        // The details of a thread, see tgdb_request_thread_info
+        TGDB_UPDATE_THREAD_INFO,
+
+        // The names of the registers, see tgdb_request_register_names
+        TGDB_UPDATE_REGISTER_NAMES,
+
+        // The registers that changed, see tgdb_request_changed_registers
+        TGDB_UPDATE_CHANGED_REGISTERS,
+
+        // The values of registers, see tgdb_request_register_values
+        TGDB_UPDATE_REGISTER_VALUES,
+
         // This happens when gdb quits.
         // You will get no more responses after this one.
         // This is a 'struct tgdb_quit_status *'
@@ -219,8 +423,157 @@
                 char **source_files;
             } update_source_files;
 
+            // header == TGDB_UPDATE_STACK_DEPTH
+            struct {
+                // The number of frames, never more than the limit asked for
+                int depth;
+
+                // True if gdb could not count the frames, for instance
+                // because there is no stack. Depth is 0 then.
+                int error;
+            } update_stack_depth;
+
+            // header == TGDB_UPDATE_STACK_FRAMES
+            struct {
+                // The frames, in order of level
+                struct tgdb_frame *frames;
+
+                // True if gdb could not get the frames. Frames is NULL then.
+                int error;
+            } update_stack_frames;
+
+            // header == TGDB_UPDATE_FRAME_FILES
+            struct {
+                // The full paths of the source files, in order of level.
+                // Frames without a source file are left out.
+                char **paths;
+
+                // True if gdb could not get the frames
+                int error;
+            } update_frame_files;
+
+            // header == TGDB_INFERIOR_STOPPED
+            struct {
+                // The thread that stopped or was selected, or 0 if unknown
+                int thread_id;
+            } inferior_stopped;
+
+            // header == TGDB_UPDATE_STACK_VARIABLES
+            struct {
+                // The names of the arguments and then the locals
+                char **names;
+
+                // True if gdb could not get the variables, for instance
+                // because there is no stack. Names is NULL then.
+                int error;
+            } update_stack_variables;
+
+            // header == TGDB_UPDATE_VAR_CREATE
+            struct {
+                // The variable object, its name is the one asked for
+                struct tgdb_varobj var;
+
+                // The message from gdb if it could not create the variable
+                // object, like an unknown symbol, otherwise NULL
+                char *error;
+            } update_var_create;
+
+            // header == TGDB_UPDATE_VAR_CHILDREN
+            struct {
+                // The name of the parent variable object
+                char *name;
+
+                // The children, in order
+                struct tgdb_varobj *children;
+
+                // True if a pretty printed container may have more children
+                int has_more;
+
+                // True if gdb could not get the children
+                int error;
+            } update_var_children;
+
+            // header == TGDB_UPDATE_VAR_CHANGES
+            struct {
+                // The variable objects whose value, scope or type changed
+                struct tgdb_varobj *changes;
+            } update_var_changes;
+
+            // header == TGDB_UPDATE_MEMORY
+            struct {
+                // The address expression and the number of bytes, as
+                // passed to tgdb_request_read_memory
+                char *address;
+                int count;
+
+                // The parts of the memory asked for that could be read,
+                // in order of address. Bytes that are not in a block
+                // could not be read.
+                struct tgdb_memory_block *blocks;
+
+                // True if none of the memory could be read
+                int error;
+            } update_memory;
+
+            // header == TGDB_MEMORY_CHANGED
+            struct {
+                // The address of the first byte that changed
+                uint64_t addr;
+
+                // The number of bytes that changed
+                uint64_t len;
+            } memory_changed;
+
+            // header == TGDB_THREADS_CHANGED
+            struct {
+                // The thread that was created or exited
+                int thread_id;
+
+                // True if it exited
+                int exited;
+            } threads_changed;
+
+            // header == TGDB_UPDATE_THREAD_INFO
+            struct {
+                // The thread, its id is the one asked for
+                struct tgdb_thread thread;
+
+                // True if gdb doesn't know the thread, it may have exited
+                int error;
+            } update_thread_info;
+
+            // header == TGDB_UPDATE_REGISTER_NAMES
+            struct {
+                // The names, by register number. The numbers gdb doesn't
+                // use have an empty name.
+                char **names;
+
+                // True if gdb could not get the names
+                int error;
+            } update_register_names;
+
+            // header == TGDB_UPDATE_CHANGED_REGISTERS
+            struct {
+                // The numbers of the registers that changed
+                int *numbers;
+
+                // True if gdb could not tell, for instance because there
+                // is no stack
+                int error;
+            } update_changed_registers;
+
+            // header == TGDB_UPDATE_REGISTER_VALUES
+            struct {
+                // The registers, in the order asked for
+                struct tgdb_register *registers;
+
+                // True if gdb could not get the values
+                int error;
+            } update_register_values;
+
             // header == TGDB_INFERIOR_EXITED
             struct {
+                // The exit code of the program, 0 if it was killed
                 int exit_status;
             } inferior_exited;
 
@@ -273,10 +626,14 @@
          * @param context
          * The context pointer
          *
-         * @param str
-         * The console output
+         * @param data
+         * The console output, not NUL terminated
+         *
+         * @param size
+         * The number of bytes in data
          */
-        void (*console_output_callback)(void *context, const std::string &str);
+        void (*console_output_callback)(void *context,
+                const char *data, size_t size);
 
         /**
          * A command response is available for consumption.
@@ -356,15 +713,13 @@
     // @param gdb_win_cols
     // The number of columns in the gdb console
     //
-    // @param gdb_console_fd
-    // The gdb console file descriptor
-    //
-    // @param gdb_mi_fd
-    // The gdb machine interface file descriptor
+    // @param gdb_fd
+    // The gdb console and machine interface output is read on an I/O
+    // thread. This descriptor becomes readable when some of it is ready,
+    // at which point tgdb_process should be called.
     int tgdb_start_gdb(struct tgdb *tgdb,
             const char *debugger, int argc, char **argv,
-            int gdb_win_rows, int gdb_win_cols, int *gdb_console_fd,
-            int *gdb_mi_fd);
+            int gdb_win_rows, int gdb_win_cols, int *gdb_fd);
 
   /**
    * This function does most of the dirty work in TGDB. It is capable of 
@@ -377,13 +732,12 @@
    * \param tgdb
    * An instance of the tgdb library to operate on.
    *
-   * \param fd
-   * The file descriptor that has input (either the console or mi).
+   * Call this when the descriptor returned by tgdb_start_gdb is readable.
    *
    * @return
    * 0 on sucess, or -1 on error
    */
-    int tgdb_process(struct tgdb *tgdb, int fd);
+    int tgdb_process(struct tgdb *tgdb);
 
     /**
      * Send a character to the gdb console.
@@ -416,6 +770,28 @@
      */
     int tgdb_resize_console(struct tgdb *tgdb, int rows, int cols);
 
+    /**
+     * Set how much of GDB's output is read at once.
+     *
+     * When GDB's output becomes readable, up to size bytes are read.
+     * Any output already waiting after that is read in as well, up to
+     * budget bytes in total, and processed as a single batch. A large
+     * reply is then handled in a few large batches rather than
+     * thousands of small ones.
+     *
+     * This may be called before or after tgdb_start_gdb.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param size
+     * The number of bytes to read at first.
+     *
+     * \param budget
+     * The most bytes to read into a single batch.
+     */
+    void tgdb_set_read_limits(struct tgdb *tgdb, int size, int budget);
+
 /*@}*/
 /* }}}*/
 
@@ -432,6 +808,11 @@
   /**
    * Gets a list of source files that make up the program being debugged.
    *
+   * The list is kept until gdb loads or unloads a library, starts or
+   * exits a program, or the user runs a command that changes the symbols,
+   * like file or symbol-file. Until then, the TGDB_UPDATE_SOURCE_FILES
+   * response is sent right away, without asking gdb again.
+   *
    * \param tgdb
    * An instance of the tgdb library to operate on.
    */
@@ -532,6 +913,258 @@
     void tgdb_request_until_line(struct tgdb *tgdb,
             const char *file, int line, uint64_t addr);
 
+    /**
+     * Count the frames of the stack of the selected thread.
+     *
+     * gdb has to unwind every frame it counts, which takes a long time
+     * for a deep recursion. The count stops at max_depth, so a
+     * TGDB_UPDATE_STACK_DEPTH of max_depth means there may be more.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param max_depth
+     * The most frames to count.
+     */
+    void tgdb_request_stack_depth(struct tgdb *tgdb, int max_depth);
+
+    /**
+     * Get the frames low through high of the stack of the selected thread.
+     *
+     * The frames are sent in a TGDB_UPDATE_STACK_FRAMES response. Fewer
+     * frames are sent if the stack is not that deep.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param low
+     * The level of the first frame to get.
+     *
+     * \param high
+     * The level of the last frame to get.
+     */
+    void tgdb_request_stack_frames(struct tgdb *tgdb, int low, int high);
+
+    /**
+     * Get the source files of the top frames of the stack of the selected
+     * thread, so the front end can load them before the user goes there.
+     *
+     * The paths are sent in a TGDB_UPDATE_FRAME_FILES response, apart
+     * from the frames of tgdb_request_stack_frames.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param count
+     * The number of frames to look at, starting at frame 0.
+     */
+    void tgdb_request_frame_files(struct tgdb *tgdb, int count);
+
+    /**
+     * Select a frame of the stack, like the frame command.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param level
+     * The level of the frame to select.
+     */
+    void tgdb_request_select_frame(struct tgdb *tgdb, int level);
+
+    /**
+     * Get the names of the arguments and locals of the selected frame.
+     *
+     * Only the names are sent, in a TGDB_UPDATE_STACK_VARIABLES response.
+     * Printing the values of big locals is slow, variable objects can get
+     * them as they are needed.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     */
+    void tgdb_request_stack_variables(struct tgdb *tgdb);
+
+    /**
+     * Create a floating variable object.
+     *
+     * The variable object is evaluated again in the selected frame each
+     * time the variable objects are updated, so a variable object for a
+     * local follows the user from frame to frame. The result is sent in a
+     * TGDB_UPDATE_VAR_CREATE response.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param name
+     * The name to give the variable object, unique among the variable
+     * objects the front end made.
+     *
+     * \param expression
+     * The expression to evaluate.
+     */
+    void tgdb_request_var_create(struct tgdb *tgdb, const char *name,
+            const char *expression);
+
+    /**
+     * Get the children from through to - 1 of a variable object.
+     *
+     * The children are sent in a TGDB_UPDATE_VAR_CHILDREN response, with
+     * their values. Fewer are sent if there are not that many children.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param name
+     * The name of the variable object.
+     *
+     * \param from
+     * The index of the first child to get.
+     *
+     * \param to
+     * The index after the last child to get.
+     */
+    void tgdb_request_var_children(struct tgdb *tgdb, const char *name,
+            int from, int to);
+
+    /**
+     * Update all the variable objects.
+     *
+     * A single -var-update compares every variable object to its last
+     * value in gdb, only the ones that changed are sent in a
+     * TGDB_UPDATE_VAR_CHANGES response.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     */
+    void tgdb_request_var_update(struct tgdb *tgdb);
+
+    /**
+     * Delete a variable object and its children.
+     *
+     * gdb updates every variable object on each -var-update, so the
+     * children of a container the user is done with should be deleted.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param name
+     * The name of the variable object.
+     *
+     * \param children_only
+     * True to keep the variable object and only delete its children.
+     */
+    void tgdb_request_var_delete(struct tgdb *tgdb, const char *name,
+            int children_only);
+
+    /**
+     * Read memory of the inferior.
+     *
+     * The bytes are sent in a TGDB_UPDATE_MEMORY response, along with the
+     * address and count asked for. Only the parts that could be read are
+     * sent.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param address
+     * An expression for the address of the first byte, like 0x601040 or
+     * &buf. The address of each block read is in the response.
+     *
+     * \param count
+     * The number of bytes to read.
+     */
+    void tgdb_request_read_memory(struct tgdb *tgdb, const char *address,
+            int count);
+
+    /**
+     * Get the number of threads of the inferior.
+     *
+     * tgdb keeps the thread numbers from the =thread-created and
+     * =thread-exited notifications, so the threads never have to be
+     * listed. A TGDB_THREADS_CHANGED response is sent when they change.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \return
+     * The number of threads.
+     */
+    int tgdb_thread_count(struct tgdb *tgdb);
+
+    /**
+     * Get the number gdb gave a thread.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param index
+     * The index of the thread, from 0 to tgdb_thread_count - 1. The
+     * threads are in the order they were created.
+     *
+     * \return
+     * The number of the thread, or 0 if index is out of range.
+     */
+    int tgdb_thread_id(struct tgdb *tgdb, int index);
+
+    /**
+     * Get the details of a thread, like where it is.
+     *
+     * The details are sent in a TGDB_UPDATE_THREAD_INFO response.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param id
+     * The number of the thread.
+     */
+    void tgdb_request_thread_info(struct tgdb *tgdb, int id);
+
+    /**
+     * Select a thread, like the thread command.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param id
+     * The number of the thread.
+     */
+    void tgdb_request_select_thread(struct tgdb *tgdb, int id);
+
+    /**
+     * Get the names of the registers of the architecture.
+     *
+     * The names are sent in a TGDB_UPDATE_REGISTER_NAMES response.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     */
+    void tgdb_request_register_names(struct tgdb *tgdb);
+
+    /**
+     * Get the registers whose value changed since the last time this was
+     * asked, in the selected frame.
+     *
+     * Only the numbers are sent, in a TGDB_UPDATE_CHANGED_REGISTERS
+     * response, so the values can be read for just the registers shown.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     */
+    void tgdb_request_changed_registers(struct tgdb *tgdb);
+
+    /**
+     * Get the values of registers in the selected frame, in hex.
+     *
+     * The values are sent in a TGDB_UPDATE_REGISTER_VALUES response.
+     *
+     * \param tgdb
+     * An instance of the tgdb library to operate on.
+     *
+     * \param numbers
+     * The numbers of the registers, sbcount(numbers) of them. tgdb makes
+     * its own copy.
+     */
+    void tgdb_request_register_values(struct tgdb *tgdb, int *numbers);
+
 /*@}*/
 /* }}}*/
 
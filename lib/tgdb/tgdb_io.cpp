@@ -0,0 +1,468 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+
+#if HAVE_ERRNO_H
+#include <errno.h>
+#endif /* HAVE_ERRNO_H */
+
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif /* HAVE_FCNTL_H */
+
+#if HAVE_SIGNAL_H
+#include <signal.h>
+#endif /* HAVE_SIGNAL_H */
+
+#if HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif /* HAVE_SYS_SELECT_H */
+
+#if HAVE_SYS_IOCTL_H
+#include <sys/ioctl.h> /* FIONREAD */
+#endif /* HAVE_SYS_IOCTL_H */
+
+#if HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif /* HAVE_SYS_EVENTFD_H */
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "tgdb_io.h"
+#include "tgdb_io_ring.h"
+#include "io.h"
+#include "sys_util.h"
+#include "cgdb_clog.h"
+#include "gdbwire.h"
+
+/**
+ * A descriptor that can be made readable from another thread.
+ *
+ * This is an eventfd where available, otherwise a pipe. For an eventfd
+ * both ends are the same descriptor.
+ */
+struct tgdb_io_notify {
+    int fds[2];
+};
+
+struct tgdb_io {
+    int console_fd;
+    int mi_fd;
+
+    /* The parser for the mi output, only used on the I/O thread */
+    struct gdbwire_mi_parser *parser;
+
+    tgdb_io_ring console_ring;
+    tgdb_io_ring mi_ring;
+
+    /* See tgdb_io_set_read_limits */
+    std::atomic<int> read_size;
+    std::atomic<int> read_budget;
+
+    /* The buffer a batch is read into, only used on the I/O thread.
+     * It starts at read_size bytes and grows up to read_budget bytes. */
+    char *buf;
+    size_t buf_size;
+
+    /* Readable when events are waiting, given to the caller */
+    struct tgdb_io_notify ui_notify;
+
+    /* Readable when the I/O thread should look at stop or waiting */
+    struct tgdb_io_notify thread_notify;
+
+    /* Set when the I/O thread should exit */
+    std::atomic<bool> stop;
+
+    /* Set while the I/O thread waits for room in a ring */
+    std::atomic<bool> waiting;
+
+    /* True if events were pushed since the user interface was woken up,
+     * only used on the I/O thread */
+    bool pushed;
+
+    std::thread thread;
+};
+
+static int tgdb_io_notify_open(struct tgdb_io_notify *notify)
+{
+#if HAVE_SYS_EVENTFD_H
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1) {
+        clog_error(CLOG_CGDB, "eventfd failed: %s", strerror(errno));
+        return -1;
+    }
+
+    notify->fds[0] = notify->fds[1] = fd;
+#else
+    int i;
+
+    if (pipe(notify->fds) == -1) {
+        clog_error(CLOG_CGDB, "pipe failed: %s", strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        int flags = fcntl(notify->fds[i], F_GETFL);
+        fcntl(notify->fds[i], F_SETFL, flags | O_NONBLOCK);
+        fcntl(notify->fds[i], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+
+    return 0;
+}
+
+static void tgdb_io_notify_close(struct tgdb_io_notify *notify)
+{
+    if (notify->fds[0] != -1)
+        cgdb_close(notify->fds[0]);
+    if (notify->fds[1] != -1 && notify->fds[1] != notify->fds[0])
+        cgdb_close(notify->fds[1]);
+
+    notify->fds[0] = notify->fds[1] = -1;
+}
+
+static void tgdb_io_notify_signal(struct tgdb_io_notify *notify)
+{
+#if HAVE_SYS_EVENTFD_H
+    uint64_t value = 1;
+    ssize_t result = write(notify->fds[1], &value, sizeof(value));
+#else
+    char c = 0;
+    ssize_t result = write(notify->fds[1], &c, 1);
+#endif
+
+    /* A full pipe or counter is already readable */
+    if (result == -1 && errno != EAGAIN)
+        clog_error(CLOG_CGDB, "write failed: %s", strerror(errno));
+}
+
+static void tgdb_io_notify_clear(struct tgdb_io_notify *notify)
+{
+#if HAVE_SYS_EVENTFD_H
+    uint64_t value;
+    while (read(notify->fds[0], &value, sizeof(value)) > 0)
+        ;
+#else
+    char buf[64];
+    while (read(notify->fds[0], buf, sizeof(buf)) > 0)
+        ;
+#endif
+}
+
+/* Block the I/O thread until thread_notify is signaled */
+static void tgdb_io_notify_wait(struct tgdb_io *io)
+{
+    int fd = io->thread_notify.fds[0];
+    fd_set rset;
+
+    FD_ZERO(&rset);
+    FD_SET(fd, &rset);
+
+    if (select(fd + 1, &rset, NULL, NULL, NULL) == -1 && errno != EINTR)
+        clog_error(CLOG_CGDB, "select failed: %s", strerror(errno));
+
+    tgdb_io_notify_clear(&io->thread_notify);
+}
+
+/**
+ * Push an event, waiting for room in the ring if it is full.
+ *
+ * Returns true if the event was pushed, or false if the I/O thread is
+ * stopping. The caller still owns the event in that case.
+ */
+static bool tgdb_io_push(struct tgdb_io *io, tgdb_io_ring &ring,
+        const tgdb_io_event &event)
+{
+    while (!ring.push(event)) {
+        /* Announce the wait before checking again, tgdb_io_pop checks
+         * waiting after making room, so one of the two sees the other. */
+        io->waiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (ring.push(event))
+            break;
+
+        /* The events already in the ring may not have been announced */
+        tgdb_io_notify_signal(&io->ui_notify);
+        io->pushed = false;
+
+        tgdb_io_notify_wait(io);
+
+        if (io->stop.load())
+            return false;
+    }
+
+    io->pushed = true;
+
+    return true;
+}
+
+static void tgdb_io_push_status(struct tgdb_io *io, tgdb_io_ring &ring,
+        enum tgdb_io_event_kind kind)
+{
+    tgdb_io_event event = { kind, NULL, 0, NULL };
+    tgdb_io_push(io, ring, event);
+}
+
+/* Called by gdbwire on the I/O thread for every complete mi record */
+static void tgdb_io_mi_output(void *context, struct gdbwire_mi_output *output)
+{
+    struct tgdb_io *io = (struct tgdb_io *)context;
+    tgdb_io_event event = { TGDB_IO_MI, NULL, 0, output };
+
+    if (!tgdb_io_push(io, io->mi_ring, event))
+        gdbwire_mi_output_free(output);
+}
+
+/* Make room for size bytes in the read buffer */
+static void tgdb_io_reserve(struct tgdb_io *io, size_t size)
+{
+    if (io->buf_size < size) {
+        io->buf_size = std::max(size, io->buf_size * 2);
+        io->buf = (char *)cgdb_realloc(io->buf, io->buf_size);
+    }
+}
+
+/**
+ * Read a batch from a descriptor that select reported as readable.
+ *
+ * The first read takes up to read_size bytes. After that, as long as the
+ * descriptor reports more bytes waiting, they are read in as well, until
+ * read_budget bytes are read. The whole batch is then handed over, or
+ * parsed, at once.
+ *
+ * Returns 0 on success, or -1 if the descriptor should no longer be read.
+ */
+static int tgdb_io_read(struct tgdb_io *io, int fd)
+{
+    tgdb_io_ring &ring = (fd == io->mi_fd) ? io->mi_ring : io->console_ring;
+    size_t budget = io->read_budget.load();
+    size_t size = io->read_size.load();
+    ssize_t count;
+
+    tgdb_io_reserve(io, size);
+
+    count = io_read(fd, io->buf, size);
+    if (count < 0) {
+        tgdb_io_push_status(io, ring, TGDB_IO_ERROR);
+        return -1;
+    } else if (count == 0) {
+        tgdb_io_push_status(io, ring, TGDB_IO_EOF);
+        return -1;
+    }
+
+    /* Drain what is already waiting. The descriptors are shared with
+     * the writers on the user interface thread, so they stay blocking
+     * and FIONREAD stands in for reading until EAGAIN. An error or EOF
+     * here is left for the next select to report. */
+    size = count;
+    while (size < budget) {
+        int waiting = 0;
+
+        if (ioctl(fd, FIONREAD, &waiting) == -1 || waiting <= 0)
+            break;
+
+        waiting = std::min<size_t>(waiting, budget - size);
+        tgdb_io_reserve(io, size + waiting);
+
+        count = io_read(fd, io->buf + size, waiting);
+        if (count <= 0)
+            break;
+
+        size += count;
+    }
+
+    if (fd == io->mi_fd) {
+        clog_debug(CLOG_GDBMIIO, "%s", std::string(io->buf, size).c_str());
+
+        /* The records are pushed from tgdb_io_mi_output */
+        gdbwire_mi_parser_push_data(io->parser, io->buf, size);
+    } else {
+        std::string str = sys_quote_nonprintables(io->buf, size);
+        clog_debug(CLOG_GDBIO, "%s", str.c_str());
+
+        tgdb_io_event event = { TGDB_IO_CONSOLE,
+            (char *)cgdb_malloc(size), size, NULL };
+        memcpy(event.data, io->buf, size);
+
+        if (!tgdb_io_push(io, ring, event))
+            free(event.data);
+    }
+
+    return 0;
+}
+
+static void tgdb_io_thread(struct tgdb_io *io)
+{
+    int fds[2] = { io->mi_fd, io->console_fd };
+    int i;
+
+    while (!io->stop.load()) {
+        int max = io->thread_notify.fds[0];
+        fd_set rset;
+
+        FD_ZERO(&rset);
+        FD_SET(io->thread_notify.fds[0], &rset);
+        for (i = 0; i < 2; ++i) {
+            if (fds[i] != -1) {
+                FD_SET(fds[i], &rset);
+                max = (max > fds[i]) ? max : fds[i];
+            }
+        }
+
+        if (select(max + 1, &rset, NULL, NULL, NULL) == -1) {
+            if (errno == EINTR)
+                continue;
+
+            clog_error(CLOG_CGDB, "select failed: %s", strerror(errno));
+            tgdb_io_push_status(io, io->console_ring, TGDB_IO_ERROR);
+            tgdb_io_notify_signal(&io->ui_notify);
+            break;
+        }
+
+        if (FD_ISSET(io->thread_notify.fds[0], &rset))
+            tgdb_io_notify_clear(&io->thread_notify);
+
+        for (i = 0; i < 2 && !io->stop.load(); ++i) {
+            if (fds[i] != -1 && FD_ISSET(fds[i], &rset)) {
+                if (tgdb_io_read(io, fds[i]) == -1)
+                    fds[i] = -1;
+            }
+        }
+
+        /* Wake the user interface once for everything read */
+        if (io->pushed) {
+            io->pushed = false;
+            tgdb_io_notify_signal(&io->ui_notify);
+        }
+    }
+}
+
+struct tgdb_io *tgdb_io_create(int console_fd, int mi_fd)
+{
+    struct tgdb_io *io = new tgdb_io();
+    struct gdbwire_mi_parser_callbacks callbacks = { io, tgdb_io_mi_output };
+    sigset_t all, old;
+
+    io->console_fd = console_fd;
+    io->mi_fd = mi_fd;
+    io->stop = false;
+    io->waiting = false;
+    io->pushed = false;
+    io->read_size = TGDB_IO_DEFAULT_READ_SIZE;
+    io->read_budget = TGDB_IO_DEFAULT_READ_BUDGET;
+    io->buf = NULL;
+    io->buf_size = 0;
+    io->ui_notify.fds[0] = io->ui_notify.fds[1] = -1;
+    io->thread_notify.fds[0] = io->thread_notify.fds[1] = -1;
+
+    io->parser = gdbwire_mi_parser_create(callbacks);
+    if (!io->parser) {
+        clog_error(CLOG_CGDB, "gdbwire_mi_parser_create failed");
+        delete io;
+        return NULL;
+    }
+
+    if (tgdb_io_notify_open(&io->ui_notify) == -1 ||
+            tgdb_io_notify_open(&io->thread_notify) == -1) {
+        tgdb_io_notify_close(&io->ui_notify);
+        gdbwire_mi_parser_destroy(io->parser);
+        delete io;
+        return NULL;
+    }
+
+    /* Signals are handled by the main loop, the I/O thread inherits
+     * a mask that blocks them all. */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    io->thread = std::thread(tgdb_io_thread, io);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    return io;
+}
+
+void tgdb_io_destroy(struct tgdb_io *io)
+{
+    tgdb_io_event event;
+
+    if (!io)
+        return;
+
+    io->stop.store(true);
+    tgdb_io_notify_signal(&io->thread_notify);
+    io->thread.join();
+
+    while (io->mi_ring.pop(event))
+        tgdb_io_event_free(&event);
+    while (io->console_ring.pop(event))
+        tgdb_io_event_free(&event);
+
+    tgdb_io_notify_close(&io->ui_notify);
+    tgdb_io_notify_close(&io->thread_notify);
+    gdbwire_mi_parser_destroy(io->parser);
+    free(io->buf);
+
+    delete io;
+}
+
+void tgdb_io_set_read_limits(struct tgdb_io *io, int size, int budget)
+{
+    size = std::max(size, 1);
+    io->read_size.store(size);
+    io->read_budget.store(std::max(size, budget));
+}
+
+int tgdb_io_get_fd(struct tgdb_io *io)
+{
+    return io->ui_notify.fds[0];
+}
+
+void tgdb_io_clear_fd(struct tgdb_io *io)
+{
+    tgdb_io_notify_clear(&io->ui_notify);
+}
+
+void tgdb_io_wakeup(struct tgdb_io *io)
+{
+    tgdb_io_notify_signal(&io->ui_notify);
+}
+
+int tgdb_io_pop(struct tgdb_io *io, struct tgdb_io_event *event)
+{
+    if (!io->mi_ring.pop(*event) && !io->console_ring.pop(*event))
+        return 0;
+
+    /* Pairs with the fence in tgdb_io_push */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (io->waiting.load() && io->waiting.exchange(false))
+        tgdb_io_notify_signal(&io->thread_notify);
+
+    return 1;
+}
+
+void tgdb_io_event_free(struct tgdb_io_event *event)
+{
+    free(event->data);
+    event->data = NULL;
+    event->size = 0;
+
+    if (event->output) {
+        gdbwire_mi_output_free(event->output);
+        event->output = NULL;
+    }
+}
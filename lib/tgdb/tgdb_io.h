@@ -0,0 +1,127 @@
+#ifndef __TGDB_IO_H__
+#define __TGDB_IO_H__
+
+/*******************************************************************************
+ *
+ * The gdb I/O thread.
+ *
+ * Reads the gdb console and the gdb/mi new-ui descriptors on a dedicated
+ * thread, so that a burst of output from gdb or the inferior never waits on
+ * the user interface, and a slow redraw never backs up the pty that gdb is
+ * writing to.
+ *
+ * The console output is handed over in chunks, exactly as it was read.
+ * The mi output is parsed with gdbwire on the I/O thread and handed over
+ * one complete record at a time. Each stream goes through its own single
+ * producer, single consumer ring, so neither side ever takes a lock.
+ *
+ * The descriptor returned by tgdb_io_get_fd becomes readable whenever
+ * events are waiting, so it can be added to the main loop's select set.
+ * Call tgdb_io_clear_fd before taking the events with tgdb_io_pop.
+ *
+ ******************************************************************************/
+
+struct gdbwire_mi_output;
+struct tgdb_io;
+
+/* The defaults for tgdb_io_set_read_limits */
+#define TGDB_IO_DEFAULT_READ_SIZE 4096
+#define TGDB_IO_DEFAULT_READ_BUDGET (1024 * 1024)
+
+enum tgdb_io_event_kind {
+    /* Some gdb console output, in data and size */
+    TGDB_IO_CONSOLE,
+
+    /* A complete gdb/mi record, in output */
+    TGDB_IO_MI,
+
+    /* gdb closed one of the descriptors */
+    TGDB_IO_EOF,
+
+    /* Reading one of the descriptors failed */
+    TGDB_IO_ERROR
+};
+
+struct tgdb_io_event {
+    enum tgdb_io_event_kind kind;
+
+    /* The console output, owned by the event */
+    char *data;
+    size_t size;
+
+    /* The parsed mi output, owned by the event */
+    struct gdbwire_mi_output *output;
+};
+
+/* tgdb_io_create:
+ * ---------------
+ *
+ *  console_fd - The gdb console descriptor.
+ *  mi_fd      - The gdb/mi new-ui descriptor.
+ *
+ * Starts the I/O thread reading from both descriptors. The descriptors
+ * are not closed by the I/O thread and can still be written to.
+ *
+ * Returns the new I/O thread, or NULL on error.
+ */
+struct tgdb_io *tgdb_io_create(int console_fd, int mi_fd);
+
+/* tgdb_io_destroy:
+ * ----------------
+ *
+ * Stops the I/O thread and frees any events that were not taken.
+ */
+void tgdb_io_destroy(struct tgdb_io *io);
+
+/* tgdb_io_set_read_limits:
+ * ------------------------
+ *
+ *  size   - The number of bytes read when a descriptor becomes readable.
+ *  budget - The most bytes read into one batch. When more output is
+ *           already waiting after the first read, it is read in as well,
+ *           up to this many bytes, and handed over as a single event.
+ *           A budget smaller than size is raised to size.
+ */
+void tgdb_io_set_read_limits(struct tgdb_io *io, int size, int budget);
+
+/* tgdb_io_get_fd:
+ * ---------------
+ *
+ * Returns the descriptor that becomes readable when events are waiting.
+ */
+int tgdb_io_get_fd(struct tgdb_io *io);
+
+/* tgdb_io_clear_fd:
+ * -----------------
+ *
+ * Resets the descriptor returned by tgdb_io_get_fd. Events added after
+ * this call make the descriptor readable again.
+ */
+void tgdb_io_clear_fd(struct tgdb_io *io);
+
+/* tgdb_io_wakeup:
+ * ---------------
+ *
+ * Makes the descriptor returned by tgdb_io_get_fd readable, for when the
+ * caller stops taking events before they run out.
+ */
+void tgdb_io_wakeup(struct tgdb_io *io);
+
+/* tgdb_io_pop:
+ * ------------
+ *
+ * Takes the next event. The mi events are taken before the console events.
+ * The caller owns the event and must free it with tgdb_io_event_free.
+ *
+ * Returns 1 if an event was taken, or 0 if there are none waiting.
+ */
+int tgdb_io_pop(struct tgdb_io *io, struct tgdb_io_event *event);
+
+/* tgdb_io_event_free:
+ * -------------------
+ *
+ * Frees the data owned by an event.
+ */
+void tgdb_io_event_free(struct tgdb_io_event *event);
+
+#endif /* __TGDB_IO_H__ */
@@ -0,0 +1,82 @@
+#ifndef __TGDB_IO_RING_H__
+#define __TGDB_IO_RING_H__
+
+/*******************************************************************************
+ *
+ * The ring the gdb I/O thread hands its events over in, see tgdb_io.h.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "tgdb_io.h"
+
+/* The number of events each ring holds, must be a power of two */
+#define TGDB_IO_RING_SIZE 256
+
+/* The size of a cache line, head and tail are kept this far apart */
+#define TGDB_IO_CACHE_LINE 64
+
+/**
+ * An index of the ring, padded out to a cache line of its own.
+ *
+ * Padded rather than aligned, as new doesn't honour an alignment over that
+ * of max_align_t before C++17. Two of these in a row are a cache line
+ * apart, so never share one.
+ */
+struct tgdb_io_ring_index {
+    std::atomic<size_t> value;
+    char pad[TGDB_IO_CACHE_LINE - sizeof(std::atomic<size_t>)];
+};
+
+/**
+ * A single producer, single consumer ring of events.
+ *
+ * The I/O thread pushes and the user interface thread pops. The head is
+ * only written by the consumer and the tail only by the producer, so
+ * publishing an event is a single release store.
+ */
+class tgdb_io_ring {
+public:
+    tgdb_io_ring()
+    {
+        head.value = 0;
+        tail.value = 0;
+    }
+
+    bool push(const tgdb_io_event &event)
+    {
+        size_t t = tail.value.load(std::memory_order_relaxed);
+
+        if (t - head.value.load(std::memory_order_acquire) == TGDB_IO_RING_SIZE)
+            return false;
+
+        events[t & (TGDB_IO_RING_SIZE - 1)] = event;
+        tail.value.store(t + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool pop(tgdb_io_event &event)
+    {
+        size_t h = head.value.load(std::memory_order_relaxed);
+
+        if (h == tail.value.load(std::memory_order_acquire))
+            return false;
+
+        event = events[h & (TGDB_IO_RING_SIZE - 1)];
+        head.value.store(h + 1, std::memory_order_release);
+
+        return true;
+    }
+
+private:
+    /* Kept on separate cache lines, each side writes only one of them */
+    tgdb_io_ring_index head;
+    tgdb_io_ring_index tail;
+    tgdb_io_event events[TGDB_IO_RING_SIZE];
+};
+
+#endif /* __TGDB_IO_RING_H__ */
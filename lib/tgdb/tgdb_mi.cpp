@@ -0,0 +1,397 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#include "sys_util.h"
+#include "stretchy.h"
+#include "tgdb_mi.h"
+
+struct gdbwire_mi_result *tgdb_find_result(
+        struct gdbwire_mi_result *result, const char *variable)
+{
+    for (; result; result = result->next) {
+        if (result->variable && strcmp(result->variable, variable) == 0)
+            return result;
+    }
+
+    return NULL;
+}
+
+const char *tgdb_find_cstring(struct gdbwire_mi_result *result,
+        const char *variable)
+{
+    result = tgdb_find_result(result, variable);
+    if (result && result->kind == GDBWIRE_MI_CSTRING)
+        return result->variant.cstring;
+
+    return NULL;
+}
+
+int tgdb_find_int(struct gdbwire_mi_result *result,
+        const char *variable, int value)
+{
+    const char *cstring = tgdb_find_cstring(result, variable);
+
+    if (cstring)
+        cgdb_string_to_int(cstring, &value);
+
+    return value;
+}
+
+/* This parses the reply of -stack-list-frames,
+ *   ^done,stack=[frame={level="0",addr="0x...",func="main",
+ *       file="main.c",fullname="/src/main.c",line="5"},...]
+ */
+int tgdb_parse_stack_frames(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_frame **frames)
+{
+    struct gdbwire_mi_result *stack =
+        tgdb_find_result(result_record->result, "stack");
+    struct gdbwire_mi_result *frame;
+
+    *frames = NULL;
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !stack ||
+            stack->kind != GDBWIRE_MI_LIST)
+        return -1;
+
+    for (frame = stack->variant.result; frame; frame = frame->next) {
+        struct gdbwire_mi_result *fresult = frame->variant.result;
+        struct tgdb_frame tf;
+        const char *value;
+
+        if (frame->kind != GDBWIRE_MI_TUPLE)
+            continue;
+
+        tf.level = tgdb_find_int(fresult, "level", sbcount(*frames));
+        tf.addr = 0;
+        value = tgdb_find_cstring(fresult, "addr");
+        if (value)
+            cgdb_hexstr_to_u64(value, &tf.addr);
+        value = tgdb_find_cstring(fresult, "func");
+        tf.func = value ? cgdb_strdup(value) : NULL;
+        value = tgdb_find_cstring(fresult, "file");
+        tf.file = value ? cgdb_strdup(value) : NULL;
+        value = tgdb_find_cstring(fresult, "fullname");
+        tf.fullname = value ? cgdb_strdup(value) : NULL;
+        tf.line = tgdb_find_int(fresult, "line", 0);
+        value = tgdb_find_cstring(fresult, "from");
+        tf.from = value ? cgdb_strdup(value) : NULL;
+
+        sbpush(*frames, tf);
+    }
+
+    return 0;
+}
+
+void tgdb_free_frames(struct tgdb_frame *frames)
+{
+    int i;
+
+    for (i = 0; i < sbcount(frames); i++) {
+        free(frames[i].func);
+        free(frames[i].file);
+        free(frames[i].fullname);
+        free(frames[i].from);
+    }
+    sbfree(frames);
+}
+
+/* This parses a variable object of the replies of -var-create,
+ * -var-list-children and -var-update,
+ *   name="var1",exp="a",numchild="0",value="1",type="int",has_more="0"
+ *   name="var1",in_scope="true",type_changed="false",has_more="0"
+ */
+void tgdb_parse_varobj(struct gdbwire_mi_result *result,
+        struct tgdb_varobj *var)
+{
+    const char *value;
+
+    value = tgdb_find_cstring(result, "name");
+    var->name = value ? cgdb_strdup(value) : NULL;
+    value = tgdb_find_cstring(result, "exp");
+    var->exp = value ? cgdb_strdup(value) : NULL;
+    value = tgdb_find_cstring(result, "value");
+    var->value = value ? cgdb_strdup(value) : NULL;
+    value = tgdb_find_cstring(result, "type");
+    if (!value)
+        value = tgdb_find_cstring(result, "new_type");
+    var->type = value ? cgdb_strdup(value) : NULL;
+    var->numchild = tgdb_find_int(result, "numchild",
+            tgdb_find_int(result, "new_num_children", -1));
+    var->has_more = tgdb_find_int(result, "has_more", 0);
+
+    value = tgdb_find_cstring(result, "in_scope");
+    if (value && strcmp(value, "false") == 0)
+        var->in_scope = 0;
+    else if (value && strcmp(value, "invalid") == 0)
+        var->in_scope = -1;
+    else
+        var->in_scope = 1;
+
+    value = tgdb_find_cstring(result, "type_changed");
+    var->type_changed = value && strcmp(value, "true") == 0;
+}
+
+/* This parses a list of variable objects,
+ *   children=[child={name="var1.a",...},...]
+ *   changelist=[{name="var1",...},...]
+ */
+struct tgdb_varobj *tgdb_parse_varobjs(
+        struct gdbwire_mi_result *list)
+{
+    struct tgdb_varobj *vars = NULL;
+
+    if (!list || list->kind != GDBWIRE_MI_LIST)
+        return NULL;
+
+    for (list = list->variant.result; list; list = list->next) {
+        struct tgdb_varobj var;
+
+        if (list->kind != GDBWIRE_MI_TUPLE)
+            continue;
+
+        tgdb_parse_varobj(list->variant.result, &var);
+        if (var.name)
+            sbpush(vars, var);
+        else
+            tgdb_free_varobj(&var);
+    }
+
+    return vars;
+}
+
+void tgdb_free_varobj(struct tgdb_varobj *var)
+{
+    free(var->name);
+    free(var->exp);
+    free(var->value);
+    free(var->type);
+}
+
+void tgdb_free_varobjs(struct tgdb_varobj *vars)
+{
+    int i;
+
+    for (i = 0; i < sbcount(vars); i++)
+        tgdb_free_varobj(&vars[i]);
+    sbfree(vars);
+}
+
+/* This parses the reply of -data-read-memory-bytes,
+ *   ^done,memory=[{begin="0x601040",offset="0x0",end="0x601044",
+ *       contents="68656c6c"},...]
+ */
+int tgdb_parse_memory(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_memory_block **blocks)
+{
+    struct gdbwire_mi_result *memory =
+        tgdb_find_result(result_record->result, "memory");
+    struct gdbwire_mi_result *block;
+
+    *blocks = NULL;
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !memory ||
+            memory->kind != GDBWIRE_MI_LIST)
+        return -1;
+
+    for (block = memory->variant.result; block; block = block->next) {
+        struct tgdb_memory_block tb;
+        const char *begin, *contents;
+        char hex[3] = { 0, 0, 0 };
+
+        if (block->kind != GDBWIRE_MI_TUPLE)
+            continue;
+
+        begin = tgdb_find_cstring(block->variant.result, "begin");
+        contents = tgdb_find_cstring(block->variant.result, "contents");
+        if (!begin || !contents ||
+                cgdb_hexstr_to_u64(begin, &tb.addr) == -1)
+            continue;
+
+        tb.bytes = NULL;
+        for (; contents[0] && contents[1]; contents += 2) {
+            hex[0] = contents[0];
+            hex[1] = contents[1];
+            sbpush(tb.bytes, (unsigned char)strtoul(hex, NULL, 16));
+        }
+
+        sbpush(*blocks, tb);
+    }
+
+    return 0;
+}
+
+void tgdb_free_memory(struct tgdb_memory_block *blocks)
+{
+    int i;
+
+    for (i = 0; i < sbcount(blocks); i++)
+        sbfree(blocks[i].bytes);
+    sbfree(blocks);
+}
+
+/* This parses the reply of -thread-info id,
+ *   ^done,threads=[{id="2",target-id="Thread 0x7ffff (LWP 12)",
+ *       name="worker",frame={level="0",func="poll",file="a.c",line="5"},
+ *       state="stopped"}],current-thread-id="1"
+ */
+int tgdb_parse_thread_info(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_thread *thread)
+{
+    struct gdbwire_mi_result *threads =
+        tgdb_find_result(result_record->result, "threads");
+    struct gdbwire_mi_result *tresult, *frame;
+    const char *value;
+
+    memset(thread, 0, sizeof(*thread));
+
+    // An exited thread gives an empty list
+    if (result_record->result_class != GDBWIRE_MI_DONE || !threads ||
+            threads->kind != GDBWIRE_MI_LIST || !threads->variant.result ||
+            threads->variant.result->kind != GDBWIRE_MI_TUPLE)
+        return -1;
+
+    tresult = threads->variant.result->variant.result;
+    frame = tgdb_find_result(tresult, "frame");
+
+    thread->id = tgdb_find_int(tresult, "id", 0);
+    value = tgdb_find_cstring(tresult, "target-id");
+    thread->target_id = value ? cgdb_strdup(value) : NULL;
+    value = tgdb_find_cstring(tresult, "name");
+    thread->name = value ? cgdb_strdup(value) : NULL;
+    value = tgdb_find_cstring(tresult, "state");
+    thread->running = value && strcmp(value, "running") == 0;
+
+    if (frame && frame->kind == GDBWIRE_MI_TUPLE) {
+        value = tgdb_find_cstring(frame->variant.result, "func");
+        thread->func = value ? cgdb_strdup(value) : NULL;
+        value = tgdb_find_cstring(frame->variant.result, "file");
+        thread->file = value ? cgdb_strdup(value) : NULL;
+        thread->line = tgdb_find_int(frame->variant.result, "line", 0);
+    }
+
+    return 0;
+}
+
+void tgdb_free_thread(struct tgdb_thread *thread)
+{
+    free(thread->target_id);
+    free(thread->name);
+    free(thread->func);
+    free(thread->file);
+}
+
+/* This parses the reply of -data-list-register-names,
+ *   ^done,register-names=["rax","rbx",...,"","",...]
+ */
+int tgdb_parse_register_names(struct gdbwire_mi_result_record *result_record,
+        char ***names)
+{
+    struct gdbwire_mi_result *list =
+        tgdb_find_result(result_record->result, "register-names");
+    struct gdbwire_mi_result *name;
+
+    *names = NULL;
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !list ||
+            list->kind != GDBWIRE_MI_LIST)
+        return -1;
+
+    for (name = list->variant.result; name; name = name->next) {
+        sbpush(*names, cgdb_strdup(
+                    name->kind == GDBWIRE_MI_CSTRING ?
+                    name->variant.cstring : ""));
+    }
+
+    return 0;
+}
+
+void tgdb_free_register_names(char **names)
+{
+    int i;
+
+    for (i = 0; i < sbcount(names); i++)
+        free(names[i]);
+    sbfree(names);
+}
+
+/* This parses the reply of -data-list-changed-registers,
+ *   ^done,changed-registers=["0","1","16"]
+ */
+int tgdb_parse_changed_registers(
+        struct gdbwire_mi_result_record *result_record, int **numbers)
+{
+    struct gdbwire_mi_result *changed =
+        tgdb_find_result(result_record->result, "changed-registers");
+    struct gdbwire_mi_result *number;
+
+    *numbers = NULL;
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !changed ||
+            changed->kind != GDBWIRE_MI_LIST)
+        return -1;
+
+    for (number = changed->variant.result; number; number = number->next) {
+        int value;
+
+        if (number->kind == GDBWIRE_MI_CSTRING &&
+                cgdb_string_to_int(number->variant.cstring, &value) == 0)
+            sbpush(*numbers, value);
+    }
+
+    return 0;
+}
+
+/* This parses the reply of -data-list-register-values,
+ *   ^done,register-values=[{number="0",value="0x1c"},...]
+ */
+int tgdb_parse_register_values(
+        struct gdbwire_mi_result_record *result_record,
+        struct tgdb_register **registers)
+{
+    struct gdbwire_mi_result *values =
+        tgdb_find_result(result_record->result, "register-values");
+    struct gdbwire_mi_result *value;
+
+    *registers = NULL;
+
+    if (result_record->result_class != GDBWIRE_MI_DONE || !values ||
+            values->kind != GDBWIRE_MI_LIST)
+        return -1;
+
+    for (value = values->variant.result; value; value = value->next) {
+        struct tgdb_register reg;
+        const char *str;
+
+        if (value->kind != GDBWIRE_MI_TUPLE)
+            continue;
+
+        reg.number = tgdb_find_int(value->variant.result, "number", -1);
+        str = tgdb_find_cstring(value->variant.result, "value");
+        if (reg.number < 0 || !str)
+            continue;
+
+        reg.value = cgdb_strdup(str);
+        sbpush(*registers, reg);
+    }
+
+    return 0;
+}
+
+void tgdb_free_registers(struct tgdb_register *registers)
+{
+    int i;
+
+    for (i = 0; i < sbcount(registers); i++)
+        free(registers[i].value);
+    sbfree(registers);
+}
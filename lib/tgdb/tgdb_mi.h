@@ -0,0 +1,188 @@
+#ifndef __TGDB_MI_H__
+#define __TGDB_MI_H__
+
+/*******************************************************************************
+ *
+ * Parsing the gdb/mi replies to the requests of the info window.
+ *
+ * Each parser takes the result record gdbwire made of a reply and fills
+ * in the part of the tgdb response it is for. They don't need gdb or a
+ * tgdb context, so they can be tested on their own.
+ *
+ ******************************************************************************/
+
+#include "tgdb.h"
+#include "gdbwire.h"
+
+/* tgdb_find_result:
+ * -----------------
+ *
+ *  result   - The first result of a tuple or record.
+ *  variable - The name of the result to find.
+ *
+ * Returns the result named variable, or NULL if none.
+ */
+struct gdbwire_mi_result *tgdb_find_result(
+        struct gdbwire_mi_result *result, const char *variable);
+
+/* tgdb_find_cstring:
+ * ------------------
+ *
+ * Returns the string value of the result named variable, or NULL if none.
+ */
+const char *tgdb_find_cstring(struct gdbwire_mi_result *result,
+        const char *variable);
+
+/* tgdb_find_int:
+ * --------------
+ *
+ * Returns the integer value of the result named variable, or value if
+ * none.
+ */
+int tgdb_find_int(struct gdbwire_mi_result *result,
+        const char *variable, int value);
+
+/* tgdb_parse_stack_frames:
+ * ------------------------
+ *
+ *  result_record - The reply of -stack-list-frames.
+ *  frames        - Set to the frames, in order of level, a stretchy
+ *                  buffer freed with tgdb_free_frames.
+ *
+ * Returns 0 on success, or -1 if gdb could not get the frames.
+ */
+int tgdb_parse_stack_frames(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_frame **frames);
+
+/* tgdb_free_frames:
+ * -----------------
+ *
+ * Frees the frames from tgdb_parse_stack_frames.
+ */
+void tgdb_free_frames(struct tgdb_frame *frames);
+
+/* tgdb_parse_varobj:
+ * ------------------
+ *
+ *  result - The first result of a variable object, from the reply of
+ *           -var-create, or a tuple of -var-list-children or -var-update.
+ *  var    - Filled in, freed with tgdb_free_varobj.
+ */
+void tgdb_parse_varobj(struct gdbwire_mi_result *result,
+        struct tgdb_varobj *var);
+
+/* tgdb_parse_varobjs:
+ * -------------------
+ *
+ *  list - The children list of -var-list-children or the changelist of
+ *         -var-update, may be NULL.
+ *
+ * Returns the variable objects with a name, a stretchy buffer freed with
+ * tgdb_free_varobjs.
+ */
+struct tgdb_varobj *tgdb_parse_varobjs(struct gdbwire_mi_result *list);
+
+/* tgdb_free_varobj:
+ * -----------------
+ *
+ * Frees the strings of a variable object, not the object itself.
+ */
+void tgdb_free_varobj(struct tgdb_varobj *var);
+
+/* tgdb_free_varobjs:
+ * ------------------
+ *
+ * Frees the variable objects from tgdb_parse_varobjs.
+ */
+void tgdb_free_varobjs(struct tgdb_varobj *vars);
+
+/* tgdb_parse_memory:
+ * ------------------
+ *
+ *  result_record - The reply of -data-read-memory-bytes.
+ *  blocks        - Set to the blocks that could be read, in order of
+ *                  address, a stretchy buffer freed with tgdb_free_memory.
+ *
+ * Returns 0 on success, or -1 if none of the memory could be read.
+ */
+int tgdb_parse_memory(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_memory_block **blocks);
+
+/* tgdb_free_memory:
+ * -----------------
+ *
+ * Frees the blocks from tgdb_parse_memory.
+ */
+void tgdb_free_memory(struct tgdb_memory_block *blocks);
+
+/* tgdb_parse_thread_info:
+ * -----------------------
+ *
+ *  result_record - The reply of -thread-info for one thread.
+ *  thread        - Filled in, freed with tgdb_free_thread.
+ *
+ * Returns 0 on success, or -1 if gdb doesn't know the thread.
+ */
+int tgdb_parse_thread_info(struct gdbwire_mi_result_record *result_record,
+        struct tgdb_thread *thread);
+
+/* tgdb_free_thread:
+ * -----------------
+ *
+ * Frees the strings of a thread, not the thread itself.
+ */
+void tgdb_free_thread(struct tgdb_thread *thread);
+
+/* tgdb_parse_register_names:
+ * --------------------------
+ *
+ *  result_record - The reply of -data-list-register-names.
+ *  names         - Set to the names, by register number, a stretchy buffer
+ *                  freed with tgdb_free_register_names. The numbers gdb
+ *                  doesn't use have an empty name.
+ *
+ * Returns 0 on success, or -1 on error.
+ */
+int tgdb_parse_register_names(struct gdbwire_mi_result_record *result_record,
+        char ***names);
+
+/* tgdb_free_register_names:
+ * -------------------------
+ *
+ * Frees the names from tgdb_parse_register_names.
+ */
+void tgdb_free_register_names(char **names);
+
+/* tgdb_parse_changed_registers:
+ * -----------------------------
+ *
+ *  result_record - The reply of -data-list-changed-registers.
+ *  numbers       - Set to the numbers of the registers that changed, a
+ *                  stretchy buffer freed with sbfree.
+ *
+ * Returns 0 on success, or -1 if gdb can't tell, like without a program.
+ */
+int tgdb_parse_changed_registers(
+        struct gdbwire_mi_result_record *result_record, int **numbers);
+
+/* tgdb_parse_register_values:
+ * ---------------------------
+ *
+ *  result_record - The reply of -data-list-register-values.
+ *  registers     - Set to the registers, in the order of the reply, a
+ *                  stretchy buffer freed with tgdb_free_registers.
+ *
+ * Returns 0 on success, or -1 if gdb could not read the values.
+ */
+int tgdb_parse_register_values(
+        struct gdbwire_mi_result_record *result_record,
+        struct tgdb_register **registers);
+
+/* tgdb_free_registers:
+ * --------------------
+ *
+ * Frees the registers from tgdb_parse_register_values.
+ */
+void tgdb_free_registers(struct tgdb_register *registers);
+
+#endif /* __TGDB_MI_H__ */
@@ -0,0 +1,412 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if HAVE_STRING_H
+#include <string.h>
+#endif /* HAVE_STRING_H */
+
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+
+#if HAVE_ERRNO_H
+#include <errno.h>
+#endif /* HAVE_ERRNO_H */
+
+#if HAVE_SYS_EPOLL_H && HAVE_SYS_TIMERFD_H
+#define EVENT_LOOP_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "sys_util.h"
+#include "event_loop.h"
+
+/* The most descriptors reported by a single epoll_wait */
+#define EVENT_LOOP_MAX_EVENTS 32
+
+typedef std::chrono::steady_clock::time_point event_loop_time;
+
+struct event_loop_fd {
+    /* The registration order, readable descriptors are handled by it */
+    unsigned long seq;
+    event_loop_fd_callback callback;
+    void *context;
+};
+
+struct event_loop_idle {
+    event_loop_callback callback;
+    void *context;
+};
+
+struct event_loop_timer {
+    event_loop_time deadline;
+    event_loop_callback callback;
+    void *context;
+};
+
+struct event_loop {
+    std::map<int, event_loop_fd> fds;
+    unsigned long next_seq;
+
+    std::map<int, event_loop_idle> idles;
+    int next_idle_id;
+
+    /* The timers by id, and the ids ordered by deadline */
+    std::map<int, event_loop_timer> timers;
+    std::set< std::pair<event_loop_time, int> > deadlines;
+    int next_timer_id;
+
+    bool quit;
+
+#if EVENT_LOOP_EPOLL
+    int epoll_fd;
+
+    /* Armed for the earliest deadline */
+    int timer_fd;
+#endif
+};
+
+struct event_loop *event_loop_create(void)
+{
+    struct event_loop *loop = new event_loop();
+
+    loop->next_seq = 0;
+    loop->next_idle_id = 0;
+    loop->next_timer_id = 0;
+    loop->quit = false;
+
+#if EVENT_LOOP_EPOLL
+    struct epoll_event event;
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd == -1) {
+        clog_error(CLOG_CGDB, "epoll_create1 failed: %s", strerror(errno));
+        delete loop;
+        return NULL;
+    }
+
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+            TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->timer_fd == -1) {
+        clog_error(CLOG_CGDB, "timerfd_create failed: %s", strerror(errno));
+        cgdb_close(loop->epoll_fd);
+        delete loop;
+        return NULL;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = loop->timer_fd;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &event) == -1) {
+        clog_error(CLOG_CGDB, "epoll_ctl failed: %s", strerror(errno));
+        cgdb_close(loop->timer_fd);
+        cgdb_close(loop->epoll_fd);
+        delete loop;
+        return NULL;
+    }
+#endif
+
+    return loop;
+}
+
+void event_loop_destroy(struct event_loop *loop)
+{
+    if (!loop)
+        return;
+
+#if EVENT_LOOP_EPOLL
+    cgdb_close(loop->timer_fd);
+    cgdb_close(loop->epoll_fd);
+#endif
+
+    delete loop;
+}
+
+int event_loop_add_fd(struct event_loop *loop, int fd,
+        event_loop_fd_callback callback, void *context)
+{
+    if (fd < 0 || loop->fds.find(fd) != loop->fds.end())
+        return -1;
+
+#if EVENT_LOOP_EPOLL
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        clog_error(CLOG_CGDB, "epoll_ctl failed: %s", strerror(errno));
+        return -1;
+    }
+#endif
+
+    loop->fds[fd] = { loop->next_seq++, callback, context };
+
+    return 0;
+}
+
+int event_loop_remove_fd(struct event_loop *loop, int fd)
+{
+    std::map<int, event_loop_fd>::iterator iter = loop->fds.find(fd);
+
+    if (iter == loop->fds.end())
+        return -1;
+
+#if EVENT_LOOP_EPOLL
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL) == -1)
+        clog_error(CLOG_CGDB, "epoll_ctl failed: %s", strerror(errno));
+#endif
+
+    loop->fds.erase(iter);
+
+    return 0;
+}
+
+int event_loop_add_idle(struct event_loop *loop,
+        event_loop_callback callback, void *context)
+{
+    int id = ++loop->next_idle_id;
+
+    loop->idles[id] = { callback, context };
+
+    return id;
+}
+
+void event_loop_remove_idle(struct event_loop *loop, int id)
+{
+    loop->idles.erase(id);
+}
+
+int event_loop_add_timer(struct event_loop *loop, int ms,
+        event_loop_callback callback, void *context)
+{
+    int id = ++loop->next_timer_id;
+    event_loop_time deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(ms);
+
+    loop->timers[id] = { deadline, callback, context };
+    loop->deadlines.insert(std::make_pair(deadline, id));
+
+    return id;
+}
+
+void event_loop_cancel_timer(struct event_loop *loop, int id)
+{
+    std::map<int, event_loop_timer>::iterator iter = loop->timers.find(id);
+
+    if (iter != loop->timers.end()) {
+        loop->deadlines.erase(std::make_pair(iter->second.deadline, id));
+        loop->timers.erase(iter);
+    }
+}
+
+void event_loop_quit(struct event_loop *loop)
+{
+    loop->quit = true;
+}
+
+/* Run every idle callback, returns -1 if one of them failed */
+static int event_loop_run_idles(struct event_loop *loop)
+{
+    std::vector<int> ids;
+
+    /* Callbacks may add or remove idle callbacks */
+    for (const auto &idle : loop->idles)
+        ids.push_back(idle.first);
+
+    for (int id : ids) {
+        std::map<int, event_loop_idle>::iterator iter = loop->idles.find(id);
+
+        if (iter == loop->idles.end())
+            continue;
+
+        if (iter->second.callback(iter->second.context) == -1)
+            return -1;
+        if (loop->quit)
+            break;
+    }
+
+    return 0;
+}
+
+/* Run the timers that have expired, returns -1 if one of them failed */
+static int event_loop_run_timers(struct event_loop *loop)
+{
+    event_loop_time now = std::chrono::steady_clock::now();
+
+    /* Timers added by a callback wait for the next pass, even with a
+     * deadline that has already passed */
+    int last_id = loop->next_timer_id;
+
+    while (!loop->deadlines.empty() && !loop->quit) {
+        std::pair<event_loop_time, int> first = *loop->deadlines.begin();
+        std::map<int, event_loop_timer>::iterator iter;
+        event_loop_timer timer;
+
+        if (first.first > now || first.second > last_id)
+            break;
+
+        iter = loop->timers.find(first.second);
+        timer = iter->second;
+        loop->deadlines.erase(loop->deadlines.begin());
+        loop->timers.erase(iter);
+
+        if (timer.callback(timer.context) == -1)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* The number of milliseconds until the next timer expires, or -1 */
+static int event_loop_timeout(struct event_loop *loop)
+{
+    std::chrono::milliseconds remaining;
+
+    if (loop->deadlines.empty())
+        return -1;
+
+    remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            loop->deadlines.begin()->first - std::chrono::steady_clock::now());
+
+    /* Round up, so the loop does not wake just before the deadline */
+    return std::max<long>(0, remaining.count() + 1);
+}
+
+/**
+ * Wait for descriptors to become readable or the next timer to expire.
+ *
+ * The readable descriptors are added to ready as (seq, fd) pairs.
+ *
+ * Returns 0 on success (including interrupted by a signal), or -1 on error.
+ */
+static int event_loop_wait(struct event_loop *loop,
+        std::vector< std::pair<unsigned long, int> > &ready)
+{
+    int timeout = event_loop_timeout(loop);
+    int count, i;
+
+#if EVENT_LOOP_EPOLL
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    struct itimerspec spec;
+
+    /* Arm the timerfd for the earliest deadline, or disarm it. A zero
+     * it_value disarms a timerfd, so expired timers get a nanosecond. */
+    memset(&spec, 0, sizeof(spec));
+    if (timeout != -1) {
+        spec.it_value.tv_sec = timeout / 1000;
+        spec.it_value.tv_nsec = (timeout % 1000) * 1000000L;
+        if (timeout == 0)
+            spec.it_value.tv_nsec = 1;
+    }
+    if (timerfd_settime(loop->timer_fd, 0, &spec, NULL) == -1) {
+        clog_error(CLOG_CGDB, "timerfd_settime failed: %s", strerror(errno));
+        return -1;
+    }
+
+    count = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_EVENTS, -1);
+    if (count == -1) {
+        if (errno == EINTR)
+            return 0;
+        clog_error(CLOG_CGDB, "epoll_wait failed: %s", strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        std::map<int, event_loop_fd>::iterator iter;
+
+        if (fd == loop->timer_fd) {
+            uint64_t expirations;
+            if (read(loop->timer_fd, &expirations, sizeof(expirations)) == -1 &&
+                    errno != EAGAIN) {
+                clog_error(CLOG_CGDB, "read failed: %s", strerror(errno));
+            }
+            continue;
+        }
+
+        iter = loop->fds.find(fd);
+        if (iter != loop->fds.end())
+            ready.push_back(std::make_pair(iter->second.seq, fd));
+    }
+#else
+    std::vector<struct pollfd> pollfds;
+
+    for (const auto &source : loop->fds) {
+        struct pollfd pfd;
+        pfd.fd = source.first;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        pollfds.push_back(pfd);
+    }
+
+    count = poll(pollfds.data(), pollfds.size(), timeout);
+    if (count == -1) {
+        if (errno == EINTR)
+            return 0;
+        clog_error(CLOG_CGDB, "poll failed: %s", strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < (int)pollfds.size(); ++i) {
+        if (pollfds[i].revents) {
+            int fd = pollfds[i].fd;
+            ready.push_back(std::make_pair(loop->fds[fd].seq, fd));
+        }
+    }
+#endif
+
+    return 0;
+}
+
+int event_loop_run(struct event_loop *loop)
+{
+    std::vector< std::pair<unsigned long, int> > ready;
+
+    loop->quit = false;
+
+    while (!loop->quit) {
+        if (event_loop_run_idles(loop) == -1)
+            return -1;
+        if (loop->quit)
+            break;
+
+        ready.clear();
+        if (event_loop_wait(loop, ready) == -1)
+            return -1;
+
+        /* Handle the descriptors in the order they were registered */
+        std::sort(ready.begin(), ready.end());
+
+        for (const auto &item : ready) {
+            std::map<int, event_loop_fd>::iterator iter;
+
+            if (loop->quit)
+                break;
+
+            /* A callback may have removed, or replaced, this descriptor */
+            iter = loop->fds.find(item.second);
+            if (iter == loop->fds.end() || iter->second.seq != item.first)
+                continue;
+
+            if (iter->second.callback(iter->second.context, item.second) == -1)
+                return -1;
+        }
+
+        if (event_loop_run_timers(loop) == -1)
+            return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+/*******************************************************************************
+ *
+ * The event loop.
+ *
+ * Waits for any number of registered sources and calls back into the
+ * subsystem that registered them. There are three kinds of sources,
+ *
+ *   - descriptors, called when the descriptor is readable
+ *   - idle callbacks, called every time the loop is about to wait
+ *   - timers, called once when their deadline passes
+ *
+ * Readable descriptors are handled in the order they were registered,
+ * whatever order the system reports them in. Sources can be added and
+ * removed from inside any callback.
+ *
+ * On Linux the loop waits with epoll and keeps the timers in a timerfd,
+ * elsewhere it falls back to poll.
+ *
+ * Every callback returns 0 to keep going, or -1 to stop the loop with an
+ * error.
+ *
+ ******************************************************************************/
+
+struct event_loop;
+
+typedef int (*event_loop_fd_callback)(void *context, int fd);
+typedef int (*event_loop_callback)(void *context);
+
+/* event_loop_create:
+ * ------------------
+ *
+ * Returns a new, empty, event loop or NULL on error.
+ */
+struct event_loop *event_loop_create(void);
+
+/* event_loop_destroy:
+ * -------------------
+ *
+ * Frees the event loop. The registered descriptors are not closed.
+ */
+void event_loop_destroy(struct event_loop *loop);
+
+/* event_loop_add_fd:
+ * ------------------
+ *
+ *  fd       - The descriptor to wait on.
+ *  callback - Called with context and fd whenever fd is readable.
+ *
+ * Returns 0 on success, or -1 on error (including fd already registered).
+ */
+int event_loop_add_fd(struct event_loop *loop, int fd,
+        event_loop_fd_callback callback, void *context);
+
+/* event_loop_remove_fd:
+ * ---------------------
+ *
+ * Stops waiting on fd. Must be called before fd is closed.
+ *
+ * Returns 0 on success, or -1 if fd was not registered.
+ */
+int event_loop_remove_fd(struct event_loop *loop, int fd);
+
+/* event_loop_add_idle:
+ * --------------------
+ *
+ *  callback - Called with context every time the loop has handled
+ *             everything that was ready and is about to wait again.
+ *
+ * Returns the id of the idle callback, for event_loop_remove_idle.
+ */
+int event_loop_add_idle(struct event_loop *loop,
+        event_loop_callback callback, void *context);
+
+/* event_loop_remove_idle:
+ * -----------------------
+ *
+ * Removes an idle callback. Unknown ids are ignored.
+ */
+void event_loop_remove_idle(struct event_loop *loop, int id);
+
+/* event_loop_add_timer:
+ * ---------------------
+ *
+ *  ms       - The number of milliseconds from now the timer expires.
+ *  callback - Called once with context when the timer expires.
+ *
+ * A timer is removed once it has run. To repeat, add it again from the
+ * callback.
+ *
+ * Returns the id of the timer, for event_loop_cancel_timer.
+ */
+int event_loop_add_timer(struct event_loop *loop, int ms,
+        event_loop_callback callback, void *context);
+
+/* event_loop_cancel_timer:
+ * ------------------------
+ *
+ * Removes a timer that has not run yet. Unknown ids are ignored.
+ */
+void event_loop_cancel_timer(struct event_loop *loop, int id);
+
+/* event_loop_run:
+ * ---------------
+ *
+ * Runs the loop until event_loop_quit is called or a callback fails.
+ *
+ * Returns 0 if event_loop_quit was called, or -1 on error.
+ */
+int event_loop_run(struct event_loop *loop);
+
+/* event_loop_quit:
+ * ----------------
+ *
+ * Makes event_loop_run return once the current callback returns.
+ */
+void event_loop_quit(struct event_loop *loop);
+
+#endif /* __EVENT_LOOP_H__ */
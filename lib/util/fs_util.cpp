@@ -30,6 +30,17 @@
 #include <errno.h>
 #endif /* HAVE_ERRNO_H */
 
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif /* HAVE_FCNTL_H */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "sys_util.h"
 #include "fs_util.h"
 
@@ -129,3 +140,212 @@ int fs_verify_file_exists(const std::string &path)
 
     return 1;
 }
+
+/* The stat cache {{{ */
+
+struct fs_stat_cache_entry {
+    int exists;
+    std::chrono::steady_clock::time_point when;
+};
+
+static std::mutex fs_stat_cache_mutex;
+static std::unordered_map<std::string, fs_stat_cache_entry> fs_stat_cache;
+
+int fs_stat_cache_lookup(const std::string &path, int *exists)
+{
+    std::lock_guard<std::mutex> lock(fs_stat_cache_mutex);
+    auto iter = fs_stat_cache.find(path);
+
+    if (iter == fs_stat_cache.end())
+        return 0;
+
+    if (std::chrono::steady_clock::now() - iter->second.when >
+            std::chrono::seconds(FS_STAT_CACHE_TTL)) {
+        fs_stat_cache.erase(iter);
+        return 0;
+    }
+
+    *exists = iter->second.exists;
+    return 1;
+}
+
+void fs_stat_cache_store(const std::string &path, int exists)
+{
+    std::lock_guard<std::mutex> lock(fs_stat_cache_mutex);
+    fs_stat_cache_entry &entry = fs_stat_cache[path];
+
+    entry.exists = exists;
+    entry.when = std::chrono::steady_clock::now();
+}
+
+void fs_stat_cache_clear(void)
+{
+    std::lock_guard<std::mutex> lock(fs_stat_cache_mutex);
+    fs_stat_cache.clear();
+}
+
+int fs_verify_file_exists_cached(const std::string &path)
+{
+    int exists;
+
+    if (!fs_stat_cache_lookup(path, &exists)) {
+        exists = fs_verify_file_exists(path);
+        fs_stat_cache_store(path, exists);
+    }
+
+    return exists;
+}
+
+/* }}} */
+
+/* The file verifier {{{ */
+
+struct fs_verifier {
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    /* Paths waiting for a worker thread */
+    std::deque<std::string> queue;
+
+    /* Results waiting for fs_verifier_collect */
+    std::vector<fs_verify_result> results;
+
+    /* Bumped by fs_verifier_cancel, so in flight results can be dropped */
+    unsigned long generation;
+
+    bool shutdown;
+    std::vector<std::thread> workers;
+
+    /* Written to when results are ready, read end is given to the caller */
+    int wakeup_pipe[2];
+};
+
+static void fs_verifier_worker(struct fs_verifier *verifier)
+{
+    std::unique_lock<std::mutex> lock(verifier->mutex);
+
+    for (;;) {
+        verifier->cond.wait(lock, [verifier] {
+            return verifier->shutdown || !verifier->queue.empty();
+        });
+
+        if (verifier->shutdown)
+            break;
+
+        std::string path = verifier->queue.front();
+        unsigned long generation = verifier->generation;
+        verifier->queue.pop_front();
+
+        lock.unlock();
+        int exists = fs_verify_file_exists_cached(path);
+        lock.lock();
+
+        if (generation == verifier->generation) {
+            bool was_empty = verifier->results.empty();
+            verifier->results.push_back({path, exists});
+
+            /* Only wake the reader once per batch of results */
+            if (was_empty) {
+                char c = 0;
+                if (write(verifier->wakeup_pipe[1], &c, 1) == -1 &&
+                        errno != EAGAIN) {
+                    clog_error(CLOG_CGDB, "write failed: %s",
+                            strerror(errno));
+                }
+            }
+        }
+    }
+}
+
+struct fs_verifier *fs_verifier_create(int nthreads)
+{
+    struct fs_verifier *verifier = new fs_verifier();
+    int i;
+
+    verifier->generation = 0;
+    verifier->shutdown = false;
+
+    if (pipe(verifier->wakeup_pipe) == -1) {
+        clog_error(CLOG_CGDB, "pipe failed: %s", strerror(errno));
+        delete verifier;
+        return NULL;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        int flags = fcntl(verifier->wakeup_pipe[i], F_GETFL);
+        fcntl(verifier->wakeup_pipe[i], F_SETFL, flags | O_NONBLOCK);
+        fcntl(verifier->wakeup_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    for (i = 0; i < nthreads; ++i)
+        verifier->workers.push_back(std::thread(fs_verifier_worker, verifier));
+
+    return verifier;
+}
+
+void fs_verifier_destroy(struct fs_verifier *verifier)
+{
+    if (!verifier)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(verifier->mutex);
+        verifier->shutdown = true;
+        verifier->queue.clear();
+    }
+    verifier->cond.notify_all();
+
+    for (std::thread &worker : verifier->workers)
+        worker.join();
+
+    cgdb_close(verifier->wakeup_pipe[0]);
+    cgdb_close(verifier->wakeup_pipe[1]);
+
+    delete verifier;
+}
+
+int fs_verifier_get_fd(struct fs_verifier *verifier)
+{
+    return verifier->wakeup_pipe[0];
+}
+
+void fs_verifier_submit(struct fs_verifier *verifier, const std::string &path)
+{
+    {
+        std::lock_guard<std::mutex> lock(verifier->mutex);
+        verifier->queue.push_back(path);
+    }
+    verifier->cond.notify_one();
+}
+
+void fs_verifier_cancel(struct fs_verifier *verifier)
+{
+    std::lock_guard<std::mutex> lock(verifier->mutex);
+
+    verifier->queue.clear();
+    verifier->results.clear();
+    verifier->generation++;
+}
+
+int fs_verifier_collect(struct fs_verifier *verifier,
+        std::vector<fs_verify_result> &results)
+{
+    char buf[64];
+    int count;
+
+    /* Drain the wakeup pipe before taking the results, so a result
+     * added after this point wakes the reader again. */
+    while (read(verifier->wakeup_pipe[0], buf, sizeof(buf)) > 0)
+        ;
+
+    std::lock_guard<std::mutex> lock(verifier->mutex);
+
+    count = verifier->results.size();
+    for (fs_verify_result &result : verifier->results)
+        results.push_back(std::move(result));
+    verifier->results.clear();
+
+    return count;
+}
+
+/* }}} */
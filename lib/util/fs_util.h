@@ -2,6 +2,7 @@
 #define __FS_UTIL_H__
 
 #include <string>
+#include <vector>
 
 /*******************************************************************************
  *
@@ -86,4 +87,117 @@ int fs_util_file_exists_in_path(const std::string &filePath);
  */
 int fs_verify_file_exists(const std::string &path);
 
+/* fs_stat_cache_lookup:
+ * ---------------------
+ *
+ * Looks up the result of a previous existence check for path.
+ *
+ * The stat cache remembers whether a path existed for a short time
+ * (FS_STAT_CACHE_TTL seconds), so that reopening the file dialog on a
+ * slow file system (NFS) does not stat every file again.
+ *
+ * @param path
+ * The path to look up.
+ *
+ * @param exists
+ * Set to 1 if the path existed, or 0 if it did not, when an entry is found.
+ *
+ * @return
+ * 1 if a fresh entry was found, otherwise 0.
+ */
+#define FS_STAT_CACHE_TTL 30
+int fs_stat_cache_lookup(const std::string &path, int *exists);
+
+/* fs_stat_cache_store:
+ * --------------------
+ *
+ * Records the result of an existence check for path in the stat cache.
+ */
+void fs_stat_cache_store(const std::string &path, int exists);
+
+/* fs_stat_cache_clear:
+ * --------------------
+ *
+ * Forgets every entry in the stat cache.
+ */
+void fs_stat_cache_clear(void);
+
+/* fs_verify_file_exists_cached:
+ * -----------------------------
+ *
+ * Like fs_verify_file_exists, but answers from the stat cache when possible
+ * and records the result in the cache otherwise.
+ *
+ * @return
+ * 1 if the file exists, otherwise 0.
+ */
+int fs_verify_file_exists_cached(const std::string &path);
+
+/*******************************************************************************
+ *
+ * The file verifier checks if files exist on a small pool of worker threads.
+ *
+ * Paths are submitted with fs_verifier_submit and the results are collected
+ * on the calling thread with fs_verifier_collect. The descriptor returned by
+ * fs_verifier_get_fd becomes readable whenever new results are available, so
+ * it can be added to the main loop's select set.
+ *
+ ******************************************************************************/
+
+struct fs_verifier;
+
+/* The result of verifying a single path */
+struct fs_verify_result {
+    std::string path;
+    int exists;
+};
+
+/* fs_verifier_create:
+ * -------------------
+ *
+ *  nthreads - The number of worker threads to use.
+ *
+ * Returns the new verifier, or NULL on error.
+ */
+struct fs_verifier *fs_verifier_create(int nthreads);
+
+/* fs_verifier_destroy:
+ * --------------------
+ *
+ * Stops the worker threads and frees the verifier.
+ */
+void fs_verifier_destroy(struct fs_verifier *verifier);
+
+/* fs_verifier_get_fd:
+ * -------------------
+ *
+ * Returns the descriptor that becomes readable when results are ready.
+ */
+int fs_verifier_get_fd(struct fs_verifier *verifier);
+
+/* fs_verifier_submit:
+ * -------------------
+ *
+ * Queues path to be checked by the worker threads.
+ */
+void fs_verifier_submit(struct fs_verifier *verifier, const std::string &path);
+
+/* fs_verifier_cancel:
+ * -------------------
+ *
+ * Drops every queued path and every result not yet collected. Results
+ * for paths already being checked are discarded when they complete.
+ */
+void fs_verifier_cancel(struct fs_verifier *verifier);
+
+/* fs_verifier_collect:
+ * --------------------
+ *
+ * Moves the completed results into results.
+ *
+ * Returns the number of results collected.
+ */
+int fs_verifier_collect(struct fs_verifier *verifier,
+        std::vector<fs_verify_result> &results);
+
 #endif
@@ -155,6 +155,21 @@ int swin_scrl(int n)
     return scrl(n);
 }
 
+int swin_wscrl(SWINDOW *win, int n)
+{
+    return wscrl((WINDOW *)win, n);
+}
+
+int swin_scrollok(SWINDOW *win, int bf)
+{
+    return scrollok((WINDOW *)win, bf);
+}
+
+int swin_idlok(SWINDOW *win, int bf)
+{
+    return idlok((WINDOW *)win, bf);
+}
+
 int swin_keypad(SWINDOW *win, int bf)
 {
     return keypad((WINDOW *)win, bf);
@@ -107,6 +107,18 @@ int swin_delwin(SWINDOW *win);
 /* Scroll window up n lines */
 int swin_scrl(int n);   
 
+/* Scroll a window up n lines, or down if n is negative. The window must
+   allow scrolling, see swin_scrollok. */
+int swin_wscrl(SWINDOW *win, int n);
+
+/* Controls whether a window can be scrolled, either by swin_wscrl or by
+   writing past its bottom line. */
+int swin_scrollok(SWINDOW *win, int bf);
+
+/* Allows curses to use the terminal's insert and delete line capabilities
+   when updating the window, so scrolled lines aren't sent again. */
+int swin_idlok(SWINDOW *win, int bf);
+
 /* The keypad option enables the keypad of the user's terminal. If enabled 
    the user can press a function key (such as an arrow key) and wgetch returns
    a single value representing the function key, as in KEY_LEFT. If disabled
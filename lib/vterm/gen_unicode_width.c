@@ -0,0 +1,73 @@
+/* Writes unicode_width.inc, the width of every codepoint as looked up by
+ * vterm_unicode_width, from the interval tables in unicode.c.
+ *
+ *   make -C lib/vterm unicode-width
+ *
+ * Run it whenever the tables there change.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define UNICODE_WIDTH_FROM_TABLES
+#include "unicode.c"
+
+#define BLOCKS (0x110000 >> 8)
+
+static unsigned char stage1[BLOCKS];
+static unsigned char stage2[256][64];
+
+int main(void)
+{
+  int nstage2 = 0, block, i;
+
+  for(block = 0; block < BLOCKS; block++) {
+    unsigned char bits[64] = { 0 };
+
+    for(i = 0; i < 256; i++) {
+      int width = unicode_width_from_tables((block << 8) | i);
+
+      /* 3 stands for -1 */
+      bits[i >> 2] |= (width < 0 ? 3 : width) << ((i & 3) * 2);
+    }
+
+    /* Blocks that are the same are stored once */
+    for(i = 0; i < nstage2; i++)
+      if(memcmp(stage2[i], bits, sizeof(bits)) == 0)
+        break;
+    if(i == nstage2) {
+      if(nstage2 == 256) {
+        fprintf(stderr, "gen_unicode_width: too many unique blocks\n");
+        return 1;
+      }
+      memcpy(stage2[nstage2++], bits, sizeof(bits));
+    }
+    stage1[block] = i;
+  }
+
+  printf("/* Generated from unicode_width_from_tables() in unicode.c, do not edit.\n"
+         " * Regenerate it whenever the interval tables there change.\n"
+         " *\n"
+         " * width_stage1 maps each block of 256 codepoints to a block of\n"
+         " * width_stage2, which holds 2 bits per codepoint: the width, or 3 for\n"
+         " * control characters (width -1).\n"
+         " */\n"
+         "\n"
+         "static const unsigned char width_stage1[0x110000 >> 8] = {\n");
+  for(block = 0; block < BLOCKS; block++)
+    printf("%s%4d%s", block % 16 ? "" : " ", stage1[block],
+           block % 16 == 15 ? ",\n" : ",");
+  printf("};\n"
+         "\n"
+         "static const unsigned char width_stage2[%d][64] = {\n", nstage2);
+  for(block = 0; block < nstage2; block++) {
+    printf("  {\n");
+    for(i = 0; i < 64; i++)
+      printf("%s0x%02x%s", i % 16 ? "" : "    ", stage2[block][i],
+             i == 63 ? "\n" : i % 16 == 15 ? ",\n" : ",");
+    printf("  },\n");
+  }
+  printf("};\n");
+
+  return 0;
+}
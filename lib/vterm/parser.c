@@ -1,8 +1,13 @@
 #include "vterm_internal.h"
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #undef DEBUG_PARSER
 
 static bool is_intermed(unsigned char c)
@@ -10,6 +15,62 @@ static bool is_intermed(unsigned char c)
   return c >= 0x20 && c <= 0x2f;
 }
 
+/* Find how many bytes at the start of bytes are plain text, that is up to
+ * the next C0 control or DEL. Without UTF-8, bytes with the high bit set
+ * end the text too, as they may be C1 controls.
+ *
+ * Program output is mostly long runs of text, so they are scanned 16 (or 8)
+ * bytes at a time rather than going through the parser a byte at a time.
+ */
+static size_t text_run_length(const char *bytes, size_t len, bool utf8)
+{
+  size_t pos = 0;
+
+#ifdef __SSE2__
+  const __m128i c0 = _mm_set1_epi8(0x1f);
+  const __m128i del = _mm_set1_epi8(0x7f);
+
+  for( ; pos + 16 <= len; pos += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(bytes + pos));
+    /* min(x, 0x1f) == x is an unsigned x <= 0x1f */
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(x, c0), x),
+                                _mm_cmpeq_epi8(x, del));
+    int mask = _mm_movemask_epi8(stop);
+
+    if(!utf8)
+      mask |= _mm_movemask_epi8(x);
+    if(mask)
+      return pos + __builtin_ctz(mask);
+  }
+#else
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t high = 0x8080808080808080ULL;
+
+  for( ; pos + 8 <= len; pos += 8) {
+    uint64_t x, d, stop;
+
+    memcpy(&x, bytes + pos, sizeof(x));
+    d = x ^ (ones * 0x7f);
+    /* Set a high bit if any byte is below 0x20 or is 0x7f. It may flag
+     * other bytes after the first one, the loop below finds which. */
+    stop = ((x - ones * 0x20) & ~x & high) | ((d - ones) & ~d & high);
+    if(!utf8)
+      stop |= x & high;
+    if(stop)
+      break;
+  }
+#endif
+
+  for( ; pos < len; pos++) {
+    unsigned char c = bytes[pos];
+
+    if(c < 0x20 || c == 0x7f || (!utf8 && c >= 0x80))
+      break;
+  }
+
+  return pos;
+}
+
 static void do_control(VTerm *vt, unsigned char control)
 {
   if(vt->parser.callbacks && vt->parser.callbacks->control)
@@ -356,8 +417,12 @@ string_state:
       }
       else {
         size_t eaten = 0;
+        /* Hand the whole run of text to the callback at once, the byte
+         * at pos is already known to be text */
+        size_t run = 1 + text_run_length(bytes + pos + 1, len - pos - 1,
+                                         vt->mode.utf8);
         if(vt->parser.callbacks && vt->parser.callbacks->text)
-          eaten = (*vt->parser.callbacks->text)(bytes + pos, len - pos, vt->parser.cbdata);
+          eaten = (*vt->parser.callbacks->text)(bytes + pos, run, vt->parser.cbdata);
 
         if(!eaten) {
           DEBUG_LOG("libvterm: Text callback did not consume any input\n");
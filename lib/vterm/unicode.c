@@ -319,19 +319,52 @@ static int mk_wcswidth_cjk(const uint32_t *pwcs, size_t n)
 // ################################
 // ### The rest added by Paul Evans
 
+#ifdef UNICODE_WIDTH_FROM_TABLES
 static const struct interval fullwidth[] = {
 #include "fullwidth.inc"
 };
 
-INTERNAL int vterm_unicode_width(uint32_t codepoint)
+/* The width of a codepoint, straight from the interval tables. Only built
+ * into gen_unicode_width.c, which writes unicode_width.inc from it, and
+ * the test that checks the two agree. */
+static int unicode_width_from_tables(uint32_t codepoint)
 {
   if(bisearch(codepoint, fullwidth, sizeof(fullwidth) / sizeof(fullwidth[0]) - 1))
     return 2;
 
   return mk_wcwidth(codepoint);
 }
+#endif
+
+#include "unicode_width.inc"
+
+/* The width of every codepoint is precomputed into a two level table,
+ * 2 bits per codepoint, so a lookup is two loads rather than a couple
+ * of binary searches. */
+INTERNAL int vterm_unicode_width(uint32_t codepoint)
+{
+  unsigned int code;
+
+  /* Plain ASCII is by far the most common */
+  if(codepoint >= 0x20 && codepoint < 0x7f)
+    return 1;
+
+  /* Beyond Unicode, nothing is in the tables */
+  if(codepoint >= 0x110000)
+    return 1;
+
+  code = width_stage2[width_stage1[codepoint >> 8]][(codepoint & 0xff) >> 2];
+  code = (code >> ((codepoint & 3) * 2)) & 3;
+
+  /* 3 stands for -1 */
+  return (int)code - ((code == 3) << 2);
+}
 
 INTERNAL int vterm_unicode_is_combining(uint32_t codepoint)
 {
+  /* Nothing before U+0300 combines */
+  if(codepoint < combining[0].first)
+    return 0;
+
   return bisearch(codepoint, combining, sizeof(combining) / sizeof(struct interval) - 1);
 }
@@ -0,0 +1,128 @@
+/* Times the vterm parser over recorded gdb output, lib/vterm/parser.c.
+ *
+ * The output is written to the terminal in chunks, the way cgdb reads it
+ * from gdb. It is timed twice: with a text callback that walks its bytes
+ * up to the first control, the way the decoder in state.c does, which is
+ * the parser alone, and with the screen cgdb draws the gdb window from.
+ *
+ * To compare two versions of the parser, link this file against each
+ * one's libcgdbvterm.a and run both on the same input.
+ *
+ *   make -C testsuite bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vterm.h"
+
+#define CHUNK_SIZE 4096
+#define MIN_SECONDS 2.0
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t counted;
+
+/* Takes the text up to the first control, as the decoder would */
+static int scan_text(const char *bytes, size_t len, void *user)
+{
+  size_t i;
+
+  (void)user;
+
+  for(i = 0; i < len; i++) {
+    unsigned char c = bytes[i];
+
+    if(c < 0x20 || c == 0x7f)
+      break;
+  }
+
+  counted += i;
+  return i;
+}
+
+static int count_control(unsigned char control, void *user)
+{
+  (void)control;
+  (void)user;
+
+  counted++;
+  return 1;
+}
+
+static const VTermParserCallbacks scanning = {
+  scan_text, count_control, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/* Writes the buffer to a fresh terminal in chunks, over and over for at
+ * least MIN_SECONDS. Returns MB per second. */
+static double run(const char *buf, size_t len, int screen)
+{
+  VTerm *vt = vterm_new(50, 120);
+  size_t total = 0, pos, n;
+  double start, elapsed;
+
+  vterm_set_utf8(vt, 1);
+  if(screen)
+    vterm_screen_reset(vterm_obtain_screen(vt), 1);
+  else
+    vterm_parser_set_callbacks(vt, &scanning, NULL);
+
+  start = now();
+  do {
+    for(pos = 0; pos < len; pos += n) {
+      n = len - pos < CHUNK_SIZE ? len - pos : CHUNK_SIZE;
+      vterm_input_write(vt, buf + pos, n);
+    }
+    total += len;
+    elapsed = now() - start;
+  } while(elapsed < MIN_SECONDS);
+
+  vterm_free(vt);
+
+  return total / elapsed / (1 << 20);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *fp;
+  char *buf;
+  size_t len;
+
+  if(argc != 2) {
+    fprintf(stderr, "usage: %s <gdb output>\n", argv[0]);
+    return 1;
+  }
+
+  fp = fopen(argv[1], "rb");
+  if(!fp) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  /* The output is replayed many times, it only has to fit in memory */
+  fseek(fp, 0, SEEK_END);
+  len = ftell(fp);
+  rewind(fp);
+  buf = malloc(len);
+  if(!buf || fread(buf, 1, len, fp) != len) {
+    fprintf(stderr, "%s: read failed\n", argv[1]);
+    return 1;
+  }
+  fclose(fp);
+
+  printf("%zu bytes of gdb output, in chunks of %d\n", len, CHUNK_SIZE);
+  printf("parser: %8.1f MB/s\n", run(buf, len, 0));
+  printf("screen: %8.1f MB/s\n", run(buf, len, 1));
+
+  free(buf);
+
+  return 0;
+}
@@ -0,0 +1,243 @@
+/* Tests of the event loop, lib/util/event_loop.cpp */
+
+#include <unistd.h>
+
+#include <string>
+
+#include "event_loop.h"
+#include "unit.h"
+
+static struct event_loop *loop;
+
+/* What the callbacks did, in order */
+static std::string trace;
+
+/* The number of times the loop went round, counted by an idle callback */
+static int passes;
+
+static int record(void *context)
+{
+    trace += *(const char *)context;
+    return 0;
+}
+
+static int quit(void *context)
+{
+    (void)context;
+
+    event_loop_quit(loop);
+    return 0;
+}
+
+static int count_pass(void *context)
+{
+    (void)context;
+
+    passes++;
+    return 0;
+}
+
+static int fail(void *context)
+{
+    (void)context;
+
+    return -1;
+}
+
+static void test_timers(void)
+{
+    int id;
+
+    /* Timers run in the order of their deadlines */
+    loop = event_loop_create();
+    trace.clear();
+    event_loop_add_timer(loop, 30, record, (void *)"c");
+    event_loop_add_timer(loop, 10, record, (void *)"a");
+    event_loop_add_timer(loop, 20, record, (void *)"b");
+    event_loop_add_timer(loop, 40, quit, NULL);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "abc");
+    event_loop_destroy(loop);
+
+    /* A cancelled timer never runs, cancelling it twice is harmless */
+    loop = event_loop_create();
+    trace.clear();
+    id = event_loop_add_timer(loop, 10, record, (void *)"x");
+    event_loop_add_timer(loop, 20, record, (void *)"a");
+    event_loop_add_timer(loop, 30, quit, NULL);
+    event_loop_cancel_timer(loop, id);
+    event_loop_cancel_timer(loop, id);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "a");
+    event_loop_destroy(loop);
+
+    /* A failing timer stops the loop with an error */
+    loop = event_loop_create();
+    event_loop_add_timer(loop, 0, fail, NULL);
+    UNIT_CHECK(event_loop_run(loop) == -1);
+    event_loop_destroy(loop);
+}
+
+static int readd_timer(void *context)
+{
+    (void)context;
+
+    trace += 'a';
+    event_loop_add_timer(loop, 0, record, (void *)"b");
+    event_loop_add_timer(loop, 0, quit, NULL);
+    return 0;
+}
+
+/* A timer added by a timer waits for the next pass, even when it has
+ * already expired */
+static void test_timer_from_timer(void)
+{
+    loop = event_loop_create();
+    trace.clear();
+    passes = 0;
+    event_loop_add_idle(loop, count_pass, NULL);
+    event_loop_add_timer(loop, 0, readd_timer, NULL);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "ab");
+    UNIT_CHECK(passes == 2);
+    event_loop_destroy(loop);
+}
+
+static int idle_id;
+
+/* Runs three times, then removes itself */
+static int idle_three_times(void *context)
+{
+    (void)context;
+
+    trace += 'i';
+    if (trace.size() == 3)
+        event_loop_remove_idle(loop, idle_id);
+    return 0;
+}
+
+/* Wakes the loop up five times, then stops it */
+static int tick(void *context)
+{
+    (void)context;
+
+    if (passes < 5)
+        event_loop_add_timer(loop, 0, tick, NULL);
+    else
+        event_loop_quit(loop);
+    return 0;
+}
+
+static void test_idles(void)
+{
+    int id;
+
+    /* Idles run once every pass, and can be removed from inside one */
+    loop = event_loop_create();
+    trace.clear();
+    passes = 0;
+    idle_id = event_loop_add_idle(loop, idle_three_times, NULL);
+    event_loop_add_idle(loop, count_pass, NULL);
+    event_loop_add_timer(loop, 0, tick, NULL);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "iii");
+    UNIT_CHECK(passes == 5);
+    event_loop_destroy(loop);
+
+    /* A removed idle never runs, unknown ids are ignored */
+    loop = event_loop_create();
+    trace.clear();
+    id = event_loop_add_idle(loop, record, (void *)"x");
+    event_loop_remove_idle(loop, id);
+    event_loop_remove_idle(loop, id + 100);
+    event_loop_add_idle(loop, quit, NULL);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace.empty());
+    event_loop_destroy(loop);
+
+    /* Quitting from an idle skips the ones after it, and the loop can be
+     * run again */
+    loop = event_loop_create();
+    trace.clear();
+    event_loop_add_idle(loop, quit, NULL);
+    event_loop_add_idle(loop, record, (void *)"x");
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace.empty());
+    event_loop_destroy(loop);
+}
+
+static int pipe_a[2], pipe_b[2];
+
+static int read_fd(void *context, int fd)
+{
+    char c;
+
+    UNIT_CHECK(read(fd, &c, 1) == 1);
+    trace += *(const char *)context;
+    if (trace.size() == 2)
+        event_loop_quit(loop);
+    return 0;
+}
+
+/* Reads its byte and stops waiting on the other pipe */
+static int read_and_remove(void *context, int fd)
+{
+    char c;
+
+    (void)context;
+
+    UNIT_CHECK(read(fd, &c, 1) == 1);
+    trace += 'a';
+    UNIT_CHECK(event_loop_remove_fd(loop, pipe_b[0]) == 0);
+    event_loop_add_timer(loop, 10, quit, NULL);
+    return 0;
+}
+
+static void test_fds(void)
+{
+    UNIT_CHECK(pipe(pipe_a) == 0);
+    UNIT_CHECK(pipe(pipe_b) == 0);
+
+    /* Readable descriptors are handled in the order they were added */
+    loop = event_loop_create();
+    trace.clear();
+    UNIT_CHECK(event_loop_add_fd(loop, pipe_b[0], read_fd, (void *)"b") == 0);
+    UNIT_CHECK(event_loop_add_fd(loop, pipe_a[0], read_fd, (void *)"a") == 0);
+    UNIT_CHECK(event_loop_add_fd(loop, pipe_a[0], read_fd, (void *)"a") == -1);
+    UNIT_CHECK(write(pipe_a[1], "x", 1) == 1);
+    UNIT_CHECK(write(pipe_b[1], "x", 1) == 1);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "ba");
+    UNIT_CHECK(event_loop_remove_fd(loop, pipe_a[0]) == 0);
+    UNIT_CHECK(event_loop_remove_fd(loop, pipe_a[0]) == -1);
+    UNIT_CHECK(event_loop_remove_fd(loop, pipe_b[0]) == 0);
+    event_loop_destroy(loop);
+
+    /* A descriptor removed by an earlier callback is not handled, even
+     * though it was readable */
+    loop = event_loop_create();
+    trace.clear();
+    event_loop_add_fd(loop, pipe_a[0], read_and_remove, NULL);
+    event_loop_add_fd(loop, pipe_b[0], read_fd, (void *)"b");
+    UNIT_CHECK(write(pipe_a[1], "x", 1) == 1);
+    UNIT_CHECK(write(pipe_b[1], "x", 1) == 1);
+    UNIT_CHECK(event_loop_run(loop) == 0);
+    UNIT_CHECK(trace == "a");
+    event_loop_destroy(loop);
+
+    close(pipe_a[0]);
+    close(pipe_a[1]);
+    close(pipe_b[0]);
+    close(pipe_b[1]);
+}
+
+int main(void)
+{
+    test_timers();
+    test_timer_from_timer();
+    test_idles();
+    test_fds();
+
+    return UNIT_RESULT();
+}
@@ -0,0 +1,135 @@
+/* Tests of the fuzzy finder of the file dialog, cgdb/fuzzy.cpp */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "fuzzy.h"
+#include "unit.h"
+
+static void test_match(void)
+{
+    int positions[3];
+
+    /* The characters must appear in order, case is ignored */
+    UNIT_CHECK(fuzzy_match("src/main.c", "mc", NULL) >= 0);
+    UNIT_CHECK(fuzzy_match("src/main.c", "MAIN", NULL) >= 0);
+    UNIT_CHECK(fuzzy_match("src/main.c", "cm", NULL) > 0);
+    UNIT_CHECK(fuzzy_match("src/main.c", "xyz", NULL) == -1);
+    UNIT_CHECK(fuzzy_match("main.c", "main.cc", NULL) == -1);
+    UNIT_CHECK(fuzzy_match("main.c", "", NULL) == 0);
+
+    /* The tightest match ending at the first full match is reported */
+    UNIT_CHECK(fuzzy_match("a/ab/abc", "abc", positions) > 0);
+    UNIT_CHECK(positions[0] == 5);
+    UNIT_CHECK(positions[1] == 6);
+    UNIT_CHECK(positions[2] == 7);
+}
+
+static void test_score(void)
+{
+    /* Consecutive characters beat scattered ones */
+    UNIT_CHECK(fuzzy_match("lib/util.cpp", "util", NULL) >
+            fuzzy_match("lib/uxtxixl.cpp", "util", NULL));
+
+    /* The file name beats the directory */
+    UNIT_CHECK(fuzzy_match("tgdb/io.cpp", "tgdb", NULL) <
+            fuzzy_match("io/tgdb.cpp", "tgdb", NULL));
+
+    /* The start of a word beats the middle of one */
+    UNIT_CHECK(fuzzy_match("x/sources.cpp", "s", NULL) >
+            fuzzy_match("x/resource", "s", NULL));
+}
+
+/* The entries matching query, found one at a time */
+static std::vector<int> brute_force(char **entries, int count,
+        const std::string &query)
+{
+    std::vector<int> matches;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (query.empty() || fuzzy_match(entries[i], query.c_str(), NULL) >= 0)
+            matches.push_back(i);
+    }
+
+    return matches;
+}
+
+/* The entries the index matched, in the order of the entries */
+static std::vector<int> index_matches(struct fuzzy_index *index)
+{
+    std::vector<int> matches;
+    int count = fuzzy_index_result_count(index);
+    int i;
+
+    for (i = 0; i < count; i++)
+        matches.push_back(fuzzy_index_result(index, i));
+    std::sort(matches.begin(), matches.end());
+
+    return matches;
+}
+
+static void test_index(void)
+{
+    static const char *names[] = {
+        "cgdb/cgdb.cpp", "cgdb/cgdbrc.cpp", "cgdb/filedlg.cpp",
+        "cgdb/fuzzy.cpp", "cgdb/sources.cpp", "lib/util/fs_util.cpp",
+        "lib/util/event_loop.cpp", "lib/tgdb/tgdb.cpp", "lib/tgdb/TGDB_IO.cpp",
+        "lib/vterm/unicode.c", "README.md", "doc/cgdb.texi"
+    };
+    int count = sizeof(names) / sizeof(names[0]);
+    char **entries = (char **)names;
+    struct fuzzy_index *index = fuzzy_index_new();
+    std::string query;
+    int i;
+
+    fuzzy_index_build(index, entries, count);
+
+    /* An empty query matches everything, in order */
+    UNIT_CHECK(fuzzy_index_set_query(index, "") == count);
+    for (i = 0; i < count; i++)
+        UNIT_CHECK(fuzzy_index_result(index, i) == i);
+
+    /* The best match comes first */
+    fuzzy_index_set_query(index, "fuzzy");
+    UNIT_CHECK(fuzzy_index_result_count(index) == 1);
+    UNIT_CHECK(fuzzy_index_result(index, 0) == 3);
+    fuzzy_index_set_query(index, "tgdbio");
+    UNIT_CHECK(fuzzy_index_result_count(index) == 1);
+    UNIT_CHECK(fuzzy_index_result(index, 0) == 8);
+
+    /* Typing and deleting characters, which reuses the earlier results,
+     * finds what matching from scratch finds */
+    srand(1);
+    for (i = 0; i < 2000; i++) {
+        if (!query.empty() && rand() % 3 == 0)
+            query.erase(query.size() - 1);
+        else
+            query.push_back("cgdbrtuilsoCGDB._/"[rand() % 18]);
+
+        if (query.size() > 6)
+            query.clear();
+
+        fuzzy_index_set_query(index, query.c_str());
+        UNIT_CHECK(index_matches(index) == brute_force(entries, count, query));
+    }
+
+    /* Rebuilding forgets the old entries */
+    fuzzy_index_build(index, entries, 2);
+    UNIT_CHECK(fuzzy_index_set_query(index, "cgdb") == 2);
+
+    fuzzy_index_free(index);
+}
+
+int main(void)
+{
+    test_match();
+    test_score();
+    test_index();
+
+    return UNIT_RESULT();
+}
@@ -0,0 +1,41 @@
+/* Tests of the literal :grep looks for before running the regex,
+ * cgdb/grep_literal.cpp */
+
+#include "grep_literal.h"
+#include "unit.h"
+
+int main(void)
+{
+    /* Plain text is the literal */
+    UNIT_CHECK(grep_literal("main") == "main");
+    UNIT_CHECK(grep_literal("int main") == "int main");
+
+    /* The longest run between the regex operators */
+    UNIT_CHECK(grep_literal("ab.*source_grep") == "source_grep");
+    UNIT_CHECK(grep_literal("^static int") == "static int");
+    UNIT_CHECK(grep_literal("foo[0-9]+barbaz") == "barbaz");
+
+    /* A character made optional is not required */
+    UNIT_CHECK(grep_literal("colou?r") == "colo");
+    UNIT_CHECK(grep_literal("ab*") == "a");
+
+    /* Escaped metacharacters are literals */
+    UNIT_CHECK(grep_literal("a\\.b") == "a.b");
+    UNIT_CHECK(grep_literal("f\\(x\\)") == "f(x)");
+    UNIT_CHECK(grep_literal("a\\\\b") == "a\\b");
+    UNIT_CHECK(grep_literal("\\$x\\/y") == "$x/y");
+
+    /* Other escapes are anchors or classes, and end the run */
+    UNIT_CHECK(grep_literal("\\<main\\>") == "main");
+    UNIT_CHECK(grep_literal("\\`begin") == "begin");
+    UNIT_CHECK(grep_literal("end\\'") == "end");
+    UNIT_CHECK(grep_literal("ab\\wcde") == "cde");
+    UNIT_CHECK(grep_literal("\\bword\\b") == "word");
+
+    /* Groups and alternation give up */
+    UNIT_CHECK(grep_literal("(abc)") == "");
+    UNIT_CHECK(grep_literal("foo|bar") == "");
+    UNIT_CHECK(grep_literal("abc\\") == "");
+
+    return UNIT_RESULT();
+}
@@ -0,0 +1,48 @@
+/* Tests of the counting of the replies the info window waits for,
+ * cgdb/replies.cpp */
+
+#include "replies.h"
+#include "unit.h"
+
+int main(void)
+{
+    struct replies r = { 0, 0 };
+
+    /* Nothing asked for, nothing to use */
+    UNIT_CHECK(!replies_waiting(&r));
+    UNIT_CHECK(!replies_receive(&r));
+
+    /* The replies to the requests made */
+    replies_expect(&r);
+    replies_expect(&r);
+    UNIT_CHECK(replies_waiting(&r));
+    UNIT_CHECK(replies_receive(&r));
+    UNIT_CHECK(replies_waiting(&r));
+    UNIT_CHECK(replies_receive(&r));
+    UNIT_CHECK(!replies_waiting(&r));
+
+    /* The replies to the requests made before a drop are skipped, the
+     * ones after it are used */
+    replies_expect(&r);
+    replies_expect(&r);
+    replies_drop(&r);
+    UNIT_CHECK(!replies_waiting(&r));
+    replies_expect(&r);
+    UNIT_CHECK(replies_waiting(&r));
+    UNIT_CHECK(!replies_receive(&r));
+    UNIT_CHECK(!replies_receive(&r));
+    UNIT_CHECK(replies_waiting(&r));
+    UNIT_CHECK(replies_receive(&r));
+    UNIT_CHECK(!replies_waiting(&r));
+
+    /* Dropping twice skips each reply once */
+    replies_expect(&r);
+    replies_drop(&r);
+    replies_drop(&r);
+    replies_expect(&r);
+    UNIT_CHECK(!replies_receive(&r));
+    UNIT_CHECK(replies_receive(&r));
+    UNIT_CHECK(r.waiting == 0 && r.stale == 0);
+
+    return UNIT_RESULT();
+}
@@ -0,0 +1,102 @@
+/* Tests of the ring the gdb I/O thread hands its events over in,
+ * lib/tgdb/tgdb_io_ring.h */
+
+#include <stddef.h>
+
+#include <thread>
+
+#include "tgdb_io_ring.h"
+#include "unit.h"
+
+/* The events are told apart by their size */
+static tgdb_io_event make_event(size_t n)
+{
+    tgdb_io_event event;
+
+    event.kind = TGDB_IO_CONSOLE;
+    event.data = NULL;
+    event.size = n;
+    event.output = NULL;
+
+    return event;
+}
+
+static void test_full_and_empty(void)
+{
+    tgdb_io_ring *ring = new tgdb_io_ring();
+    tgdb_io_event event;
+    size_t i, round;
+
+    /* The indexes are padded out to a line each */
+    UNIT_CHECK(sizeof(tgdb_io_ring_index) == TGDB_IO_CACHE_LINE);
+
+    UNIT_CHECK(!ring->pop(event));
+
+    /* Fill and drain it a few times over, so the indexes wrap around the
+     * events more than once */
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < TGDB_IO_RING_SIZE; i++)
+            UNIT_CHECK(ring->push(make_event(round * 1000 + i)));
+        UNIT_CHECK(!ring->push(make_event(0)));
+
+        for (i = 0; i < TGDB_IO_RING_SIZE; i++) {
+            UNIT_CHECK(ring->pop(event));
+            UNIT_CHECK(event.size == round * 1000 + i);
+        }
+        UNIT_CHECK(!ring->pop(event));
+    }
+
+    /* Half full, then interleaved */
+    for (i = 0; i < TGDB_IO_RING_SIZE / 2; i++)
+        UNIT_CHECK(ring->push(make_event(i)));
+    for (i = 0; i < TGDB_IO_RING_SIZE * 4; i++) {
+        UNIT_CHECK(ring->push(make_event(TGDB_IO_RING_SIZE / 2 + i)));
+        UNIT_CHECK(ring->pop(event));
+        UNIT_CHECK(event.size == i);
+    }
+
+    delete ring;
+}
+
+/* One thread pushes while another pops, every event arrives once and in
+ * order */
+static void test_threads(void)
+{
+    const size_t count = 1000000;
+    tgdb_io_ring *ring = new tgdb_io_ring();
+    tgdb_io_event event;
+    size_t next = 0, out_of_order = 0;
+
+    std::thread producer([ring, count]() {
+        size_t i;
+
+        for (i = 0; i < count; i++)
+            while (!ring->push(make_event(i)))
+                std::this_thread::yield();
+    });
+
+    while (next < count) {
+        if (!ring->pop(event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (event.size != next)
+            out_of_order++;
+        next++;
+    }
+
+    producer.join();
+
+    UNIT_CHECK(out_of_order == 0);
+    UNIT_CHECK(!ring->pop(event));
+
+    delete ring;
+}
+
+int main(void)
+{
+    test_full_and_empty();
+    test_threads();
+
+    return UNIT_RESULT();
+}
@@ -0,0 +1,272 @@
+/* Tests of the parsers of the gdb/mi replies to the info window's
+ * requests, lib/tgdb/tgdb_mi.cpp */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stretchy.h"
+#include "tgdb_mi.h"
+#include "unit.h"
+
+/* The output of the last line parsed */
+static struct gdbwire_mi_output *output;
+
+static void output_callback(void *context, struct gdbwire_mi_output *o)
+{
+    (void)context;
+
+    gdbwire_mi_output_free(output);
+    output = o;
+}
+
+/* Parse a line of gdb/mi output, it has to be a result record */
+static struct gdbwire_mi_result_record *parse(const char *line)
+{
+    struct gdbwire_mi_parser_callbacks callbacks = { NULL, output_callback };
+    struct gdbwire_mi_parser *parser = gdbwire_mi_parser_create(callbacks);
+
+    gdbwire_mi_output_free(output);
+    output = NULL;
+
+    gdbwire_mi_parser_push(parser, line);
+    gdbwire_mi_parser_push(parser, "\n");
+    gdbwire_mi_parser_destroy(parser);
+
+    if (!output || output->kind != GDBWIRE_MI_OUTPUT_RESULT) {
+        fprintf(stderr, "not a result record: %s\n", line);
+        exit(1);
+    }
+
+    return output->variant.result_record;
+}
+
+static bool equal(const char *a, const char *b)
+{
+    return a && b && strcmp(a, b) == 0;
+}
+
+static void test_stack_frames(void)
+{
+    struct tgdb_frame *frames;
+
+    UNIT_CHECK(tgdb_parse_stack_frames(parse(
+        "^done,stack=["
+        "frame={level=\"0\",addr=\"0x0000000000401136\",func=\"main\","
+        "file=\"main.c\",fullname=\"/src/main.c\",line=\"5\"},"
+        "frame={level=\"1\",addr=\"0x00007ffff7a2d830\","
+        "func=\"__libc_start_main\",from=\"/lib/libc.so.6\"}]"),
+        &frames) == 0);
+    UNIT_CHECK(sbcount(frames) == 2);
+    UNIT_CHECK(frames[0].level == 0);
+    UNIT_CHECK(frames[0].addr == 0x401136);
+    UNIT_CHECK(equal(frames[0].func, "main"));
+    UNIT_CHECK(equal(frames[0].file, "main.c"));
+    UNIT_CHECK(equal(frames[0].fullname, "/src/main.c"));
+    UNIT_CHECK(frames[0].line == 5);
+    UNIT_CHECK(frames[0].from == NULL);
+
+    /* A frame without a source file */
+    UNIT_CHECK(frames[1].level == 1);
+    UNIT_CHECK(frames[1].addr == 0x7ffff7a2d830ULL);
+    UNIT_CHECK(frames[1].file == NULL && frames[1].fullname == NULL);
+    UNIT_CHECK(frames[1].line == 0);
+    UNIT_CHECK(equal(frames[1].from, "/lib/libc.so.6"));
+    tgdb_free_frames(frames);
+
+    /* A frame without a level is numbered by its place */
+    UNIT_CHECK(tgdb_parse_stack_frames(parse(
+        "^done,stack=[frame={func=\"a\"},frame={func=\"b\"}]"),
+        &frames) == 0);
+    UNIT_CHECK(sbcount(frames) == 2 && frames[1].level == 1);
+    UNIT_CHECK(frames[0].addr == 0 && frames[0].func && !frames[0].file);
+    tgdb_free_frames(frames);
+
+    UNIT_CHECK(tgdb_parse_stack_frames(parse("^done,stack=[]"),
+        &frames) == 0);
+    UNIT_CHECK(sbcount(frames) == 0);
+
+    UNIT_CHECK(tgdb_parse_stack_frames(parse("^error,msg=\"No stack.\""),
+        &frames) == -1);
+    UNIT_CHECK(frames == NULL);
+}
+
+static void test_varobj(void)
+{
+    struct gdbwire_mi_result_record *record;
+    struct tgdb_varobj var, *vars;
+
+    /* The reply of -var-create */
+    record = parse("^done,name=\"cgdb_w1\",numchild=\"2\","
+        "value=\"{...}\",type=\"struct point\",thread-id=\"1\","
+        "has_more=\"0\"");
+    tgdb_parse_varobj(record->result, &var);
+    UNIT_CHECK(equal(var.name, "cgdb_w1"));
+    UNIT_CHECK(var.exp == NULL);
+    UNIT_CHECK(equal(var.value, "{...}"));
+    UNIT_CHECK(equal(var.type, "struct point"));
+    UNIT_CHECK(var.numchild == 2);
+    UNIT_CHECK(var.has_more == 0);
+    UNIT_CHECK(var.in_scope == 1 && !var.type_changed);
+    tgdb_free_varobj(&var);
+
+    /* The children of -var-list-children */
+    record = parse("^done,numchild=\"2\",children=["
+        "child={name=\"cgdb_w1.x\",exp=\"x\",numchild=\"0\","
+        "value=\"1\",type=\"int\"},"
+        "child={name=\"cgdb_w1.y\",exp=\"y\",numchild=\"0\","
+        "value=\"2\",type=\"int\"}],has_more=\"0\"");
+    vars = tgdb_parse_varobjs(tgdb_find_result(record->result, "children"));
+    UNIT_CHECK(sbcount(vars) == 2);
+    UNIT_CHECK(equal(vars[0].name, "cgdb_w1.x") && equal(vars[0].exp, "x"));
+    UNIT_CHECK(equal(vars[1].value, "2") && equal(vars[1].type, "int"));
+    UNIT_CHECK(vars[1].numchild == 0);
+    tgdb_free_varobjs(vars);
+
+    /* The changes of -var-update, in and out of scope, and a new type */
+    record = parse("^done,changelist=["
+        "{name=\"cgdb_l1\",value=\"3\",in_scope=\"true\","
+        "type_changed=\"false\",has_more=\"0\"},"
+        "{name=\"cgdb_l2\",in_scope=\"false\",type_changed=\"false\"},"
+        "{name=\"cgdb_l3\",in_scope=\"invalid\",has_more=\"0\"},"
+        "{name=\"cgdb_l4\",value=\"0x0\",in_scope=\"true\","
+        "type_changed=\"true\",new_type=\"char *\","
+        "new_num_children=\"1\",has_more=\"0\"}]");
+    vars = tgdb_parse_varobjs(
+        tgdb_find_result(record->result, "changelist"));
+    UNIT_CHECK(sbcount(vars) == 4);
+    UNIT_CHECK(equal(vars[0].value, "3") && vars[0].in_scope == 1);
+    UNIT_CHECK(vars[0].numchild == -1 && vars[0].type == NULL);
+    UNIT_CHECK(vars[1].in_scope == 0 && vars[1].value == NULL);
+    UNIT_CHECK(vars[2].in_scope == -1);
+    UNIT_CHECK(vars[3].type_changed && equal(vars[3].type, "char *"));
+    UNIT_CHECK(vars[3].numchild == 1);
+    tgdb_free_varobjs(vars);
+
+    /* Entries without a name are left out, no list gives none */
+    record = parse("^done,changelist=[{value=\"1\"},\"x\"]");
+    vars = tgdb_parse_varobjs(
+        tgdb_find_result(record->result, "changelist"));
+    UNIT_CHECK(vars == NULL);
+    UNIT_CHECK(tgdb_parse_varobjs(NULL) == NULL);
+}
+
+static void test_memory(void)
+{
+    struct tgdb_memory_block *blocks;
+
+    /* Two blocks around a hole that could not be read */
+    UNIT_CHECK(tgdb_parse_memory(parse(
+        "^done,memory=["
+        "{begin=\"0x601040\",offset=\"0x0\",end=\"0x601044\","
+        "contents=\"68656c6c\"},"
+        "{begin=\"0x601080\",offset=\"0x40\",end=\"0x601082\","
+        "contents=\"00ff\"}]"), &blocks) == 0);
+    UNIT_CHECK(sbcount(blocks) == 2);
+    UNIT_CHECK(blocks[0].addr == 0x601040);
+    UNIT_CHECK(sbcount(blocks[0].bytes) == 4);
+    UNIT_CHECK(memcmp(blocks[0].bytes, "hell", 4) == 0);
+    UNIT_CHECK(blocks[1].addr == 0x601080);
+    UNIT_CHECK(sbcount(blocks[1].bytes) == 2);
+    UNIT_CHECK(blocks[1].bytes[0] == 0x00 && blocks[1].bytes[1] == 0xff);
+    tgdb_free_memory(blocks);
+
+    /* A block without an address is left out */
+    UNIT_CHECK(tgdb_parse_memory(parse(
+        "^done,memory=[{contents=\"01\"}]"), &blocks) == 0);
+    UNIT_CHECK(blocks == NULL);
+
+    UNIT_CHECK(tgdb_parse_memory(parse(
+        "^error,msg=\"Unable to read memory.\""), &blocks) == -1);
+    UNIT_CHECK(blocks == NULL);
+}
+
+static void test_thread_info(void)
+{
+    struct tgdb_thread thread;
+
+    UNIT_CHECK(tgdb_parse_thread_info(parse(
+        "^done,threads=[{id=\"2\","
+        "target-id=\"Thread 0x7ffff7fd0700 (LWP 12)\",name=\"worker\","
+        "frame={level=\"0\",addr=\"0x4005d0\",func=\"poll\",args=[],"
+        "file=\"a.c\",fullname=\"/src/a.c\",line=\"5\"},"
+        "state=\"stopped\",core=\"1\"}],current-thread-id=\"1\""),
+        &thread) == 0);
+    UNIT_CHECK(thread.id == 2);
+    UNIT_CHECK(equal(thread.target_id, "Thread 0x7ffff7fd0700 (LWP 12)"));
+    UNIT_CHECK(equal(thread.name, "worker"));
+    UNIT_CHECK(equal(thread.func, "poll"));
+    UNIT_CHECK(equal(thread.file, "a.c"));
+    UNIT_CHECK(thread.line == 5);
+    UNIT_CHECK(!thread.running);
+    tgdb_free_thread(&thread);
+
+    /* A running thread has no frame */
+    UNIT_CHECK(tgdb_parse_thread_info(parse(
+        "^done,threads=[{id=\"3\",target-id=\"Thread 3\","
+        "state=\"running\"}]"), &thread) == 0);
+    UNIT_CHECK(thread.running && thread.name == NULL);
+    UNIT_CHECK(thread.func == NULL && thread.line == 0);
+    tgdb_free_thread(&thread);
+
+    /* A thread that exited gives an empty list */
+    UNIT_CHECK(tgdb_parse_thread_info(parse("^done,threads=[]"),
+        &thread) == -1);
+    UNIT_CHECK(tgdb_parse_thread_info(parse(
+        "^error,msg=\"Invalid thread id: 9\""), &thread) == -1);
+    UNIT_CHECK(thread.target_id == NULL);
+}
+
+static void test_registers(void)
+{
+    struct tgdb_register *registers;
+    char **names;
+    int *numbers;
+
+    /* gdb leaves holes in the numbers */
+    UNIT_CHECK(tgdb_parse_register_names(parse(
+        "^done,register-names=[\"rax\",\"rbx\",\"\",\"rip\"]"),
+        &names) == 0);
+    UNIT_CHECK(sbcount(names) == 4);
+    UNIT_CHECK(equal(names[0], "rax") && equal(names[3], "rip"));
+    UNIT_CHECK(equal(names[2], ""));
+    tgdb_free_register_names(names);
+
+    UNIT_CHECK(tgdb_parse_changed_registers(parse(
+        "^done,changed-registers=[\"0\",\"1\",\"16\"]"),
+        &numbers) == 0);
+    UNIT_CHECK(sbcount(numbers) == 3 && numbers[2] == 16);
+    sbfree(numbers);
+
+    UNIT_CHECK(tgdb_parse_changed_registers(parse(
+        "^error,msg=\"The program has no registers now.\""),
+        &numbers) == -1);
+    UNIT_CHECK(numbers == NULL);
+
+    /* A value without a number is left out */
+    UNIT_CHECK(tgdb_parse_register_values(parse(
+        "^done,register-values=[{number=\"0\",value=\"0x1c\"},"
+        "{value=\"0x2\"},{number=\"16\",value=\"0x401136\"}]"),
+        &registers) == 0);
+    UNIT_CHECK(sbcount(registers) == 2);
+    UNIT_CHECK(registers[0].number == 0 && equal(registers[0].value, "0x1c"));
+    UNIT_CHECK(registers[1].number == 16);
+    UNIT_CHECK(equal(registers[1].value, "0x401136"));
+    tgdb_free_registers(registers);
+
+    UNIT_CHECK(tgdb_parse_register_values(parse(
+        "^error,msg=\"No registers.\""), &registers) == -1);
+    UNIT_CHECK(registers == NULL);
+}
+
+int main(void)
+{
+    test_stack_frames();
+    test_varobj();
+    test_memory();
+    test_thread_info();
+    test_registers();
+
+    gdbwire_mi_output_free(output);
+
+    return UNIT_RESULT();
+}
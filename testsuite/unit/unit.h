@@ -0,0 +1,28 @@
+/* unit.h:
+ * -------
+ *
+ * A few macros for the unit tests of the pure logic in cgdb. Each test
+ * is a program run by make check, it fails if any UNIT_CHECK did.
+ */
+
+#ifndef _UNIT_H_
+#define _UNIT_H_
+
+#include <stdio.h>
+
+static int unit_failures;
+
+/* Check a condition, report it and keep going if it doesn't hold */
+#define UNIT_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #cond); \
+            unit_failures++; \
+        } \
+    } while (0)
+
+/* The exit status of the test, 0 if every check held */
+#define UNIT_RESULT() (unit_failures ? 1 : 0)
+
+#endif /* _UNIT_H_ */
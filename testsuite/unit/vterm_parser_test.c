@@ -0,0 +1,161 @@
+/* Tests of the text runs the vterm parser hands to the text callback,
+ * lib/vterm/parser.c. Built twice, with and without SSE2, so both ways
+ * of scanning for the end of a run are tested. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vterm.h"
+#include "unit.h"
+
+#define EVENTS_MAX 8192
+
+/* What the parser reported: text bytes as themselves, controls as 256
+ * plus the control, and how many text callbacks there were */
+static int events[EVENTS_MAX];
+static int nevents;
+static int ntexts;
+static int utf8;
+
+static int is_text(unsigned char c)
+{
+  return c >= 0x20 && c != 0x7f && (utf8 || c < 0x80);
+}
+
+static int on_text(const char *bytes, size_t len, void *user)
+{
+  size_t i;
+
+  (void)user;
+
+  for(i = 0; i < len; i++) {
+    /* A run never goes past the text. Without UTF-8 a byte with the high
+     * bit set can only start one. */
+    UNIT_CHECK(is_text(bytes[i]) || (i == 0 && !utf8));
+    if(nevents < EVENTS_MAX)
+      events[nevents++] = (unsigned char)bytes[i];
+  }
+  ntexts++;
+
+  return len;
+}
+
+static int on_control(unsigned char control, void *user)
+{
+  (void)user;
+
+  if(nevents < EVENTS_MAX)
+    events[nevents++] = 256 + control;
+
+  return 1;
+}
+
+static const VTermParserCallbacks callbacks = {
+  on_text, on_control, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/* A byte that is text or a control that doesn't start an escape */
+static unsigned char random_byte(void)
+{
+  static const unsigned char controls[] = { 0x00, 0x07, 0x08, 0x09, 0x0a,
+    0x0d, 0x7f };
+
+  for(;;) {
+    int r = rand() % 100;
+    unsigned char c;
+
+    if(r < 8)
+      return controls[rand() % sizeof(controls)];
+
+    c = r < 90 ? 0x20 + rand() % 0x5f : 0x80 + rand() % 0x80;
+
+    /* Without UTF-8 0x80 to 0x9f are C1 controls, some start an escape */
+    if(!utf8 && c >= 0x80 && c < 0xa0)
+      continue;
+    return c;
+  }
+}
+
+static void check_buffer(VTerm *vt, const unsigned char *buf, size_t len)
+{
+  int expected[EVENTS_MAX];
+  int nexpected = 0, runs = 0, in_run = 0, i;
+  size_t pos;
+
+  /* The parser a byte at a time: NUL and DEL are dropped, other C0s are
+   * controls. Any run of text between them is one callback. Without UTF-8
+   * a byte with the high bit set starts a new run. */
+  for(pos = 0; pos < len; pos++) {
+    unsigned char c = buf[pos];
+
+    if(is_text(c) || (!utf8 && c >= 0x80)) {
+      expected[nexpected++] = c;
+      runs += !in_run || !is_text(c);
+      in_run = 1;
+      continue;
+    }
+
+    in_run = 0;
+    if(c != 0x00 && c < 0x20)
+      expected[nexpected++] = 256 + c;
+  }
+
+  nevents = 0;
+  ntexts = 0;
+  vterm_input_write(vt, (const char *)buf, len);
+
+  UNIT_CHECK(nevents == nexpected);
+  for(i = 0; i < nevents && i < nexpected; i++)
+    UNIT_CHECK(events[i] == expected[i]);
+
+  /* Whole runs are handed over at once */
+  UNIT_CHECK(ntexts == runs);
+}
+
+static void test_runs(int use_utf8)
+{
+  VTerm *vt = vterm_new(25, 80);
+  unsigned char buf[512];
+  int i;
+
+  utf8 = use_utf8;
+  vterm_set_utf8(vt, utf8);
+  vterm_parser_set_callbacks(vt, &callbacks, NULL);
+
+  /* Every length around the 8 and 16 byte steps, with a control at
+   * every position */
+  for(i = 0; i < 40; i++) {
+    size_t len = i + 1, stop;
+
+    for(stop = 0; stop <= len; stop++) {
+      memset(buf, 'a', len);
+      if(stop < len)
+        buf[stop] = '\n';
+      check_buffer(vt, buf, len);
+    }
+  }
+
+  /* And random text with controls in it */
+  srand(utf8 ? 2 : 3);
+  for(i = 0; i < 20000; i++) {
+    size_t len = 1 + rand() % (sizeof(buf) - 1), pos;
+
+    for(pos = 0; pos < len; pos++)
+      buf[pos] = random_byte();
+    /* Long runs are what the scan is for */
+    if(rand() % 2)
+      memset(buf + rand() % len / 2, 'x', len / 2);
+
+    check_buffer(vt, buf, len);
+  }
+
+  vterm_free(vt);
+}
+
+int main(void)
+{
+  test_runs(1);
+  test_runs(0);
+
+  return UNIT_RESULT();
+}
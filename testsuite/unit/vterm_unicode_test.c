@@ -0,0 +1,34 @@
+/* Tests of the precomputed width table in lib/vterm/unicode_width.inc
+ * against the interval tables it is generated from. */
+
+#include "unit.h"
+
+#define UNICODE_WIDTH_FROM_TABLES
+#include "unicode.c"
+
+int main(void)
+{
+  uint32_t codepoint;
+
+  /* Every codepoint, and a little past the end of Unicode */
+  for(codepoint = 0; codepoint < 0x110100; codepoint++) {
+    UNIT_CHECK(vterm_unicode_width(codepoint) ==
+               unicode_width_from_tables(codepoint));
+    UNIT_CHECK(vterm_unicode_is_combining(codepoint) ==
+               bisearch(codepoint, combining,
+                        sizeof(combining) / sizeof(struct interval) - 1));
+  }
+  UNIT_CHECK(vterm_unicode_width(0xffffffff) ==
+             unicode_width_from_tables(0xffffffff));
+
+  /* A few known widths */
+  UNIT_CHECK(vterm_unicode_width(0) == 0);
+  UNIT_CHECK(vterm_unicode_width(0x07) == -1);
+  UNIT_CHECK(vterm_unicode_width(0x9b) == -1);
+  UNIT_CHECK(vterm_unicode_width('a') == 1);
+  UNIT_CHECK(vterm_unicode_width(0x0301) == 0);
+  UNIT_CHECK(vterm_unicode_width(0x4e00) == 2);
+  UNIT_CHECK(vterm_unicode_width(0x1f600) == 2);
+
+  return UNIT_RESULT();
+}